@@ -44,7 +44,7 @@ class AccommodateIndexMultiply extends Handler {
 		$lines[] =		"uint32_t new_size = new_dim * op3;";
 		$lines[] =		"op4 = new_size;";
 		$lines[] =		"op2 = new_dim;";
-		$lines[] = 		"qb_resize_segment(&cxt->function->local_storage->segments[op5], new_size * op6);";
+		$lines[] = 		"qb_resize_segment(&cxt->function->local_storage->segments[op5], (uint64_t) new_size * op6);";
 		$lines[] = "}";
 		return $lines;
 	}
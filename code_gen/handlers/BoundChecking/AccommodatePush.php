@@ -35,7 +35,7 @@ class AccommodatePush extends Handler {
 		$lines[] = "uint32_t new_dim = op1 + 1;";
 		$lines[] = "res = op1;";
 		$lines[] = "op1 = new_dim;";
-		$lines[] = "qb_resize_segment(&cxt->function->local_storage->segments[op2], new_dim * op3);";
+		$lines[] = "qb_resize_segment(&cxt->function->local_storage->segments[op2], (uint64_t) new_dim * op3);";
 		return $lines;
 	}
 }
@@ -39,7 +39,7 @@ class AccommodateSize extends Handler {
 		$lines[] = "if(UNEXPECTED(!(op1 == op2))) {";
 		$lines[] =		"uint32_t new_dim = op1;";
 		$lines[] =		"op2 = new_dim;";
-		$lines[] = 		"qb_resize_segment(&cxt->function->local_storage->segments[op3], new_dim * op4);";
+		$lines[] = 		"qb_resize_segment(&cxt->function->local_storage->segments[op3], (uint64_t) new_dim * op4);";
 		$lines[] = "}";
 		return $lines;
 	}
@@ -106,7 +106,36 @@ class SampleConvolution extends Handler {
 		$lines[] = "$cType sum[$this->operandSize] = {";
 		$lines[] = 		implode(', ', array_fill(0, $this->operandSize, "0.0$f"));
 		$lines[] = "};";
-		$lines[] = "if(fx + fy == 0) {";
+		$lines[] = "if(ix0 >= 0 && iy0 >= 0 && (uint32_t) ix0 + op8 < op2 && (uint32_t) iy0 + op7 < op3) {";
+		$lines[] = 		"// every sample point (and its neighbors to the right and below) is inside the image";
+		$lines[] = 		"uint32_t stride = op2 * $this->operandSize;";
+		$lines[] = 		"$cType *row_ptr = op1_ptr + ((iy0 * op2) + ix0) * $this->operandSize;";
+		$lines[] = 		"$cType *pixel_ptr;";
+		$lines[] = 		"if(fx + fy == 0) {";
+		$lines[] =			"for(r = 0; r < op7; r++, row_ptr += stride) {";
+		$lines[] =				"for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += $this->operandSize) {";
+		$lines[] =					"$cType coefficient = *op6_ptr++;";
+		for($i = 0; $i < $this->operandSize; $i++) {
+			$lines[] =				"sum[$i] += pixel_ptr[$i] * coefficient;";
+		}
+		$lines[] =				"}";
+		$lines[] =			"}";
+		$lines[] = 		"} else {";
+		$lines[] = 			"$cType fx1 = 1.0$f - fx;";
+		$lines[] = 			"$cType fy1 = 1.0$f - fy;";
+		$lines[] =			"for(r = 0; r < op7; r++, row_ptr += stride) {";
+		$lines[] =				"for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += $this->operandSize) {";
+		$lines[] =					"$cType coefficient = *op6_ptr++;";
+		$lines[] =					"$cType wt = fy1 * coefficient;";
+		$lines[] =					"$cType wb = fy * coefficient;";
+		for($i = 0; $i < $this->operandSize; $i++) {
+			$j = $i + $this->operandSize;
+			$lines[] =				"sum[$i] += (pixel_ptr[$i] * fx1 + pixel_ptr[$j] * fx) * wt + (pixel_ptr[stride + $i] * fx1 + pixel_ptr[stride + $j] * fx) * wb;";
+		}
+		$lines[] =				"}";
+		$lines[] =			"}";
+		$lines[] = 		"}";
+		$lines[] = "} else if(fx + fy == 0) {";
 		$lines[] =		"for(r = 0, iy = iy0; r < op7; r++, iy++) {";
 		$lines[] =			"for(c = 0, ix = ix0; c < op8; c++, ix++) {";
 		$lines[] =				"$cType coefficient = *op6_ptr++;";
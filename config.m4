@@ -13,6 +13,9 @@ PHP_ARG_WITH(avx, whether to use AVX instructions on x86 processors,
 PHP_ARG_WITH(cpu, whether to enable CPU-specific optimization,
 [  --with-cpu[=arch]         Enable optimization specific to CPU archecture], no, no)
 
+PHP_ARG_WITH(libtcc, whether to compile native code in-process with libtcc,
+[  --with-libtcc[=DIR]       Compile native code in-process with libtcc], no, no)
+
 if test "$PHP_QB" != "no"; then
   qb_cflags=""
 
@@ -95,6 +98,24 @@ if test "$PHP_QB" != "no"; then
 	[ AC_DEFINE(HAVE_COMPLEX_H,1,[ Define to 1 if you have the <complex.h> header file. ]) ]
   )
 
+  if test "$PHP_LIBTCC" != "no"; then
+    AC_MSG_CHECKING([for libtcc.h])
+    for i in $PHP_LIBTCC /usr/local /usr; do
+      if test -r $i/include/libtcc.h; then
+        LIBTCC_DIR=$i
+        AC_MSG_RESULT([found in $i])
+        break
+      fi
+    done
+    if test -z "$LIBTCC_DIR"; then
+      AC_MSG_RESULT([not found])
+      AC_MSG_ERROR([Please reinstall libtcc])
+    fi
+    PHP_ADD_INCLUDE($LIBTCC_DIR/include)
+    PHP_ADD_LIBRARY_WITH_PATH(tcc, $LIBTCC_DIR/$PHP_LIBDIR, QB_SHARED_LIBADD)
+    AC_DEFINE(HAVE_LIBTCC,1,[ Define to 1 if native code can be compiled in-process with libtcc. ])
+  fi
+
   PHP_SUBST(QB_SHARED_LIBADD)
   case $host_alias in
   *darwin*)
@@ -108,6 +129,7 @@ if test "$PHP_QB" != "no"; then
 
   extra_sources="\
 	qb_build.c\
+	qb_bytecode_cache.c\
 	qb_compat.c\
 	qb_crc64.c\
 	qb_compiler.c\
@@ -46,6 +46,8 @@ PHP_MINFO_FUNCTION(qb);
 
 PHP_FUNCTION(qb_compile);
 PHP_FUNCTION(qb_extract);
+PHP_FUNCTION(qb_stream);
+PHP_FUNCTION(qb_get_build_trace);
 
 /* 
   	Declare any global variables you may need between the BEGIN
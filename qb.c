@@ -36,6 +36,9 @@
 
 int debug_compatibility_mode = TRUE;
 int permitted_thread_count = PERMITTED_THREAD_COUNT;
+double array_growth_factor = 1.5;
+long large_segment_threshold = 0;
+int use_huge_pages = FALSE;
 int qb_resource_handle;
 zend_class_entry *qb_exception_ce = NULL;
 
@@ -231,7 +234,7 @@ static void qb_transfer_dimension(qb_storage *src_storage, qb_address *src_addre
 		dst_address->segment_selector = QB_SELECTOR_CONSTANT_SCALAR;
 		segment = &dst_storage->segments[QB_SELECTOR_CONSTANT_SCALAR];
 		indices = (uint32_t *) segment->memory;
-		index_count = segment->byte_count / sizeof(uint32_t);
+		index_count = (uint32_t) (segment->byte_count / sizeof(uint32_t));
 		for(i = 0; i < index_count; i++) {
 			if(indices[i] == index) {
 				dst_address->segment_offset = i * sizeof(uint32_t);
@@ -243,7 +246,7 @@ static void qb_transfer_dimension(qb_storage *src_storage, qb_address *src_addre
 		dst_address->segment_selector = variable_selector;
 		index = 0;
 	}
-	dst_address->segment_offset = segment->byte_count;
+	dst_address->segment_offset = (uint32_t) segment->byte_count;
 	segment->byte_count += sizeof(uint32_t);
 	if(segment->byte_count > segment->current_allocation) {
 		segment->current_allocation = ALIGN_TO(segment->byte_count, 1024);
@@ -338,7 +341,7 @@ qb_variable * qb_import_variable(qb_storage *storage, qb_variable *var, qb_impor
 		segment = &scope->storage->segments[selector];
 	}
 
-	start_offset = ALIGN_TO(segment->byte_count, alignment);
+	start_offset = (uint32_t) ALIGN_TO(segment->byte_count, alignment);
 	segment->byte_count = start_offset + byte_count;
 
 	if(selector < QB_SELECTOR_ARRAY_START) {
@@ -461,12 +464,46 @@ qb_function * qb_find_compiled_function(zend_function *zfunc TSRMLS_DC) {
 
 void qb_attach_compiled_function(qb_function *qfunc, zend_op_array *op_array TSRMLS_DC) {
 	qb_function **p_function;
+	qb_function *previous_qfunc = QB_GET_FUNCTION(op_array);
 	if(!QB_G(compiled_functions)) {
 		qb_create_array((void **) &QB_G(compiled_functions), &QB_G(compiled_function_count), sizeof(qb_function *), 16);
 	}
 	p_function = qb_enlarge_array((void **) &QB_G(compiled_functions), 1);
 	*p_function = qfunc;
 	QB_SET_FUNCTION(op_array, qfunc);
+
+	if(previous_qfunc) {
+		// the profiles stay with whichever version is attached to the op array
+		qfunc->dimension_profiles = previous_qfunc->dimension_profiles;
+		qfunc->flags |= previous_qfunc->flags & QB_FUNCTION_NOT_SPECIALIZABLE;
+	}
+	if(previous_qfunc && previous_qfunc->next_specialization) {
+		// the function is being replaced by a native version; build its specializations again
+		// so they don't lag behind (the old ones stay around for calls that are in progress)
+		qb_dimension_profile *profile;
+		for(profile = qfunc->dimension_profiles; profile; profile = profile->next) {
+			if(profile->specialized && !profile->failed) {
+				profile->specialized = FALSE;
+				profile->queued = TRUE;
+				QB_G(pending_specialization_count)++;
+			}
+		}
+	}
+}
+
+void qb_attach_specialized_function(qb_function *qfunc, qb_dimension_signature *signature TSRMLS_DC) {
+	qb_function **p_function;
+	qb_function *generic_qfunc = QB_GET_FUNCTION(qfunc->zend_op_array);
+	if(!QB_G(compiled_functions)) {
+		qb_create_array((void **) &QB_G(compiled_functions), &QB_G(compiled_function_count), sizeof(qb_function *), 16);
+	}
+	p_function = qb_enlarge_array((void **) &QB_G(compiled_functions), 1);
+	*p_function = qfunc;
+
+	// link it to the generic version, where qb_select_specialized_function() will find it
+	qfunc->dimension_signature = signature;
+	qfunc->next_specialization = generic_qfunc->next_specialization;
+	generic_qfunc->next_specialization = qfunc;
 }
 
 qb_function * qb_get_compiled_function(zend_function *zfunc) {
@@ -477,10 +514,41 @@ qb_function * qb_get_compiled_function(zend_function *zfunc) {
 	return NULL;
 }
 
+static uint32_t qb_get_relocation_count(qb_function *qfunc) {
+	uint32_t count = 0;
+	uint32_t i;
+	for(i = QB_SELECTOR_ARRAY_START; i < qfunc->local_storage->segment_count; i++) {
+		count += qfunc->local_storage->segments[i].relocation_count;
+	}
+	// include the copies used for recursion and forking
+	if(qfunc->next_reentrance_copy) {
+		count += qb_get_relocation_count(qfunc->next_reentrance_copy);
+	}
+	if(qfunc->next_forked_copy) {
+		count += qb_get_relocation_count(qfunc->next_forked_copy);
+	}
+	return count;
+}
+
+static uint32_t qb_get_copy_count(qb_function *qfunc) {
+	uint32_t count = 0;
+	if(qfunc->next_reentrance_copy) {
+		count += 1 + qb_get_copy_count(qfunc->next_reentrance_copy);
+	}
+	if(qfunc->next_forked_copy) {
+		count += 1 + qb_get_copy_count(qfunc->next_forked_copy);
+	}
+	return count;
+}
+
 static void qb_start_execution_timer(qb_function *qfunc TSRMLS_DC) {
 	if(QB_G(execution_log_path)[0]) {
 		double start_time = qb_get_high_res_timestamp();
 		QB_G(execution_start_time) = start_time;
+		if(QB_G(execution_log_statistics)) {
+			QB_G(execution_start_relocation_count) = qb_get_relocation_count(qfunc);
+			QB_G(execution_start_copy_count) = qb_get_copy_count(qfunc);
+		}
 	}
 }
 
@@ -495,7 +563,14 @@ static void qb_stop_execution_timer(qb_function *qfunc TSRMLS_DC) {
 				if(stream) {
 					uint32_t file_id = FILE_ID(qfunc->line_id);
 					const char *source_file = qb_get_source_file_path(file_id TSRMLS_CC);
-					php_stream_printf(stream TSRMLS_CC, "%s\t%s\t%f\n", source_file, qfunc->name, duration);
+					if(QB_G(execution_log_statistics)) {
+						// the extra columns are only there when asked for, so existing readers of the log aren't broken
+						uint32_t relocation_count = qb_get_relocation_count(qfunc) - QB_G(execution_start_relocation_count);
+						uint32_t copy_count = qb_get_copy_count(qfunc) - QB_G(execution_start_copy_count);
+						php_stream_printf(stream TSRMLS_CC, "%s\t%s\t%f\t%u\t%u\n", source_file, qfunc->name, duration, relocation_count, copy_count);
+					} else {
+						php_stream_printf(stream TSRMLS_CC, "%s\t%s\t%f\n", source_file, qfunc->name, duration);
+					}
 					php_stream_close(stream);
 				}
 			}
@@ -556,9 +631,20 @@ static void qb_scan_function(qb_build_context *cxt, zend_function *function, zen
 	}
 }
 
-static void qb_scan_function_table(qb_build_context *cxt, HashTable *function_table, zend_class_entry *scope) {
+static uint32_t qb_get_unscanned_element_count(HashTable *table, uint32_t scanned_count) {
+	// new entries are always appended to the end; the count can only go down 
+	// if something was removed, in which case everything is looked at again
+	if(table->nNumOfElements >= scanned_count) {
+		return table->nNumOfElements - scanned_count;
+	} else {
+		return table->nNumOfElements;
+	}
+}
+
+static uint32_t qb_scan_function_table(qb_build_context *cxt, HashTable *function_table, zend_class_entry *scope, uint32_t scanned_count) {
+	uint32_t count = qb_get_unscanned_element_count(function_table, scanned_count);
 	Bucket *p;
-	for(p = function_table->pListTail; p; p = p->pListLast) {
+	for(p = function_table->pListTail; p && count > 0; p = p->pListLast, count--) {
 		zend_function *zfunc = p->pData;
 		if(zfunc->type == ZEND_USER_FUNCTION) {
 			qb_scan_function(cxt, zfunc, scope);
@@ -566,18 +652,31 @@ static void qb_scan_function_table(qb_build_context *cxt, HashTable *function_ta
 			break;
 		}
 	}
+	return function_table->nNumOfElements;
 }
 
-static void qb_scan_class_table(qb_build_context *cxt, HashTable *class_table) {
+static uint32_t qb_scan_class_table(qb_build_context *cxt, HashTable *class_table, uint32_t scanned_count) {
+	uint32_t count = qb_get_unscanned_element_count(class_table, scanned_count);
 	Bucket *p;
-	for(p = class_table->pListTail; p; p = p->pListLast) {
+	for(p = class_table->pListTail; p && count > 0; p = p->pListLast, count--) {
 		zend_class_entry **p_ce = (zend_class_entry **) p->pData, *ce = *p_ce;
 		if(ce->type == ZEND_USER_CLASS) {
-			qb_scan_function_table(cxt, &ce->function_table, ce);
+			qb_scan_function_table(cxt, &ce->function_table, ce, 0);
 		} else {
 			break;
 		}
 	}
+	return class_table->nNumOfElements;
+}
+
+static int32_t qb_is_function_tagged(qb_build_context *cxt, zend_op_array *op_array) {
+	uint32_t i;
+	for(i = 0; i < cxt->function_tag_count; i++) {
+		if(cxt->function_tags[i].op_array == op_array) {
+			return TRUE;
+		}
+	}
+	return FALSE;
 }
 
 static int32_t qb_compile_functions(zend_op_array *op_array TSRMLS_DC) {
@@ -592,15 +691,20 @@ static int32_t qb_compile_functions(zend_op_array *op_array TSRMLS_DC) {
 	qb_initialize_build_context(build_cxt TSRMLS_CC);
 	QB_G(build_context) = build_cxt;
 
-	qb_scan_function_table(build_cxt, EG(function_table), NULL);
-	qb_scan_class_table(build_cxt, EG(class_table));
-#ifdef ZEND_ACC_CLOSURE
+	// functions and classes that were there during the last build have been looked at already
+	QB_G(scanned_function_count) = qb_scan_function_table(build_cxt, EG(function_table), NULL, QB_G(scanned_function_count));
+	QB_G(scanned_class_count) = qb_scan_class_table(build_cxt, EG(class_table), QB_G(scanned_class_count));
 	if(op_array) {
+#ifdef ZEND_ACC_CLOSURE
 		if(op_array->fn_flags & ZEND_ACC_CLOSURE) {
 			qb_scan_function(build_cxt, (zend_function *) op_array, NULL);
+		} else
+#endif
+		if(!qb_is_function_tagged(build_cxt, op_array)) {
+			// a function that failed to compile earlier
+			qb_scan_function(build_cxt, (zend_function *) op_array, op_array->scope);
 		}
 	}
-#endif
 	if(build_cxt->function_tag_count) {
 		qb_build(build_cxt);
 		result = TRUE;
@@ -610,6 +714,81 @@ static int32_t qb_compile_functions(zend_op_array *op_array TSRMLS_DC) {
 	return result;
 }
 
+#ifdef NATIVE_COMPILE_ENABLED
+void qb_queue_hot_function(qb_function *qfunc TSRMLS_DC) {
+	zend_op_array **p_op_array;
+	if(!QB_G(hot_functions)) {
+		qb_create_array((void **) &QB_G(hot_functions), &QB_G(hot_function_count), sizeof(zend_op_array *), 4);
+	}
+	p_op_array = qb_enlarge_array((void **) &QB_G(hot_functions), 1);
+	*p_op_array = qfunc->zend_op_array;
+	qfunc->flags |= QB_FUNCTION_NATIVE_QUEUED;
+}
+
+static void qb_compile_hot_functions(TSRMLS_D) {
+	qb_build_context _build_cxt, *build_cxt = &_build_cxt;
+	uint32_t i;
+
+	qb_initialize_build_context(build_cxt TSRMLS_CC);
+	build_cxt->native_recompilation = TRUE;
+	QB_G(build_context) = build_cxt;
+
+	for(i = 0; i < QB_G(hot_function_count); i++) {
+		zend_op_array *op_array = QB_G(hot_functions)[i];
+		qb_function_tag *tag = qb_enlarge_array((void **) &build_cxt->function_tags, 1);
+		tag->scope = op_array->scope;
+		tag->op_array = op_array;
+	}
+	QB_G(hot_function_count) = 0;
+
+	// the new functions replace the ones running as bytecode when they're attached to the op arrays;
+	// calls already in progress keep using the old ones, which stay around until the end of the request
+	qb_build(build_cxt);
+	qb_free_build_context(build_cxt);
+	QB_G(build_context) = NULL;
+}
+#endif
+
+static void qb_build_specializations(TSRMLS_D) {
+	uint32_t i;
+	for(i = 0; i < QB_G(dimension_profile_count); i++) {
+		qb_dimension_profile *profile = QB_G(dimension_profiles)[i];
+		if(profile->queued) {
+			qb_build_context _build_cxt, *build_cxt = &_build_cxt;
+			qb_function *generic_qfunc = QB_GET_FUNCTION(profile->op_array);
+			qb_function_tag *tag;
+			uint32_t exception_count = QB_G(exception_count);
+
+			profile->queued = FALSE;
+			profile->specialized = TRUE;
+			if(!generic_qfunc) {
+				continue;
+			}
+
+			// each signature gets a build of its own, since every argument's dimensions are fixed by it
+			qb_initialize_build_context(build_cxt TSRMLS_CC);
+			build_cxt->dimension_signature = &profile->signature;
+			build_cxt->native_recompilation = (generic_qfunc->native_proc || (generic_qfunc->flags & QB_FUNCTION_NATIVE_IF_POSSIBLE));
+			QB_G(build_context) = build_cxt;
+
+			tag = qb_enlarge_array((void **) &build_cxt->function_tags, 1);
+			tag->scope = profile->op_array->scope;
+			tag->op_array = profile->op_array;
+
+			if(!qb_build(build_cxt) || QB_G(exception_count) > exception_count) {
+				// the generic version keeps working--the script shouldn't see errors from an optimization
+				// other shapes would most likely fail the same way, so don't bother looking at arguments anymore
+				qb_discard_exceptions(exception_count TSRMLS_CC);
+				profile->failed = TRUE;
+				generic_qfunc->flags |= QB_FUNCTION_NOT_SPECIALIZABLE;
+			}
+			qb_free_build_context(build_cxt);
+			QB_G(build_context) = NULL;
+		}
+	}
+	QB_G(pending_specialization_count) = 0;
+}
+
 int qb_user_opcode_handler(ZEND_OPCODE_HANDLER_ARGS) {
 	zend_op_array *op_array = EG(active_op_array);
 	qb_function *qfunc = QB_GET_FUNCTION(op_array);
@@ -655,6 +834,10 @@ int qb_user_opcode_handler(ZEND_OPCODE_HANDLER_ARGS) {
 #endif
 		} else {
 			qb_interpreter_context _interpreter_cxt, *interpreter_cxt = &_interpreter_cxt;
+			if(QB_G(specialization_threshold) > 0) {
+				// use a version built for the dimensions of the arguments if there's one
+				qfunc = qb_select_specialized_function(qfunc TSRMLS_CC);
+			}
 			qb_start_execution_timer(qfunc TSRMLS_CC);
 			qb_initialize_interpreter_context(interpreter_cxt, qfunc, QB_G(caller_interpreter_context) TSRMLS_CC);
 			qb_execute(interpreter_cxt);
@@ -662,6 +845,23 @@ int qb_user_opcode_handler(ZEND_OPCODE_HANDLER_ARGS) {
 			qb_stop_execution_timer(qfunc TSRMLS_CC);
 		}
 
+#ifdef NATIVE_COMPILE_ENABLED
+		// compile functions that have crossed qb.native_compilation_threshold
+		if(QB_G(hot_function_count) > 0) {
+			qb_compile_hot_functions(TSRMLS_C);
+		}
+
+		// pick up native code from compilers running in the background
+		if(QB_G(background_compilation_count) > 0 || QB_G(abandoned_compiler_count) > 0) {
+			qb_check_background_compilations(TSRMLS_C);
+		}
+#endif
+
+		// build versions of functions specialized for the dimensions they're frequently called with
+		if(QB_G(pending_specialization_count) > 0) {
+			qb_build_specializations(TSRMLS_C);
+		}
+
 		// dispatch any exceptions
 		if(QB_G(exception_count) > 0) {
 			qb_dispatch_exceptions(TSRMLS_C);
@@ -677,6 +877,7 @@ int qb_user_opcode_handler(ZEND_OPCODE_HANDLER_ARGS) {
 	}
 }
 
+#if !ZEND_ENGINE_2_6
 int32_t qb_is_zend_optimizer_present(void) {
 	static int32_t optimizer_checked = FALSE;
 	static int32_t optimizer_present = FALSE;
@@ -712,6 +913,7 @@ void qb_reenable_zend_optimizer(TSRMLS_D) {
 		zend_restore_ini_entry(entry_name, (uint32_t) strlen(entry_name) + 1, PHP_INI_STAGE_ACTIVATE);
 	}
 }
+#endif
 
 void qb_zend_ext_op_array_ctor(zend_op_array *op_array) {
 	const char *doc_comment;
@@ -728,18 +930,24 @@ void qb_zend_ext_op_array_ctor(zend_op_array *op_array) {
 		Z_OPERAND_TYPE(user_op->result) = IS_UNUSED;
 		QB_SET_FUNCTION(op_array, NULL);
 
+#if !ZEND_ENGINE_2_6
 		// prevent Zend Optimizer from optimizing the opcodes
 		qb_disable_zend_optimizer(TSRMLS_C);
+#endif
 	}
 }
 
 void qb_zend_ext_op_array_handler(zend_op_array *op_array) {
 	if(QB_IS_COMPILED(op_array)) {
-		TSRMLS_FETCH();
-		// OpCache in Zend 2.6 and above doesn't the optimization elsewhere
-		// turn on the flag to keep it from running
+		// OpCache in Zend 2.6 and above skips op arrays with this flag, leaving the rest of the file 
+		// to be optimized normally; the flag is cleared before the function runs
 		op_array->fn_flags |= ZEND_ACC_INTERACTIVE; 
-		qb_reenable_zend_optimizer(TSRMLS_C);
+#if !ZEND_ENGINE_2_6
+		{
+			TSRMLS_FETCH();
+			qb_reenable_zend_optimizer(TSRMLS_C);
+		}
+#endif
 	}
 }
 
@@ -792,6 +1000,8 @@ ZEND_DECLARE_MODULE_GLOBALS(qb)
 const zend_function_entry qb_functions[] = {
 	PHP_FE(qb_compile,		NULL)
 	PHP_FE(qb_extract,		NULL)
+	PHP_FE(qb_stream,		NULL)
+	PHP_FE(qb_get_build_trace,	NULL)
 #ifdef PHP_FE_END
 	PHP_FE_END	/* Must be the last line in qb_functions[] */
 #else
@@ -898,18 +1108,65 @@ static ZEND_INI_MH(OnThreadCount) /* {{{ */
 	return SUCCESS;
 }
 
+static ZEND_INI_MH(OnArrayGrowthFactor) /* {{{ */
+{
+	OnUpdateReal(entry, new_value, new_value_length, mh_arg1, mh_arg2, mh_arg3, stage TSRMLS_CC);
+
+	if(!(QB_G(array_growth_factor) >= 1.0)) {
+		QB_G(array_growth_factor) = 1.0;
+	} else if(QB_G(array_growth_factor) > 4.0) {
+		QB_G(array_growth_factor) = 4.0;
+	}
+
+	// keep a copy that worker threads can read
+	array_growth_factor = QB_G(array_growth_factor);
+	return SUCCESS;
+}
+
+static ZEND_INI_MH(OnLargeSegmentThreshold) /* {{{ */
+{
+	OnUpdateLong(entry, new_value, new_value_length, mh_arg1, mh_arg2, mh_arg3, stage TSRMLS_CC);
+
+	if(QB_G(large_segment_threshold) < 0) {
+		QB_G(large_segment_threshold) = 0;
+	}
+
+	// keep a copy that worker threads can read
+	large_segment_threshold = QB_G(large_segment_threshold);
+	return SUCCESS;
+}
+/* }}} */
+
+static ZEND_INI_MH(OnUseHugePages) /* {{{ */
+{
+	OnUpdateBool(entry, new_value, new_value_length, mh_arg1, mh_arg2, mh_arg3, stage TSRMLS_CC);
+	use_huge_pages = QB_G(use_huge_pages);
+	return SUCCESS;
+}
+/* }}} */
+
 /* {{{ PHP_INI
  */
 PHP_INI_BEGIN()
     STD_PHP_INI_BOOLEAN("qb.allow_native_compilation",		"0",	PHP_INI_SYSTEM,	OnUpdateBool,	allow_native_compilation,		zend_qb_globals,	qb_globals)
 	STD_PHP_INI_BOOLEAN("qb.allow_memory_map",				"1",	PHP_INI_SYSTEM,	OnUpdateBool,	allow_memory_map,				zend_qb_globals,	qb_globals)
+	STD_PHP_INI_BOOLEAN("qb.allow_bytecode_cache",			"0",	PHP_INI_SYSTEM,	OnUpdateBool,	allow_bytecode_cache,			zend_qb_globals,	qb_globals)
+	STD_PHP_INI_BOOLEAN("qb.allow_in_process_compilation",	"0",	PHP_INI_SYSTEM,	OnUpdateBool,	allow_in_process_compilation,	zend_qb_globals,	qb_globals)
 
 	STD_PHP_INI_ENTRY("qb.compiler_path",    				"",		PHP_INI_SYSTEM, OnUpdatePath,	compiler_path,    				zend_qb_globals,	qb_globals)
 	STD_PHP_INI_ENTRY("qb.compiler_env_path",  				"",		PHP_INI_SYSTEM, OnUpdatePath,	compiler_env_path,  			zend_qb_globals,	qb_globals)
 	STD_PHP_INI_ENTRY("qb.native_code_cache_path",  		"",		PHP_INI_SYSTEM, OnUpdatePath,	native_code_cache_path,			zend_qb_globals,	qb_globals)
 	STD_PHP_INI_ENTRY("qb.execution_log_path",  			"",		PHP_INI_SYSTEM, OnUpdatePath,	execution_log_path,				zend_qb_globals,	qb_globals)
+	STD_PHP_INI_BOOLEAN("qb.execution_log_statistics",		"0",	PHP_INI_SYSTEM,	OnUpdateBool,	execution_log_statistics,		zend_qb_globals,	qb_globals)
+	STD_PHP_INI_ENTRY("qb.build_log_path",  				"",		PHP_INI_SYSTEM, OnUpdatePath,	build_log_path,					zend_qb_globals,	qb_globals)
+	STD_PHP_INI_ENTRY("qb.array_growth_factor",				"1.5",	PHP_INI_SYSTEM, OnArrayGrowthFactor,	array_growth_factor,	zend_qb_globals,	qb_globals)
+	STD_PHP_INI_ENTRY("qb.large_segment_threshold",			"0",	PHP_INI_SYSTEM, OnLargeSegmentThreshold,	large_segment_threshold,	zend_qb_globals,	qb_globals)
+	STD_PHP_INI_BOOLEAN("qb.use_huge_pages",				"0",	PHP_INI_SYSTEM,	OnUseHugePages,	use_huge_pages,					zend_qb_globals,	qb_globals)
 
 	STD_PHP_INI_ENTRY("qb.thread_count",					"0",	PHP_INI_ALL, 	OnThreadCount,	thread_count,					zend_qb_globals,	qb_globals)
+	STD_PHP_INI_ENTRY("qb.pbj_pixels_per_iteration",		"1",	PHP_INI_ALL, 	OnUpdateLong,	pbj_pixels_per_iteration,		zend_qb_globals,	qb_globals)
+	STD_PHP_INI_ENTRY("qb.native_compilation_threshold",	"0",	PHP_INI_ALL, 	OnUpdateLong,	native_compilation_threshold,	zend_qb_globals,	qb_globals)
+	STD_PHP_INI_ENTRY("qb.specialization_threshold",		"0",	PHP_INI_ALL, 	OnUpdateLong,	specialization_threshold,		zend_qb_globals,	qb_globals)
 
 	STD_PHP_INI_BOOLEAN("qb.allow_bytecode_interpretation",	"1",	PHP_INI_ALL,	OnUpdateBool,	allow_bytecode_interpretation,	zend_qb_globals,	qb_globals)
 	STD_PHP_INI_BOOLEAN("qb.allow_debugger_inspection",		"1",	PHP_INI_ALL,	OnUpdateBool,	allow_debugger_inspection,		zend_qb_globals,	qb_globals)
@@ -918,10 +1175,12 @@ PHP_INI_BEGIN()
     STD_PHP_INI_BOOLEAN("qb.column_major_matrix",			"0",	PHP_INI_ALL,	OnUpdateBool,	column_major_matrix,			zend_qb_globals,	qb_globals)
 
 	STD_PHP_INI_BOOLEAN("qb.compile_to_native",				"0",	PHP_INI_ALL,	OnUpdateBool,	compile_to_native,				zend_qb_globals,	qb_globals)
+	STD_PHP_INI_BOOLEAN("qb.background_native_compilation",	"0",	PHP_INI_ALL,	OnUpdateBool,	background_native_compilation,	zend_qb_globals,	qb_globals)
     STD_PHP_INI_BOOLEAN("qb.show_opcodes",					"0",	PHP_INI_ALL,	OnUpdateBool,	show_opcodes,					zend_qb_globals,	qb_globals)
     STD_PHP_INI_BOOLEAN("qb.show_native_source",			"0",	PHP_INI_ALL,	OnUpdateBool,	show_native_source,				zend_qb_globals,	qb_globals)
     STD_PHP_INI_BOOLEAN("qb.show_compiler_errors",			"0",	PHP_INI_ALL,	OnUpdateBool,	show_compiler_errors,			zend_qb_globals,	qb_globals)
     STD_PHP_INI_BOOLEAN("qb.show_source_opcodes",			"0",	PHP_INI_ALL,	OnUpdateBool,	show_source_opcodes,			zend_qb_globals,	qb_globals)
+    STD_PHP_INI_BOOLEAN("qb.trace_build",					"0",	PHP_INI_ALL,	OnUpdateBool,	trace_build,					zend_qb_globals,	qb_globals)
 
 	STD_PHP_INI_ENTRY("qb.tab_width",						"4",	PHP_INI_ALL, 	OnUpdateLong,	tab_width,						zend_qb_globals,	qb_globals)
 	STD_PHP_INI_ENTRY("qb.error_exception",					"0",	PHP_INI_ALL,	OnUpdateLong,	error_exception,				zend_qb_globals,	qb_globals)
@@ -933,6 +1192,29 @@ PHP_INI_END()
  */
 static void php_qb_init_globals(zend_qb_globals *qb_globals)
 {
+	qb_globals->bytecode_cache_entries = NULL;
+#ifdef NATIVE_COMPILE_ENABLED
+	qb_globals->abandoned_compiler_ids = NULL;
+	qb_globals->abandoned_compiler_count = 0;
+#endif
+}
+/* }}} */
+
+/* {{{ php_qb_shutdown_globals
+ */
+static void php_qb_shutdown_globals(zend_qb_globals *qb_globals)
+{
+	if(qb_globals->bytecode_cache_entries) {
+		zend_hash_destroy(qb_globals->bytecode_cache_entries);
+		pefree(qb_globals->bytecode_cache_entries, TRUE);
+		qb_globals->bytecode_cache_entries = NULL;
+	}
+#ifdef NATIVE_COMPILE_ENABLED
+	if(qb_globals->abandoned_compiler_ids) {
+		free(qb_globals->abandoned_compiler_ids);
+		qb_globals->abandoned_compiler_ids = NULL;
+	}
+#endif
 }
 /* }}} */
 
@@ -952,7 +1234,7 @@ PHP_MINIT_FUNCTION(qb)
 		return FAILURE;
 	}
 
-	ZEND_INIT_MODULE_GLOBALS(qb, php_qb_init_globals, NULL);
+	ZEND_INIT_MODULE_GLOBALS(qb, php_qb_init_globals, php_qb_shutdown_globals);
 
 	REGISTER_INI_ENTRIES();
 
@@ -971,6 +1253,7 @@ PHP_MINIT_FUNCTION(qb)
 
 	INIT_CLASS_ENTRY(ce, "QBException", NULL);
  	qb_exception_ce = zend_register_internal_class_ex(&ce, zend_exception_get_default(TSRMLS_C), NULL TSRMLS_CC);
+	qb_register_buffer_class(TSRMLS_C);
 
 	qb_install_user_opcode_handler();
 
@@ -991,6 +1274,10 @@ PHP_MSHUTDOWN_FUNCTION(qb)
 
 	qb_free_thread_pool();
 
+#ifndef ZTS
+	php_qb_shutdown_globals(&qb_globals);
+#endif
+
 #if ZEND_ENGINE_2_1
 	zend_shutdown_strtod();
 #endif
@@ -1028,6 +1315,16 @@ PHP_RINIT_FUNCTION(qb)
 	QB_G(source_file_count) = 0;
 	QB_G(compiled_functions) = NULL;
 	QB_G(compiled_function_count) = 0;
+	QB_G(scanned_function_count) = 0;
+	QB_G(scanned_class_count) = 0;
+	QB_G(build_traces) = NULL;
+	QB_G(build_trace_count) = 0;
+	QB_G(dimension_profiles) = NULL;
+	QB_G(dimension_profile_count) = 0;
+	QB_G(pending_specialization_count) = 0;
+	QB_G(file_window_stream) = NULL;
+	QB_G(file_window_offset) = 0;
+	QB_G(file_window_length) = 0;
 #ifdef ZEND_ACC_GENERATOR
 	QB_G(generator_contexts) = NULL;
 	QB_G(generator_context_count) = 0;
@@ -1035,6 +1332,10 @@ PHP_RINIT_FUNCTION(qb)
 #ifdef NATIVE_COMPILE_ENABLED
 	QB_G(native_code_bundles) = NULL;
 	QB_G(native_code_bundle_count) = 0;
+	QB_G(hot_functions) = NULL;
+	QB_G(hot_function_count) = 0;
+	QB_G(background_compilations) = NULL;
+	QB_G(background_compilation_count) = 0;
 #endif
 
 	return SUCCESS;
@@ -1087,6 +1388,13 @@ PHP_RSHUTDOWN_FUNCTION(qb)
 	qb_destroy_array((void **) &QB_G(external_symbols));
 	qb_destroy_array((void **) &QB_G(exceptions));
 	qb_destroy_array((void **) &QB_G(source_files));
+	qb_free_build_traces(TSRMLS_C);
+
+#ifdef NATIVE_COMPILE_ENABLED
+	// compilers still running are left to finish on their own
+	// the object files they produce will be picked up by a later request
+	qb_abandon_background_compilations(TSRMLS_C);
+#endif
 
 	if(QB_G(compiled_functions)) {
 		// free the compiled functions
@@ -1101,6 +1409,13 @@ PHP_RSHUTDOWN_FUNCTION(qb)
 		qb_destroy_array((void **) &QB_G(compiled_functions));
 	}
 
+	if(QB_G(dimension_profiles)) {
+		for(i = 0; i < QB_G(dimension_profile_count); i++) {
+			efree(QB_G(dimension_profiles)[i]);
+		}
+		qb_destroy_array((void **) &QB_G(dimension_profiles));
+	}
+
 #ifdef ZEND_ACC_GENERATOR
 	for(i = 0; i < QB_G(generator_context_count); i++) {
 		qb_generator_context *g = &QB_G(generator_contexts)[i];
@@ -1114,6 +1429,7 @@ PHP_RSHUTDOWN_FUNCTION(qb)
 		qb_free_native_code(bundle);
 	}
 	qb_destroy_array((void **) &QB_G(native_code_bundles));
+	qb_destroy_array((void **) &QB_G(hot_functions));
 #endif
 	return SUCCESS;
 }
@@ -1162,6 +1478,9 @@ PHP_MINFO_FUNCTION(qb)
 #if __AVX2__
 	php_info_print_table_row(2, "AVX version", "2");
 #endif
+#ifdef HAVE_LIBTCC
+	php_info_print_table_row(2, "In-process compiler", "libtcc");
+#endif
 
 	qb_run_diagnostics(&diag TSRMLS_CC);
 	php_info_print_table_colspan_header(2, "Diagnostics");
@@ -1228,3 +1547,138 @@ PHP_FUNCTION(qb_extract)
 }
 /* }}} */
 
+/* {{{ proto int qb_stream(callable function, resource file [, int window_size [, mixed ...]])
+   Call a function with successive windows of a file, returning the number of windows processed */
+PHP_FUNCTION(qb_stream)
+{
+	zend_fcall_info fci;
+	zend_fcall_info_cache fcc;
+	zval *zstream, *retval = NULL;
+	zval ***args = NULL, ***params;
+	php_stream *stream, *prev_stream;
+	php_stream_statbuf ssb;
+	long window_size = 16 * 1024 * 1024;
+	uint32_t arg_count = ZEND_NUM_ARGS(), param_count, i;
+	uint64_t file_size, offset, prev_offset, prev_length;
+	long window_count = 0;
+
+	if(zend_parse_parameters((arg_count > 3) ? 3 : arg_count TSRMLS_CC, "fr|l", &fci, &fcc, &zstream, &window_size) == FAILURE) {
+		return;
+	}
+	php_stream_from_zval(stream, &zstream);
+	if(php_stream_stat(stream, &ssb) != 0) {
+		RETURN_FALSE;
+	}
+	file_size = (uint64_t) ssb.sb.st_size;
+
+	// windows need to start on page boundaries 
+	window_size = ALIGN_TO((window_size > 0) ? window_size : 1, 65536);
+
+	// the file is passed first, followed by any additional arguments
+	param_count = (arg_count > 3) ? arg_count - 2 : 1;
+	params = safe_emalloc(param_count, sizeof(zval **), 0);
+	params[0] = &zstream;
+	if(arg_count > 3) {
+		args = safe_emalloc(arg_count, sizeof(zval **), 0);
+		zend_get_parameters_array_ex(arg_count, args);
+		for(i = 3; i < arg_count; i++) {
+			params[i - 2] = args[i];
+		}
+	}
+	fci.params = params;
+	fci.param_count = param_count;
+	fci.retval_ptr_ptr = &retval;
+
+	prev_stream = QB_G(file_window_stream);
+	prev_offset = QB_G(file_window_offset);
+	prev_length = QB_G(file_window_length);
+	for(offset = 0; offset < file_size; offset += window_size) {
+		uint64_t length = (file_size - offset < (uint64_t) window_size) ? file_size - offset : (uint64_t) window_size;
+		int32_t success, stop = FALSE;
+		qb_set_file_window(stream, offset, length TSRMLS_CC);
+		if(offset + length < file_size) {
+			// get the OS to start reading the next window while this one is processed
+			qb_prefetch_file_range(stream, offset + length, window_size TSRMLS_CC);
+		}
+		success = (zend_call_function(&fci, &fcc TSRMLS_CC) == SUCCESS && !EG(exception));
+		if(retval) {
+			// returning false ends the process early
+			if(Z_TYPE_P(retval) == IS_BOOL && !Z_BVAL_P(retval)) {
+				stop = TRUE;
+			}
+			zval_ptr_dtor(&retval);
+			retval = NULL;
+		}
+		if(!success) {
+			// a window that wasn't processed isn't counted
+			break;
+		}
+		window_count++;
+		if(stop) {
+			break;
+		}
+	}
+	qb_set_file_window(prev_stream, prev_offset, prev_length TSRMLS_CC);
+
+	efree(params);
+	if(args) {
+		efree(args);
+	}
+	RETURN_LONG(window_count);
+}
+/* }}} */
+
+/* {{{ proto array qb_get_build_trace()
+   Return the time spent in each phase of the builds performed so far (requires qb.trace_build) */
+PHP_FUNCTION(qb_get_build_trace)
+{
+	uint32_t i, j;
+
+	if(zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "") == FAILURE) {
+		return;
+	}
+
+	array_init(return_value);
+	for(i = 0; i < QB_G(build_trace_count); i++) {
+		qb_build_trace *trace = &QB_G(build_traces)[i];
+		zval *build, *phases, *functions;
+
+		ALLOC_INIT_ZVAL(build);
+		array_init(build);
+		add_assoc_double(build, "total_time", trace->total_duration);
+
+		ALLOC_INIT_ZVAL(phases);
+		array_init(phases);
+		for(j = 0; j < QB_BUILD_PHASE_COUNT; j++) {
+			add_assoc_double(phases, (char *) qb_build_phase_names[j], trace->phase_durations[j]);
+		}
+		add_assoc_zval(build, "phases", phases);
+		add_assoc_long(build, "pool_memory", (long) trace->pool_memory);
+		add_assoc_bool(build, "cached", trace->loaded_from_cache);
+		if(trace->native_compiler) {
+			add_assoc_string(build, "native_compiler", (char *) trace->native_compiler, TRUE);
+		} else {
+			add_assoc_null(build, "native_compiler");
+		}
+		add_assoc_bool(build, "native_code", trace->native_code_attached);
+
+		ALLOC_INIT_ZVAL(functions);
+		array_init(functions);
+		for(j = 0; j < trace->function_count; j++) {
+			qb_function_trace *function_trace = &trace->functions[j];
+			if(function_trace->name) {
+				zval *function;
+				ALLOC_INIT_ZVAL(function);
+				array_init(function);
+				add_assoc_string(function, "name", function_trace->name, TRUE);
+				add_assoc_double(function, "translation_time", function_trace->translation_duration);
+				add_assoc_long(function, "op_count", function_trace->op_count);
+				add_assoc_long(function, "optimized_op_count", function_trace->optimized_op_count);
+				add_next_index_zval(functions, function);
+			}
+		}
+		add_assoc_zval(build, "functions", functions);
+		add_next_index_zval(return_value, build);
+	}
+}
+/* }}} */
@@ -196,6 +196,7 @@ typedef double float64_t;
 #include "qb_thread.h"
 #include "qb_interpreter.h"
 #include "qb_build.h"
+#include "qb_bytecode_cache.h"
 #include "qb_native_compiler.h"
 #include "qb_printer.h"
 #include "qb_extractor.h"
@@ -223,13 +224,22 @@ struct qb_generator_context {
 ZEND_BEGIN_MODULE_GLOBALS(qb)
 	qb_main_thread main_thread;
 	long thread_count;
+	long pbj_pixels_per_iteration;
+	double array_growth_factor;
+	long large_segment_threshold;
 	long debug_fork_id;
 	long error_exception;
+	long native_compilation_threshold;
+	long specialization_threshold;
 
 	zend_bool allow_bytecode_interpretation;
 	zend_bool allow_native_compilation;
 	zend_bool allow_memory_map;
+	zend_bool allow_bytecode_cache;
+	zend_bool allow_in_process_compilation;
+	zend_bool use_huge_pages;
 	zend_bool compile_to_native;
+	zend_bool background_native_compilation;
 	zend_bool allow_debugger_inspection;
 	zend_bool allow_debug_backtrace;
 	zend_bool debug_with_exact_type;
@@ -239,11 +249,14 @@ ZEND_BEGIN_MODULE_GLOBALS(qb)
 	zend_bool show_native_source;
 	zend_bool show_compiler_errors;
 	zend_bool show_source_opcodes;
+	zend_bool trace_build;
+	zend_bool execution_log_statistics;
 
 	char *compiler_path;
 	char *compiler_env_path;
 	char *native_code_cache_path;
 	char *execution_log_path;
+	char *build_log_path;
 
 	long tab_width;
 
@@ -266,6 +279,18 @@ ZEND_BEGIN_MODULE_GLOBALS(qb)
 	qb_function **compiled_functions;
 	uint32_t compiled_function_count;
 
+	uint32_t scanned_function_count;
+	uint32_t scanned_class_count;
+
+	HashTable *bytecode_cache_entries;
+
+	qb_build_trace *build_traces;
+	uint32_t build_trace_count;
+
+	qb_dimension_profile **dimension_profiles;
+	uint32_t dimension_profile_count;
+	uint32_t pending_specialization_count;
+
 #if !ZEND_ENGINE_2_3 && !ZEND_ENGINE_2_2 && !ZEND_ENGINE_2_1
 	zend_literal static_zvals[8];
 #else
@@ -276,6 +301,15 @@ ZEND_BEGIN_MODULE_GLOBALS(qb)
 #ifdef NATIVE_COMPILE_ENABLED
 	qb_native_code_bundle *native_code_bundles;
 	uint32_t native_code_bundle_count;
+
+	zend_op_array **hot_functions;
+	uint32_t hot_function_count;
+
+	qb_native_compiler_context **background_compilations;
+	uint32_t background_compilation_count;
+
+	long *abandoned_compiler_ids;
+	uint32_t abandoned_compiler_count;
 #endif
 
 #ifdef ZEND_ACC_GENERATOR
@@ -284,6 +318,12 @@ ZEND_BEGIN_MODULE_GLOBALS(qb)
 #endif
 
 	double execution_start_time;
+	uint32_t execution_start_relocation_count;
+	uint32_t execution_start_copy_count;
+
+	php_stream *file_window_stream;
+	uint64_t file_window_offset;
+	uint64_t file_window_length;
 ZEND_END_MODULE_GLOBALS(qb)
 
 #ifdef ZTS
@@ -295,9 +335,13 @@ ZEND_END_MODULE_GLOBALS(qb)
 int qb_run_diagnostics(qb_diagnostics *info TSRMLS_DC);
 
 void qb_attach_compiled_function(qb_function *qfunc, zend_op_array *zop_array TSRMLS_DC);
+void qb_attach_specialized_function(qb_function *qfunc, qb_dimension_signature *signature TSRMLS_DC);
 qb_function * qb_get_compiled_function(zend_function *zfunc);
 qb_function * qb_find_compiled_function(zend_function *zfunc TSRMLS_DC);
 int qb_is_compiled_function(zend_function *zfunc);
+#ifdef NATIVE_COMPILE_ENABLED
+void qb_queue_hot_function(qb_function *qfunc TSRMLS_DC);
+#endif
 
 qb_import_scope * qb_find_import_scope(qb_import_scope_type type, void *associated_object TSRMLS_DC);
 qb_import_scope * qb_get_import_scope(qb_storage *storage, qb_variable *var, zval *object TSRMLS_DC);
@@ -310,7 +354,11 @@ int qb_strip_namespace(const char **p_name_str, uint32_t *p_name_len);
 extern int debug_compatibility_mode;
 extern long multithreading_threshold;
 extern int qb_resource_handle;
+extern double array_growth_factor;
+extern long large_segment_threshold;
+extern int use_huge_pages;
 extern zend_class_entry *qb_exception_ce;
+extern zend_class_entry *qb_buffer_ce;
 
 ZEND_EXTERN_MODULE_GLOBALS(qb)
 
@@ -20,6 +20,32 @@
 
 #include "qb.h"
 
+const char *qb_build_phase_names[] = {
+	"cache_lookup",
+	"parsing",
+	"initialization",
+	"translation",
+	"optimization",
+	"encoding",
+	"native_compilation",
+	"cache_saving",
+};
+
+static zend_always_inline double qb_get_build_timestamp(qb_build_context *cxt) {
+	return (cxt->trace) ? qb_get_high_res_timestamp() : 0;
+}
+
+static double qb_end_build_phase(qb_build_context *cxt, qb_build_phase phase, double *p_start_time) {
+	if(cxt->trace) {
+		double end_time = qb_get_high_res_timestamp();
+		double duration = end_time - *p_start_time;
+		cxt->trace->phase_durations[phase] += duration;
+		*p_start_time = end_time;
+		return duration;
+	}
+	return 0;
+}
+
 static zend_always_inline void qb_add_function_declaration(qb_build_context *cxt, qb_function_declaration *function_decl) {
 	qb_function_declaration **p = qb_enlarge_array((void **) &cxt->function_declarations, 1);
 	*p = function_decl;
@@ -82,13 +108,21 @@ static int32_t qb_parse_declarations(qb_build_context *cxt) {
 
 static int32_t qb_initialize_build_environment(qb_build_context *cxt) {
 	USE_TSRM
-	uint32_t i;
+	uint32_t i, j;
 
 	cxt->compiler_contexts = emalloc(sizeof(qb_compiler_context *) * cxt->function_declaration_count);
 	for(i = 0; i < cxt->function_declaration_count; i++) {
 		qb_compiler_context *compiler_cxt = cxt->compiler_contexts[cxt->compiler_context_count++] = emalloc(sizeof(qb_compiler_context));
 		qb_initialize_compiler_context(compiler_cxt, cxt->pool, cxt->function_declarations[i], i, cxt->function_declaration_count TSRMLS_CC);
 
+		if(cxt->native_recompilation && !(compiler_cxt->function_flags & QB_FUNCTION_NEVER_NATIVE)) {
+			// the function has become hot while running as bytecode
+			compiler_cxt->function_flags |= QB_FUNCTION_NATIVE_IF_POSSIBLE;
+		}
+
+		// give arguments the dimensions they've been seen with when building a specialized version
+		compiler_cxt->dimension_signature = cxt->dimension_signature;
+
 		// add variables used within function
 		if(!qb_add_variables(compiler_cxt)) {
 			return FALSE;
@@ -114,6 +148,13 @@ static int32_t qb_initialize_build_environment(qb_build_context *cxt) {
 			|| !qb_decode_pbj_binary(translator_cxt)) {
 				return FALSE;
 			}
+
+			// add the kernels that are applied in sequence
+			for(j = 0; j < compiler_cxt->function_declaration->chained_import_path_count; j++) {
+				if(!qb_add_pbj_filter_stage(translator_cxt, compiler_cxt->function_declaration->chained_import_paths[j])) {
+					return FALSE;
+				}
+			}
 		}
 
 		// show the zend/pbj opcodes if turned on
@@ -228,12 +269,115 @@ static void qb_resolve_dependencies(qb_build_context *cxt) {
 	}
 }
 
+static uint32_t qb_get_active_op_count(qb_compiler_context *compiler_cxt) {
+	uint32_t i, count = 0;
+	for(i = 0; i < compiler_cxt->op_count; i++) {
+		qb_op *qop = compiler_cxt->ops[i];
+		if(qop->opcode != QB_NOP) {
+			count++;
+		}
+	}
+	return count;
+}
+
+static void qb_trace_function(qb_function_trace *function_trace, qb_compiler_context *compiler_cxt) {
+	zend_op_array *op_array = compiler_cxt->zend_op_array;
+	if(op_array->scope) {
+		spprintf(&function_trace->name, 0, "%s::%s", op_array->scope->name, op_array->function_name);
+	} else {
+		function_trace->name = estrdup(op_array->function_name);
+	}
+	function_trace->op_count = qb_get_active_op_count(compiler_cxt);
+}
+
+static void qb_process_intermediate_code(qb_compiler_context *compiler_cxt) {
+	// make all jump target indices absolute
+	qb_resolve_jump_targets(compiler_cxt);
+
+	// fuse basic instructions into compound ones
+	qb_fuse_instructions(compiler_cxt, 1);
+
+	// assign storage space to variables
+	qb_assign_storage_space(compiler_cxt);
+
+	// make opcodes address-mode-specific
+	qb_resolve_address_modes(compiler_cxt);
+
+	// try to fuse more instructions
+	qb_fuse_instructions(compiler_cxt, 2);
+
+	// figure out how many references to relocatable segments there are
+	qb_resolve_reference_counts(compiler_cxt);
+
+	// let forks share the segments that they only read from
+	if(compiler_cxt->function_flags & QB_FUNCTION_MULTITHREADED) {
+		qb_resolve_fork_separation(compiler_cxt);
+	}
+}
+
+static void qb_process_intermediate_code_in_worker_thread(void *param1, void *param2, int param3) {
+	qb_compiler_context *compiler_cxt = param1;
+	qb_data_pool *shared_pool = compiler_cxt->pool;
+
+	// allocate new structures from a pool that no other thread is using
+	compiler_cxt->pool = param2;
+	qb_process_intermediate_code(compiler_cxt);
+	compiler_cxt->pool = shared_pool;
+}
+
+static int32_t qb_is_parallel_build_possible(qb_build_context *cxt) {
+	USE_TSRM
+	// the output would be interleaved if the opcodes are printed
+	return (QB_G(thread_count) > 1 && !QB_G(show_opcodes) && cxt->compiler_context_count > 1);
+}
+
+static int32_t qb_is_processible_in_worker_thread(qb_compiler_context *compiler_cxt) {
+	uint32_t i;
+	if(compiler_cxt->function_flags & QB_FUNCTION_INLINEABLE) {
+		// functions that follow might need to copy the ops
+		return FALSE;
+	}
+	for(i = 0; i < compiler_cxt->variable_count; i++) {
+		qb_variable *qvar = compiler_cxt->variables[i];
+		if(qvar->flags & (QB_VARIABLE_GLOBAL | QB_VARIABLE_LEXICAL | QB_VARIABLE_CLASS | QB_VARIABLE_CLASS_INSTANCE | QB_VARIABLE_CLASS_CONSTANT)) {
+			// storage for external variables is allocated in the import scopes
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static void qb_process_intermediate_code_in_parallel(qb_build_context *cxt, qb_compiler_context **compiler_cxts, uint32_t count) {
+	qb_task_group *group = qb_allocate_task_group(count, 0);
+	uint32_t i;
+	cxt->task_pools = emalloc(sizeof(qb_data_pool) * count);
+	for(i = 0; i < count; i++) {
+		qb_data_pool *pool = &cxt->task_pools[i];
+		qb_initialize_thread_data_pool(pool);
+		cxt->task_pool_count++;
+		qb_add_task(group, qb_process_intermediate_code_in_worker_thread, compiler_cxts[i], pool, 0);
+	}
+	qb_run_task_group(group, FALSE);
+	qb_free_task_group(group);
+}
+
 static int32_t qb_perform_translation(qb_build_context *cxt) {
 	USE_TSRM
+	int32_t parallel = qb_is_parallel_build_possible(cxt);
+	qb_compiler_context **deferred_compiler_cxts = alloca(sizeof(qb_compiler_context *) * cxt->compiler_context_count);
+	uint32_t deferred_compiler_cxt_count = 0;
+	double time = qb_get_build_timestamp(cxt);
 	uint32_t i;
+	if(cxt->trace) {
+		cxt->trace->functions = ecalloc(cxt->compiler_context_count, sizeof(qb_function_trace));
+		cxt->trace->function_count = cxt->compiler_context_count;
+	}
 	for(i = 0; i < cxt->compiler_context_count; i++) {
 		qb_compiler_context *compiler_cxt = cxt->compiler_contexts[i];
+		double translation_duration;
 
+		// translation stays in the main thread, since it accesses the Zend engine 
+		// and the order in which external symbols are added is baked into the code
 		switch(compiler_cxt->translation) {
 			case QB_TRANSLATION_PHP: {
 				qb_php_translator_context *translator_cxt = compiler_cxt->translator_context;
@@ -254,29 +398,40 @@ static int32_t qb_perform_translation(qb_build_context *cxt) {
 			}	break;
 		}
 
-		// make all jump target indices absolute
-		qb_resolve_jump_targets(compiler_cxt);
-
-		// fuse basic instructions into compound ones
-		qb_fuse_instructions(compiler_cxt, 1);
-
-		// assign storage space to variables
-		qb_assign_storage_space(compiler_cxt);
-
-		// make opcodes address-mode-specific
-		qb_resolve_address_modes(compiler_cxt);
+		translation_duration = qb_end_build_phase(cxt, QB_BUILD_PHASE_TRANSLATION, &time);
+		if(cxt->trace) {
+			qb_function_trace *function_trace = &cxt->trace->functions[i];
+			qb_trace_function(function_trace, compiler_cxt);
+			function_trace->translation_duration = translation_duration;
+		}
 
-		// try to fuse more instructions
-		qb_fuse_instructions(compiler_cxt, 2);
+		if(parallel && qb_is_processible_in_worker_thread(compiler_cxt)) {
+			// nothing that comes after depends on the outcome--do it later alongside other functions
+			deferred_compiler_cxts[deferred_compiler_cxt_count++] = compiler_cxt;
+		} else {
+			qb_process_intermediate_code(compiler_cxt);
+			qb_end_build_phase(cxt, QB_BUILD_PHASE_OPTIMIZATION, &time);
+
+			// show the qb opcodes if turned on
+			if(QB_G(show_opcodes)) {
+				qb_printer_context _printer_cxt, *printer_cxt = &_printer_cxt;
+				qb_initialize_printer_context(printer_cxt, compiler_cxt TSRMLS_CC);
+				qb_print_ops(printer_cxt);
+			}
+		}
+	}
 
-		// figure out how many references to relocatable segments there are
-		qb_resolve_reference_counts(compiler_cxt);
+	if(deferred_compiler_cxt_count > 1) {
+		// each function only modifies its own structures, so the results are the same as when it's done sequentially
+		qb_process_intermediate_code_in_parallel(cxt, deferred_compiler_cxts, deferred_compiler_cxt_count);
+	} else if(deferred_compiler_cxt_count == 1) {
+		qb_process_intermediate_code(deferred_compiler_cxts[0]);
+	}
+	qb_end_build_phase(cxt, QB_BUILD_PHASE_OPTIMIZATION, &time);
 
-		// show the qb opcodes if turned on
-		if(QB_G(show_opcodes)) {
-			qb_printer_context _printer_cxt, *printer_cxt = &_printer_cxt;
-			qb_initialize_printer_context(printer_cxt, compiler_cxt TSRMLS_CC);
-			qb_print_ops(printer_cxt);
+	if(cxt->trace) {
+		for(i = 0; i < cxt->compiler_context_count; i++) {
+			cxt->trace->functions[i].optimized_op_count = qb_get_active_op_count(cxt->compiler_contexts[i]);
 		}
 	}
 	return TRUE;
@@ -289,34 +444,66 @@ static int32_t qb_perform_translation(qb_build_context *cxt) {
 #endif
 int32_t native_compilation_disabled = NATIVE_COMPILATION_DISABLED;
 
+static void qb_encode_function_in_worker_thread(void *param1, void *param2, int param3) {
+	qb_encoder_context *encoder_cxt = param1;
+	encoder_cxt->compiler_context->compiled_function = qb_encode_function(encoder_cxt);
+}
+
 static int32_t qb_generate_executables(qb_build_context *cxt) {
 	USE_TSRM
 	int32_t native_compile = FALSE;
+	qb_encoder_context *encoder_cxts = emalloc(sizeof(qb_encoder_context) * cxt->compiler_context_count);
+	double time = qb_get_build_timestamp(cxt);
 	uint32_t i;
+
 	for(i = 0; i < cxt->compiler_context_count; i++) {
-		qb_compiler_context *compiler_cxt = cxt->compiler_contexts[i];
-		qb_encoder_context _encoder_cxt, *encoder_cxt = &_encoder_cxt;
+		qb_initialize_encoder_context(&encoder_cxts[i], cxt->compiler_contexts[i], TRUE TSRMLS_CC);
+	}
 
-		qb_initialize_encoder_context(encoder_cxt, compiler_cxt, TRUE TSRMLS_CC);
+	// encode the instruction streams
+	if(qb_is_parallel_build_possible(cxt)) {
+		qb_task_group *group = qb_allocate_task_group(cxt->compiler_context_count, 0);
+		for(i = 0; i < cxt->compiler_context_count; i++) {
+			qb_add_task(group, qb_encode_function_in_worker_thread, &encoder_cxts[i], NULL, 0);
+		}
+		qb_run_task_group(group, FALSE);
+		qb_free_task_group(group);
+	} else {
+		for(i = 0; i < cxt->compiler_context_count; i++) {
+			qb_encode_function_in_worker_thread(&encoder_cxts[i], NULL, 0);
+		}
+	}
 
-		// encode the instruction stream
-		compiler_cxt->compiled_function = qb_encode_function(encoder_cxt);
+	for(i = 0; i < cxt->compiler_context_count; i++) {
+		qb_compiler_context *compiler_cxt = cxt->compiler_contexts[i];
+		qb_encoder_context *encoder_cxt = &encoder_cxts[i];
 
 		if(!compiler_cxt->compiled_function) {
+			efree(encoder_cxts);
 			return FALSE;
 		}
 
+		// keep a copy of the function while it's still position-independent
+		qb_add_function_to_cache(cxt, compiler_cxt, qb_get_function_structure_size(encoder_cxt));
+
 		// relocate the function now, so the base function won't be in the middle of relcoation while it's being copied
 		qb_relocate_function(compiler_cxt->compiled_function, TRUE);
 
-		// attach the function to the op array
-		qb_attach_compiled_function(compiler_cxt->compiled_function, compiler_cxt->zend_op_array TSRMLS_CC);
+		if(cxt->dimension_signature) {
+			// add it alongside the generic version
+			qb_attach_specialized_function(compiler_cxt->compiled_function, cxt->dimension_signature TSRMLS_CC);
+		} else {
+			// attach the function to the op array
+			qb_attach_compiled_function(compiler_cxt->compiled_function, compiler_cxt->zend_op_array TSRMLS_CC);
+		}
 
 		if(compiler_cxt->function_flags & QB_FUNCTION_NATIVE_IF_POSSIBLE) {
 			// compile to native code unless it's been disabled during profiling
 			native_compile = !native_compilation_disabled;
 		}
 	}
+	efree(encoder_cxts);
+	qb_end_build_phase(cxt, QB_BUILD_PHASE_ENCODING, &time);
 
 #ifdef NATIVE_COMPILE_ENABLED
 	// compile all functions inside build in one go
@@ -325,8 +512,22 @@ static int32_t qb_generate_executables(qb_build_context *cxt) {
 			qb_native_compiler_context _native_compiler_cxt, *native_compiler_cxt = &_native_compiler_cxt;
 			qb_initialize_native_compiler_context(native_compiler_cxt, cxt TSRMLS_CC);
 			qb_compile_to_native_code(native_compiler_cxt);
+			if(cxt->trace && native_compiler_cxt->backend) {
+				// record which compiler was used, so the latency of the backends can be compared
+				cxt->trace->native_compiler = native_compiler_cxt->backend->name;
+			}
+			if(cxt->trace) {
+				// a compiler running in the background reports back later
+				cxt->trace->native_code_attached = TRUE;
+				for(i = 0; i < cxt->compiler_context_count; i++) {
+					if(!cxt->compiler_contexts[i]->compiled_function->native_proc) {
+						cxt->trace->native_code_attached = FALSE;
+					}
+				}
+			}
 			qb_free_native_compiler_context(native_compiler_cxt);
 		}
+		qb_end_build_phase(cxt, QB_BUILD_PHASE_NATIVE_COMPILATION, &time);
 	}
 	if(!QB_G(allow_bytecode_interpretation) && !native_compilation_disabled) {
 		for(i = 0; i < cxt->compiler_context_count; i++) {
@@ -341,11 +542,24 @@ static int32_t qb_generate_executables(qb_build_context *cxt) {
 	return TRUE;
 }
 
-int qb_build(qb_build_context *cxt) {
+static int32_t qb_build_functions(qb_build_context *cxt) {
+	double time = qb_get_build_timestamp(cxt);
+
+	// use the functions from an earlier request if nothing has changed
+	if(qb_load_cached_functions(cxt)) {
+		if(cxt->trace) {
+			cxt->trace->loaded_from_cache = TRUE;
+		}
+		qb_end_build_phase(cxt, QB_BUILD_PHASE_CACHE_LOOKUP, &time);
+		return TRUE;
+	}
+	qb_end_build_phase(cxt, QB_BUILD_PHASE_CACHE_LOOKUP, &time);
+
 	// parse the doc comments
 	if(!qb_parse_declarations(cxt)) {
 		return FALSE;
 	}
+	qb_end_build_phase(cxt, QB_BUILD_PHASE_PARSING, &time);
 
 	// create the compiler contexts for all functions to be compiled 
 	if(!qb_initialize_build_environment(cxt)) {
@@ -354,6 +568,7 @@ int qb_build(qb_build_context *cxt) {
 
 	// resolve function dependencies
 	qb_resolve_dependencies(cxt);
+	qb_end_build_phase(cxt, QB_BUILD_PHASE_INITIALIZATION, &time);
 
 	// translate the functions
 	if(!qb_perform_translation(cxt)) {
@@ -365,13 +580,109 @@ int qb_build(qb_build_context *cxt) {
 		return FALSE;
 	}
 
+	// save the encoded functions for later requests
+	time = qb_get_build_timestamp(cxt);
+	qb_save_cached_functions(cxt);
+	qb_end_build_phase(cxt, QB_BUILD_PHASE_CACHE_SAVING, &time);
+
 	return TRUE;
 }
 
+static void qb_free_function_traces(qb_build_trace *trace) {
+	uint32_t i;
+	for(i = 0; i < trace->function_count; i++) {
+		qb_function_trace *function_trace = &trace->functions[i];
+		if(function_trace->name) {
+			efree(function_trace->name);
+		}
+	}
+	if(trace->functions) {
+		efree(trace->functions);
+	}
+}
+
+static void qb_write_build_trace(qb_build_trace *trace TSRMLS_DC) {
+	php_stream *stream = php_stream_open_wrapper_ex(QB_G(build_log_path), "a", USE_PATH | ENFORCE_SAFE_MODE | REPORT_ERRORS, NULL, NULL);
+	if(stream) {
+		uint32_t i;
+		php_stream_printf(stream TSRMLS_CC, "build\t%f", trace->total_duration);
+		for(i = 0; i < QB_BUILD_PHASE_COUNT; i++) {
+			php_stream_printf(stream TSRMLS_CC, "\t%f", trace->phase_durations[i]);
+		}
+		php_stream_printf(stream TSRMLS_CC, "\t%" PRIu64 "\t%u\t%u\t%s\n", trace->pool_memory, trace->function_count, trace->loaded_from_cache, (trace->native_compiler) ? trace->native_compiler : "none");
+		for(i = 0; i < trace->function_count; i++) {
+			qb_function_trace *function_trace = &trace->functions[i];
+			if(function_trace->name) {
+				php_stream_printf(stream TSRMLS_CC, "function\t%s\t%f\t%u\t%u\n", function_trace->name, function_trace->translation_duration, function_trace->op_count, function_trace->optimized_op_count);
+			}
+		}
+		php_stream_close(stream);
+	}
+}
+
+static void qb_finish_build_trace(qb_build_context *cxt) {
+	USE_TSRM
+	qb_build_trace *trace = cxt->trace;
+	uint32_t i;
+
+	// measure the memory used by the intermediate structures before they're freed
+	trace->pool_memory = qb_get_data_pool_size(cxt->pool);
+	for(i = 0; i < cxt->task_pool_count; i++) {
+		trace->pool_memory += qb_get_data_pool_size(&cxt->task_pools[i]);
+	}
+
+	if(QB_G(build_log_path)[0]) {
+		qb_write_build_trace(trace TSRMLS_CC);
+	}
+	if(QB_G(trace_build)) {
+		// keep the trace around for qb_get_build_trace()
+		qb_build_trace *p_trace;
+		if(!QB_G(build_traces)) {
+			qb_create_array((void **) &QB_G(build_traces), &QB_G(build_trace_count), sizeof(qb_build_trace), 4);
+		}
+		p_trace = qb_enlarge_array((void **) &QB_G(build_traces), 1);
+		*p_trace = *trace;
+	} else {
+		qb_free_function_traces(trace);
+	}
+	cxt->trace = NULL;
+}
+
+int qb_build(qb_build_context *cxt) {
+	double start_time = qb_get_build_timestamp(cxt);
+	int32_t result = qb_build_functions(cxt);
+	if(cxt->trace) {
+		cxt->trace->total_duration = qb_get_high_res_timestamp() - start_time;
+		qb_finish_build_trace(cxt);
+	}
+	return result;
+}
+
+void qb_free_build_traces(TSRMLS_D) {
+	uint32_t i;
+	for(i = 0; i < QB_G(build_trace_count); i++) {
+		qb_free_function_traces(&QB_G(build_traces)[i]);
+	}
+	qb_destroy_array((void **) &QB_G(build_traces));
+}
+
 void qb_initialize_build_context(qb_build_context *cxt TSRMLS_DC) {
 	cxt->pool = &cxt->_pool;
 	cxt->compiler_contexts = NULL;
 	cxt->compiler_context_count = 0;
+	cxt->cache_key = 0;
+	cxt->cache_records = NULL;
+	cxt->cache_record_count = 0;
+	cxt->task_pools = NULL;
+	cxt->task_pool_count = 0;
+	cxt->native_recompilation = FALSE;
+	cxt->dimension_signature = NULL;
+	if(QB_G(trace_build) || QB_G(build_log_path)[0]) {
+		cxt->trace = &cxt->_trace;
+		memset(cxt->trace, 0, sizeof(qb_build_trace));
+	} else {
+		cxt->trace = NULL;
+	}
 	qb_initialize_data_pool(cxt->pool);
 	qb_attach_new_array(cxt->pool, (void **) &cxt->function_tags, &cxt->function_tag_count, sizeof(qb_function_tag), 16);
 	qb_attach_new_array(cxt->pool, (void **) &cxt->function_declarations, &cxt->function_declaration_count, sizeof(qb_function_declaration *), 16);
@@ -380,8 +691,17 @@ void qb_initialize_build_context(qb_build_context *cxt TSRMLS_DC) {
 }
 
 void qb_free_build_context(qb_build_context *cxt) {
+	qb_free_cached_function_records(cxt);
 	qb_free_data_pool(cxt->pool);
 
+	if(cxt->task_pools) {
+		uint32_t i;
+		for(i = 0; i < cxt->task_pool_count; i++) {
+			qb_free_data_pool(&cxt->task_pools[i]);
+		}
+		efree(cxt->task_pools);
+	}
+
 	if(cxt->compiler_contexts) {
 		uint32_t i;
 		for(i = 0; i < cxt->compiler_context_count; i++) {
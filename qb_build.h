@@ -24,6 +24,42 @@
 typedef struct qb_build_context				qb_build_context;
 typedef struct qb_function_tag				qb_function_tag;
 typedef struct qb_function_dependencies		qb_function_dependencies;
+typedef struct qb_build_trace				qb_build_trace;
+typedef struct qb_function_trace			qb_function_trace;
+
+typedef enum qb_build_phase					qb_build_phase;
+
+enum qb_build_phase {
+	QB_BUILD_PHASE_CACHE_LOOKUP			= 0,
+	QB_BUILD_PHASE_PARSING,
+	QB_BUILD_PHASE_INITIALIZATION,
+	QB_BUILD_PHASE_TRANSLATION,
+	QB_BUILD_PHASE_OPTIMIZATION,
+	QB_BUILD_PHASE_ENCODING,
+	QB_BUILD_PHASE_NATIVE_COMPILATION,
+	QB_BUILD_PHASE_CACHE_SAVING,
+
+	QB_BUILD_PHASE_COUNT
+};
+
+struct qb_function_trace {
+	char *name;
+	double translation_duration;
+	uint32_t op_count;
+	uint32_t optimized_op_count;
+};
+
+struct qb_build_trace {
+	double phase_durations[QB_BUILD_PHASE_COUNT];
+	double total_duration;
+	uint64_t pool_memory;
+	int32_t loaded_from_cache;
+	const char *native_compiler;
+	int32_t native_code_attached;
+
+	qb_function_trace *functions;
+	uint32_t function_count;
+};
 
 struct qb_build_context {
 	qb_function_tag *function_tags;
@@ -38,6 +74,19 @@ struct qb_build_context {
 	qb_class_declaration **class_declarations;
 	uint32_t class_declaration_count;
 
+	uint64_t cache_key;
+	int8_t **cache_records;
+	uint32_t cache_record_count;
+
+	qb_data_pool *task_pools;
+	uint32_t task_pool_count;
+
+	qb_build_trace *trace;
+	qb_build_trace _trace;
+
+	int32_t native_recompilation;
+	qb_dimension_signature *dimension_signature;
+
 	qb_data_pool *pool;
 	qb_data_pool _pool;
 
@@ -65,4 +114,8 @@ qb_compiler_context * qb_find_compiler_context(qb_build_context *cxt, qb_functio
 void qb_initialize_build_context(qb_build_context *cxt TSRMLS_DC);
 void qb_free_build_context(qb_build_context *cxt);
 
+extern const char *qb_build_phase_names[];
+
+void qb_free_build_traces(TSRMLS_D);
+
 #endif
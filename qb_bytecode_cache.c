@@ -0,0 +1,832 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2012 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Chung Leong <cleong@cal.berkeley.edu>                        |
+  +----------------------------------------------------------------------+
+*/
+
+/* $Id$ */
+
+#include "qb.h"
+
+#ifndef ZEND_WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char qb_bytecode_cache_signature[4] = { 'Q', 'B', 'B', 'C' };
+
+static uint64_t qb_calculate_source_range_crc64(const char *data, size_t length, uint32_t line_start, uint32_t line_end, uint64_t crc64) {
+	size_t i, start = (line_start <= 1) ? 0 : length, end = length;
+	uint32_t line_number = 1;
+	for(i = 0; i < length; i++) {
+		if(data[i] == '\n') {
+			line_number++;
+			if(line_number == line_start) {
+				start = i + 1;
+			} else if(line_number == line_end + 1) {
+				end = i + 1;
+				break;
+			}
+		}
+	}
+	if(start < end) {
+		crc64 = qb_calculate_crc64((const uint8_t *) data + start, end - start, crc64);
+	}
+	return crc64;
+}
+
+static uint64_t qb_calculate_cache_key(qb_build_context *cxt) {
+	USE_TSRM
+	static const char build_stamp[] = __DATE__ " " __TIME__;
+	const char *source_file_path = NULL;
+	char *source = NULL;
+	size_t source_length = 0;
+	uint32_t settings[9];
+	uint64_t crc64 = 0;
+	uint32_t i;
+
+	// code generated by a different build of QB or under different settings can't be reused
+	settings[0] = QB_VERSION_SIGNATURE;
+	settings[1] = sizeof(void *);
+	settings[2] = QB_G(column_major_matrix);
+	settings[3] = QB_G(allow_debugger_inspection);
+	settings[4] = QB_G(allow_debug_backtrace);
+	settings[5] = QB_G(compile_to_native);
+	settings[6] = QB_G(allow_native_compilation);
+	settings[7] = (uint32_t) QB_G(pbj_pixels_per_iteration);
+	settings[8] = (uint32_t) QB_G(thread_count);
+	crc64 = qb_calculate_crc64((const uint8_t *) build_stamp, sizeof(build_stamp), crc64);
+	crc64 = qb_calculate_crc64((const uint8_t *) settings, sizeof(settings), crc64);
+
+	for(i = 0; i < cxt->function_tag_count; i++) {
+		qb_function_tag *tag = &cxt->function_tags[i];
+		zend_op_array *op_array = tag->op_array;
+		uint32_t line_start, line_end, j;
+
+#ifdef ZEND_ACC_CLOSURE
+		if(op_array->fn_flags & ZEND_ACC_CLOSURE) {
+			crc64 = 0;
+			break;
+		}
+#endif
+		for(j = 0; j < op_array->last; j++) {
+			if(op_array->opcodes[j].opcode == ZEND_FETCH_CONSTANT) {
+				// the value of the constant is baked into the function and it might not be the same next time
+				break;
+			}
+		}
+		if(j < op_array->last) {
+			crc64 = 0;
+			break;
+		}
+		if(tag->scope) {
+			// methods are keyed on the whole class, since its doc comments affect the outcome
+			if(strcmp(Z_CLASS_INFO(tag->scope, filename), op_array->filename) != 0) {
+				// trait method
+				crc64 = 0;
+				break;
+			}
+			line_start = Z_CLASS_INFO(tag->scope, line_start);
+			line_end = Z_CLASS_INFO(tag->scope, line_end);
+			crc64 = qb_calculate_crc64((const uint8_t *) tag->scope->name, tag->scope->name_length, crc64);
+			if(Z_CLASS_INFO(tag->scope, doc_comment)) {
+				crc64 = qb_calculate_crc64((const uint8_t *) Z_CLASS_INFO(tag->scope, doc_comment), Z_CLASS_INFO(tag->scope, doc_comment_len), crc64);
+			}
+		} else {
+			line_start = op_array->line_start;
+			line_end = op_array->line_end;
+		}
+		crc64 = qb_calculate_crc64((const uint8_t *) op_array->function_name, strlen(op_array->function_name), crc64);
+		if(op_array->doc_comment) {
+			crc64 = qb_calculate_crc64((const uint8_t *) op_array->doc_comment, op_array->doc_comment_len, crc64);
+		}
+
+		// hash the actual source code, so the file's timestamp doesn't matter
+		if(!source_file_path || strcmp(source_file_path, op_array->filename) != 0) {
+			php_stream *stream;
+			if(source) {
+				efree(source);
+				source = NULL;
+			}
+			source_file_path = op_array->filename;
+			stream = php_stream_open_wrapper((char *) source_file_path, "rb", 0, NULL);
+			if(stream) {
+				source_length = php_stream_copy_to_mem(stream, &source, PHP_STREAM_COPY_ALL, FALSE);
+				php_stream_close(stream);
+			}
+			if(!source) {
+				// eval'd code, most likely
+				crc64 = 0;
+				break;
+			}
+			crc64 = qb_calculate_crc64((const uint8_t *) source_file_path, strlen(source_file_path), crc64);
+		}
+		crc64 = qb_calculate_source_range_crc64(source, source_length, line_start, line_end, crc64);
+	}
+	if(source) {
+		efree(source);
+	}
+	return crc64;
+}
+
+#ifndef ZEND_WIN32
+static int32_t qb_create_private_folder(const char *folder_path) {
+	// anyone can write to the system temp folder, so the files go into a subfolder only the current user
+	// can access; the folder is not used when it was created by someone else
+	struct stat st;
+	mkdir(folder_path, 0700);
+	if(lstat(folder_path, &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != geteuid() || (st.st_mode & (S_IRWXG | S_IRWXO))) {
+		return FALSE;
+	}
+	return TRUE;
+}
+#endif
+
+static char * qb_get_cache_file_path(uint64_t key TSRMLS_DC) {
+	const char *folder_path = QB_G(native_code_cache_path);
+	char *file_path;
+#ifdef ZEND_WIN32
+	char temp_folder_path[MAX_PATH + 1];
+#else
+	char *private_folder_path = NULL;
+#endif
+	if(!folder_path || !folder_path[0]) {
+		// use the system temp folder when no cache folder is specified, like the native compiler
+#ifdef ZEND_WIN32
+		// the temp folder belongs to the current user on Windows
+		DWORD len = GetTempPath(sizeof(temp_folder_path), temp_folder_path);
+		if(len > 0 && len < sizeof(temp_folder_path)) {
+			temp_folder_path[len - 1] = '\0';
+		} else {
+			strcpy(temp_folder_path, ".");
+		}
+		folder_path = temp_folder_path;
+#else
+		const char *temp_folder_path = getenv("TMPDIR");
+		if(!temp_folder_path) {
+			temp_folder_path = "/tmp";
+		}
+		spprintf(&private_folder_path, 0, "%s/qb-%u", temp_folder_path, (uint32_t) geteuid());
+		if(!qb_create_private_folder(private_folder_path)) {
+			efree(private_folder_path);
+			return NULL;
+		}
+		folder_path = private_folder_path;
+#endif
+	}
+	spprintf(&file_path, 0, "%s%cQB%016" PRIX64 ".qbc", folder_path, PHP_DIR_SEPARATOR, key);
+#ifndef ZEND_WIN32
+	if(private_folder_path) {
+		efree(private_folder_path);
+	}
+#endif
+	return file_path;
+}
+
+static int32_t qb_is_cacheable(qb_compiler_context *compiler_cxt TSRMLS_DC) {
+	qb_function *qfunc = compiler_cxt->compiled_function;
+	uint32_t i;
+	if(compiler_cxt->translation != QB_TRANSLATION_PHP) {
+		// Pixel Bender kernels come from files that aren't covered by the key
+		return FALSE;
+	}
+	if(compiler_cxt->function_flags & (QB_FUNCTION_CLOSURE | QB_FUNCTION_HAS_BREAKPOINTS)) {
+		return FALSE;
+	}
+	if((compiler_cxt->function_flags & QB_FUNCTION_NATIVE_IF_POSSIBLE) && QB_G(allow_native_compilation)) {
+		// the native compiler needs the intermediate ops
+		return FALSE;
+	}
+	for(i = 0; i < qfunc->variable_count; i++) {
+		qb_variable *qvar = qfunc->variables[i];
+		if(qvar->flags & (QB_VARIABLE_GLOBAL | QB_VARIABLE_LEXICAL | QB_VARIABLE_CLASS | QB_VARIABLE_CLASS_INSTANCE | QB_VARIABLE_CLASS_CONSTANT | QB_VARIABLE_THIS)) {
+			// the layout of an import scope depends on which function created it first
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+void qb_add_function_to_cache(qb_build_context *cxt, qb_compiler_context *compiler_cxt, uint32_t function_size) {
+	USE_TSRM
+	qb_function *qfunc = compiler_cxt->compiled_function;
+	qb_bytecode_cache_record *record;
+	uint32_t storage_size = qfunc->local_storage->size;
+	uint32_t instruction_size = qfunc->instruction_length + sizeof(uint16_t) * qfunc->instruction_opcode_count;
+	uint32_t tag_index, record_length;
+	int8_t *p, **p_record;
+
+	if(!cxt->cache_key) {
+		return;
+	}
+	for(tag_index = 0; tag_index < cxt->function_tag_count; tag_index++) {
+		if(cxt->function_tags[tag_index].op_array == compiler_cxt->zend_op_array) {
+			break;
+		}
+	}
+	if(tag_index == cxt->function_tag_count || !qb_is_cacheable(compiler_cxt TSRMLS_CC)) {
+		// the build can only be cached as a whole
+		qb_free_cached_function_records(cxt);
+		cxt->cache_key = 0;
+		return;
+	}
+
+	// copy the function before it's relocated, while it's still position-independent
+	record_length = sizeof(qb_bytecode_cache_record) + ALIGN_TO(function_size, 8) + ALIGN_TO(storage_size, 8) + ALIGN_TO(instruction_size, 8);
+	p = ecalloc(1, record_length);
+	record = (qb_bytecode_cache_record *) p; p += sizeof(qb_bytecode_cache_record);
+	record->tag_index = tag_index;
+	record->source_file_id = qb_get_source_file_id(compiler_cxt->zend_op_array->filename TSRMLS_CC);
+	record->function_size = function_size;
+	record->storage_size = storage_size;
+	record->instruction_size = instruction_size;
+	record->function_address = (uintptr_t) qfunc;
+	record->storage_address = (uintptr_t) qfunc->local_storage;
+	record->instruction_address = (uintptr_t) qfunc->instructions;
+	memcpy(p, qfunc, function_size); p += ALIGN_TO(function_size, 8);
+	memcpy(p, qfunc->local_storage, storage_size); p += ALIGN_TO(storage_size, 8);
+	memcpy(p, qfunc->instructions, instruction_size);
+
+	if(!cxt->cache_records) {
+		qb_attach_new_array(cxt->pool, (void **) &cxt->cache_records, &cxt->cache_record_count, sizeof(int8_t *), 16);
+	}
+	p_record = qb_enlarge_array((void **) &cxt->cache_records, 1);
+	*p_record = (int8_t *) record;
+}
+
+static uint32_t qb_get_cache_record_length(qb_bytecode_cache_record *record) {
+	return sizeof(qb_bytecode_cache_record) + ALIGN_TO(record->function_size, 8) + ALIGN_TO(record->storage_size, 8) + ALIGN_TO(record->instruction_size, 8);
+}
+
+static void qb_add_entry_to_memory_cache(uint64_t key, int8_t *data, size_t length TSRMLS_DC) {
+	qb_bytecode_cache_entry entry;
+	if(!QB_G(bytecode_cache_entries)) {
+		QB_G(bytecode_cache_entries) = pemalloc(sizeof(HashTable), TRUE);
+		zend_hash_init(QB_G(bytecode_cache_entries), 16, NULL, qb_free_bytecode_cache_entry, TRUE);
+	}
+	entry.key = key;
+	entry.data = data;
+	entry.length = length;
+	zend_hash_index_update(QB_G(bytecode_cache_entries), (ulong) key, &entry, sizeof(qb_bytecode_cache_entry), NULL);
+}
+
+static qb_bytecode_cache_entry * qb_find_entry_in_memory_cache(uint64_t key TSRMLS_DC) {
+	qb_bytecode_cache_entry *entry;
+	if(QB_G(bytecode_cache_entries)) {
+		if(zend_hash_index_find(QB_G(bytecode_cache_entries), (ulong) key, (void **) &entry) == SUCCESS) {
+			if(entry->key == key) {
+				return entry;
+			}
+		}
+	}
+	return NULL;
+}
+
+void qb_save_cached_functions(qb_build_context *cxt) {
+	USE_TSRM
+	qb_bytecode_cache_header *header;
+	char *file_path, *temp_file_path;
+	php_stream *stream;
+	int8_t *data, *p;
+	size_t length;
+	uint32_t i;
+
+	if(!cxt->cache_key || cxt->cache_record_count != cxt->function_tag_count) {
+		return;
+	}
+
+	length = sizeof(qb_bytecode_cache_header);
+	for(i = 0; i < QB_G(external_symbol_count); i++) {
+		qb_external_symbol *symbol = &QB_G(external_symbols)[i];
+		zend_function *zfunc = symbol->pointer;
+		if(symbol->type != QB_EXT_SYM_ZEND_FUNCTION && symbol->type != QB_EXT_SYM_STATIC_ZEND_FUNCTION) {
+			return;
+		}
+		length += sizeof(qb_bytecode_cache_symbol) + ALIGN_TO(symbol->name_length, 8);
+		if(zfunc->common.scope) {
+			length += ALIGN_TO(zfunc->common.scope->name_length, 8);
+		}
+	}
+	for(i = 0; i < cxt->cache_record_count; i++) {
+		length += qb_get_cache_record_length((qb_bytecode_cache_record *) cxt->cache_records[i]);
+	}
+
+	// the buffer is kept for later requests handled by this process
+	p = data = pecalloc(1, length, TRUE);
+	header = (qb_bytecode_cache_header *) p; p += sizeof(qb_bytecode_cache_header);
+	memcpy(header->signature, qb_bytecode_cache_signature, sizeof(header->signature));
+	header->qb_version = QB_VERSION_SIGNATURE;
+	header->key = cxt->cache_key;
+	header->function_count = cxt->cache_record_count;
+	header->symbol_count = QB_G(external_symbol_count);
+
+	// the call instructions refer to functions by their position in the symbol table
+	for(i = 0; i < QB_G(external_symbol_count); i++) {
+		qb_external_symbol *symbol = &QB_G(external_symbols)[i];
+		zend_function *zfunc = symbol->pointer;
+		zend_class_entry *ce = zfunc->common.scope;
+		qb_bytecode_cache_symbol *s = (qb_bytecode_cache_symbol *) p; p += sizeof(qb_bytecode_cache_symbol);
+		s->type = symbol->type;
+		s->class_name_length = (ce) ? ce->name_length : 0;
+		s->name_length = symbol->name_length;
+		if(ce) {
+			memcpy(p, ce->name, s->class_name_length); p += ALIGN_TO(s->class_name_length, 8);
+		}
+		memcpy(p, symbol->name, s->name_length); p += ALIGN_TO(s->name_length, 8);
+	}
+	for(i = 0; i < cxt->cache_record_count; i++) {
+		qb_bytecode_cache_record *record = (qb_bytecode_cache_record *) cxt->cache_records[i];
+		uint32_t record_length = qb_get_cache_record_length(record);
+		memcpy(p, record, record_length); p += record_length;
+	}
+	header->checksum = qb_calculate_crc64((const uint8_t *) data + sizeof(qb_bytecode_cache_header), length - sizeof(qb_bytecode_cache_header), 0);
+	qb_add_entry_to_memory_cache(cxt->cache_key, data, length TSRMLS_CC);
+
+	// write to a temporary file first so another process never sees a partial file
+	file_path = qb_get_cache_file_path(cxt->cache_key TSRMLS_CC);
+	if(file_path) {
+		spprintf(&temp_file_path, 0, "%s.%08X", file_path, (uint32_t) php_rand(TSRMLS_C));
+		stream = php_stream_open_wrapper(temp_file_path, "wb", 0, NULL);
+		if(stream) {
+			int32_t success = (php_stream_write(stream, (char *) data, length) == length);
+			php_stream_close(stream);
+			if(!success || VCWD_RENAME(temp_file_path, file_path) != 0) {
+				VCWD_UNLINK(temp_file_path);
+			}
+		}
+		efree(temp_file_path);
+		efree(file_path);
+	}
+	qb_free_cached_function_records(cxt);
+}
+
+void qb_free_bytecode_cache_entry(void *p) {
+	qb_bytecode_cache_entry *entry = p;
+	pefree(entry->data, TRUE);
+}
+
+void qb_free_cached_function_records(qb_build_context *cxt) {
+	uint32_t i;
+	for(i = 0; i < cxt->cache_record_count; i++) {
+		efree(cxt->cache_records[i]);
+	}
+	cxt->cache_record_count = 0;
+}
+
+static int32_t qb_restore_external_symbol(qb_bytecode_cache_symbol *symbol, const char *class_name, const char *name, uint32_t index TSRMLS_DC) {
+	HashTable *function_table = EG(function_table);
+	zend_function *zfunc;
+	char *lc_name;
+	int result;
+
+	if(symbol->class_name_length) {
+		zend_class_entry **p_ce;
+		char *lc_class_name = zend_str_tolower_dup(class_name, symbol->class_name_length);
+		result = zend_hash_find(EG(class_table), lc_class_name, symbol->class_name_length + 1, (void **) &p_ce);
+		efree(lc_class_name);
+		if(result != SUCCESS) {
+			return FALSE;
+		}
+		function_table = &(*p_ce)->function_table;
+	}
+	lc_name = zend_str_tolower_dup(name, symbol->name_length);
+	result = zend_hash_find(function_table, lc_name, symbol->name_length + 1, (void **) &zfunc);
+	efree(lc_name);
+	if(result != SUCCESS) {
+		return FALSE;
+	}
+
+	// the function has to end up at the same position
+	return (qb_import_external_symbol(symbol->type, zfunc->common.function_name, symbol->name_length, zfunc TSRMLS_CC) == index);
+}
+
+static zval * qb_find_argument_default_value(zend_op_array *op_array, uint32_t argument_index) {
+	uint32_t i;
+	for(i = 0; i < op_array->last; i++) {
+		zend_op *zop = &op_array->opcodes[i];
+		if(zop->opcode == ZEND_RECV_INIT) {
+			uint32_t argument_number;
+#if !ZEND_ENGINE_2_3 && !ZEND_ENGINE_2_2 && !ZEND_ENGINE_2_1
+			argument_number = Z_OPERAND_INFO(zop->op1, num);
+#else
+			argument_number = Z_LVAL_P(Z_OPERAND_ZV(zop->op1));
+#endif
+			if(argument_number == argument_index + 1) {
+				return Z_OPERAND_ZV(zop->op2);
+			}
+		}
+	}
+	return NULL;
+}
+
+static int32_t qb_is_cached_range(const void *pointer, uint64_t length, uintptr_t block_address, uint32_t block_size) {
+	// pointers in a record still hold addresses within the original block; a damaged record
+	// must not lead us to read or write outside the copy
+	uintptr_t address = (uintptr_t) pointer;
+	return (address >= block_address && address - block_address <= block_size && length <= block_size - (address - block_address));
+}
+
+static int32_t qb_shift_cached_pointer(void *p_pointer, uint64_t length, qb_bytecode_cache_block *block) {
+	void **p = p_pointer;
+	if(!qb_is_cached_range(*p, length, block->address, block->size)) {
+		return FALSE;
+	}
+	SHIFT_POINTER(*p, block->shift);
+	return TRUE;
+}
+
+static int32_t qb_shift_address_pointers(qb_address *address, qb_bytecode_cache_block *block) {
+	// mirror the layout produced by qb_copy_address()
+	uint32_t i, j;
+	if(address->mode == QB_ADDRESS_MODE_SCA) {
+		return TRUE;
+	}
+	if(!qb_shift_cached_pointer(&address->dimension_addresses, sizeof(qb_address *) * (uint64_t) address->dimension_count, block)
+	|| !qb_shift_cached_pointer(&address->array_size_addresses, sizeof(qb_address *) * (uint64_t) address->dimension_count, block)
+	|| !qb_shift_cached_pointer(&address->array_size_address, sizeof(qb_address), block)) {
+		return FALSE;
+	}
+	if(address->dimension_count > 1) {
+		for(i = 0; i < address->dimension_count; i++) {
+			if(!qb_shift_cached_pointer(&address->dimension_addresses[i], sizeof(qb_address), block)
+			|| !qb_shift_cached_pointer(&address->array_size_addresses[i], sizeof(qb_address), block)) {
+				return FALSE;
+			}
+		}
+	}
+	if(address->array_index_address) {
+		if(!qb_shift_cached_pointer(&address->array_index_address, sizeof(qb_address), block)) {
+			return FALSE;
+		}
+	}
+	if(address->index_alias_schemes) {
+		if(!qb_shift_cached_pointer(&address->index_alias_schemes, sizeof(qb_index_alias_scheme *) * (uint64_t) address->dimension_count, block)) {
+			return FALSE;
+		}
+		for(i = 0; i < address->dimension_count; i++) {
+			if(address->index_alias_schemes[i]) {
+				qb_index_alias_scheme *scheme;
+				if(!qb_shift_cached_pointer(&address->index_alias_schemes[i], sizeof(qb_index_alias_scheme), block)) {
+					return FALSE;
+				}
+				scheme = address->index_alias_schemes[i];
+				if(!qb_shift_cached_pointer(&scheme->aliases, sizeof(char *) * (uint64_t) scheme->dimension, block)
+				|| !qb_shift_cached_pointer(&scheme->alias_lengths, sizeof(uint32_t) * (uint64_t) scheme->dimension, block)) {
+					return FALSE;
+				}
+				for(j = 0; j < scheme->dimension; j++) {
+					if(!qb_shift_cached_pointer(&scheme->aliases[j], (uint64_t) scheme->alias_lengths[j] + 1, block)) {
+						return FALSE;
+					}
+				}
+				if(scheme->class_name) {
+					if(!qb_shift_cached_pointer(&scheme->class_name, (uint64_t) scheme->class_name_length + 1, block)) {
+						return FALSE;
+					}
+				}
+				// looked up again when needed
+				scheme->zend_class = NULL;
+			}
+		}
+	}
+	return TRUE;
+}
+
+static int32_t qb_check_cached_storage(qb_bytecode_cache_record *record, int8_t *p) {
+	qb_storage *cached_storage = (qb_storage *) p;
+	qb_memory_segment *cached_segments;
+	uint32_t i, j;
+
+	if(record->storage_size < sizeof(qb_storage) || cached_storage->segment_count <= QB_SELECTOR_LAST_PREALLOCATED) {
+		return FALSE;
+	}
+	if(!qb_is_cached_range(cached_storage->segments, sizeof(qb_memory_segment) * (uint64_t) cached_storage->segment_count, record->storage_address, record->storage_size)) {
+		return FALSE;
+	}
+	cached_segments = (qb_memory_segment *) (p + ((uintptr_t) cached_storage->segments - record->storage_address));
+	for(i = 0; i < cached_storage->segment_count; i++) {
+		qb_memory_segment *segment = &cached_segments[i];
+		if(segment->stream || segment->imported_segment || segment->next_dependent) {
+			// nothing is attached to a function that has not run yet
+			return FALSE;
+		}
+		if(segment->memory) {
+			if(!qb_is_cached_range(segment->memory, segment->current_allocation, record->storage_address, record->storage_size)) {
+				return FALSE;
+			}
+		}
+		if(segment->reference_offsets) {
+			uint32_t *reference_offsets = (uint32_t *) (p + ((uintptr_t) segment->reference_offsets - record->storage_address));
+			if(!qb_is_cached_range(segment->reference_offsets, sizeof(uint32_t) * (uint64_t) segment->reference_count, record->storage_address, record->storage_size)) {
+				return FALSE;
+			}
+			// the offsets are used to update pointers in the instruction stream when the segment moves
+			for(j = 0; j < segment->reference_count; j++) {
+				if((uint64_t) reference_offsets[j] + sizeof(void *) > record->instruction_size) {
+					return FALSE;
+				}
+			}
+		}
+	}
+	return TRUE;
+}
+
+static qb_storage * qb_restore_storage(qb_bytecode_cache_record *record, int8_t *p, intptr_t *p_data_shift) {
+	qb_storage *cached_storage = (qb_storage *) p, *storage;
+	qb_memory_segment *cached_segments;
+	uint32_t data_start = record->storage_size, data_end = 0, new_data_start;
+	intptr_t shift;
+	uint32_t i;
+
+	if(!qb_check_cached_storage(record, p)) {
+		return NULL;
+	}
+
+	// find the preallocated segments, which sit in one contiguous block
+	cached_segments = (qb_memory_segment *) (p + ((uintptr_t) cached_storage->segments - record->storage_address));
+	for(i = 0; i < cached_storage->segment_count; i++) {
+		qb_memory_segment *segment = &cached_segments[i];
+		if(segment->memory) {
+			uint32_t start = (uint32_t) ((uintptr_t) segment->memory - record->storage_address);
+			uint32_t end = start + (uint32_t) segment->current_allocation;
+			if(start < data_start) {
+				data_start = start;
+			}
+			if(end > data_end) {
+				data_end = end;
+			}
+		}
+	}
+
+	// the new block might not have the same alignment as the original, so give it extra room
+	// and move the data so it's 16-byte aligned again
+	storage = emalloc(record->storage_size + 16);
+	if(data_start < data_end) {
+		new_data_start = (uint32_t) (ALIGN_TO((uintptr_t) storage + data_start, 16) - (uintptr_t) storage);
+		memcpy(storage, p, data_start);
+		memcpy((int8_t *) storage + new_data_start, p + data_start, data_end - data_start);
+	} else {
+		new_data_start = data_start = record->storage_size;
+		memcpy(storage, p, record->storage_size);
+	}
+	storage->size = record->storage_size + 16;
+
+	// adjust pointers within the storage structure
+	shift = (uintptr_t) storage - record->storage_address;
+	*p_data_shift = (intptr_t) new_data_start - (intptr_t) data_start;
+	SHIFT_POINTER(storage->segments, shift);
+	for(i = 0; i < storage->segment_count; i++) {
+		qb_memory_segment *segment = &storage->segments[i];
+		if(segment->memory) {
+			SHIFT_POINTER(segment->memory, shift + *p_data_shift);
+		}
+		if(segment->reference_offsets) {
+			SHIFT_POINTER(segment->reference_offsets, shift);
+		}
+	}
+	return storage;
+}
+
+static void qb_free_restored_function(qb_function *qfunc) {
+	efree(qfunc->instructions);
+	efree(qfunc->local_storage);
+	efree(qfunc);
+}
+
+static int32_t qb_check_cached_instructions(qb_bytecode_cache_record *record, qb_function *qfunc, int8_t *instructions) {
+	uint16_t *opcodes = (uint16_t *) (instructions + qfunc->instruction_length);
+	uint32_t i;
+	if((uint64_t) qfunc->instruction_length + sizeof(uint16_t) * (uint64_t) qfunc->instruction_opcode_count != record->instruction_size) {
+		return FALSE;
+	}
+	// relocation looks up the format of each op by its opcode
+	for(i = 0; i < qfunc->instruction_opcode_count; i++) {
+		if(opcodes[i] >= QB_OPCODE_COUNT) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static qb_function * qb_restore_function(qb_build_context *cxt, qb_bytecode_cache_record *record, int8_t *p TSRMLS_DC) {
+	qb_function_tag *tag = &cxt->function_tags[record->tag_index];
+	qb_function *qfunc;
+	qb_storage *storage;
+	qb_bytecode_cache_block block;
+	int8_t *instructions;
+	intptr_t data_shift;
+	uint32_t i;
+
+	// line ids contain the file's position in the list of source files
+	if(qb_get_source_file_id(tag->op_array->filename TSRMLS_CC) != record->source_file_id) {
+		return NULL;
+	}
+	if(record->function_size < sizeof(qb_function)) {
+		return NULL;
+	}
+
+	qfunc = emalloc(record->function_size);
+	memcpy(qfunc, p, record->function_size); p += ALIGN_TO(record->function_size, 8);
+	storage = qb_restore_storage(record, p, &data_shift); p += ALIGN_TO(record->storage_size, 8);
+	if(!storage) {
+		efree(qfunc);
+		return NULL;
+	}
+	instructions = emalloc(record->instruction_size);
+	memcpy(instructions, p, record->instruction_size);
+
+	qfunc->instructions = instructions;
+	qfunc->local_storage = storage;
+	if(!qb_check_cached_instructions(record, qfunc, instructions)) {
+		qb_free_restored_function(qfunc);
+		return NULL;
+	}
+	qfunc->instruction_opcodes = (uint16_t *) (instructions + qfunc->instruction_length);
+	qfunc->local_storage_base_address -= data_shift;
+	qfunc->name = tag->op_array->function_name;
+	qfunc->zend_op_array = tag->op_array;
+	qfunc->native_proc = NULL;
+	qfunc->call_count = 0;
+	qfunc->interpretation_time = 0;
+	qfunc->dimension_signature = NULL;
+	qfunc->next_specialization = NULL;
+	qfunc->dimension_profiles = NULL;
+	qfunc->next_reentrance_copy = NULL;
+	qfunc->next_forked_copy = NULL;
+	qfunc->in_use = 0;
+
+	// adjust pointers within the function structure
+	block.address = record->function_address;
+	block.size = record->function_size;
+	block.shift = (uintptr_t) qfunc - record->function_address;
+	if(!qb_shift_cached_pointer(&qfunc->variables, sizeof(qb_variable *) * (uint64_t) qfunc->variable_count, &block)) {
+		qb_free_restored_function(qfunc);
+		return NULL;
+	}
+	if((qfunc->return_variable && !qb_shift_cached_pointer(&qfunc->return_variable, sizeof(qb_variable), &block))
+	|| (qfunc->return_key_variable && !qb_shift_cached_pointer(&qfunc->return_key_variable, sizeof(qb_variable), &block))
+	|| (qfunc->sent_variable && !qb_shift_cached_pointer(&qfunc->sent_variable, sizeof(qb_variable), &block))) {
+		qb_free_restored_function(qfunc);
+		return NULL;
+	}
+	for(i = 0; i < qfunc->variable_count; i++) {
+		qb_variable *qvar;
+		if(!qb_shift_cached_pointer(&qfunc->variables[i], sizeof(qb_variable), &block)) {
+			qb_free_restored_function(qfunc);
+			return NULL;
+		}
+		qvar = qfunc->variables[i];
+		if(qvar->name) {
+			if(!qb_shift_cached_pointer(&qvar->name, (uint64_t) qvar->name_length + 1, &block)) {
+				qb_free_restored_function(qfunc);
+				return NULL;
+			}
+		}
+		if(qvar->address) {
+			if(!qb_shift_cached_pointer(&qvar->address, sizeof(qb_address), &block) || !qb_shift_address_pointers(qvar->address, &block)
+			|| qvar->address->segment_selector >= storage->segment_count) {
+				qb_free_restored_function(qfunc);
+				return NULL;
+			}
+		}
+		if(qvar->default_value) {
+			qvar->default_value = qb_find_argument_default_value(tag->op_array, i);
+			if(!qvar->default_value) {
+				qb_free_restored_function(qfunc);
+				return NULL;
+			}
+		}
+		qvar->zend_class = NULL;
+	}
+
+	return qfunc;
+}
+
+static int32_t qb_decode_cached_functions(qb_build_context *cxt, int8_t *data, size_t length) {
+	USE_TSRM
+	int8_t *p = data, *end = data + length;
+	qb_bytecode_cache_header *header;
+	qb_function **functions;
+	uint32_t i, restored_count = 0;
+
+	header = (qb_bytecode_cache_header *) p; p += sizeof(qb_bytecode_cache_header);
+	if(p > end || memcmp(header->signature, qb_bytecode_cache_signature, sizeof(header->signature)) != 0) {
+		return FALSE;
+	}
+	if(header->qb_version != QB_VERSION_SIGNATURE || header->key != cxt->cache_key || header->function_count != cxt->function_tag_count) {
+		return FALSE;
+	}
+
+	for(i = 0; i < header->symbol_count; i++) {
+		qb_bytecode_cache_symbol *symbol = (qb_bytecode_cache_symbol *) p;
+		const char *class_name, *name;
+		p += sizeof(qb_bytecode_cache_symbol);
+		if(p > end) {
+			return FALSE;
+		}
+		class_name = (const char *) p; p += ALIGN_TO(symbol->class_name_length, 8);
+		name = (const char *) p; p += ALIGN_TO(symbol->name_length, 8);
+		if(p > end || !qb_restore_external_symbol(symbol, class_name, name, i TSRMLS_CC)) {
+			return FALSE;
+		}
+	}
+
+	functions = ecalloc(header->function_count, sizeof(qb_function *));
+	for(i = 0; i < header->function_count; i++) {
+		qb_bytecode_cache_record *record = (qb_bytecode_cache_record *) p;
+		qb_function *qfunc = NULL;
+		if(p + sizeof(qb_bytecode_cache_record) <= end && p + qb_get_cache_record_length(record) <= end) {
+			if(record->tag_index < header->function_count && !functions[record->tag_index]) {
+				qfunc = qb_restore_function(cxt, record, p + sizeof(qb_bytecode_cache_record) TSRMLS_CC);
+			}
+		}
+		if(!qfunc) {
+			break;
+		}
+		functions[record->tag_index] = qfunc;
+		restored_count++;
+		p += qb_get_cache_record_length(record);
+	}
+
+	if(restored_count == header->function_count) {
+		for(i = 0; i < header->function_count; i++) {
+			qb_function *qfunc = functions[i];
+			qb_relocate_function(qfunc, TRUE);
+			qb_attach_compiled_function(qfunc, cxt->function_tags[i].op_array TSRMLS_CC);
+		}
+	} else {
+		for(i = 0; i < header->function_count; i++) {
+			if(functions[i]) {
+				qb_free_restored_function(functions[i]);
+			}
+		}
+	}
+	efree(functions);
+	return (restored_count == header->function_count);
+}
+
+static int32_t qb_verify_cache_file_checksum(int8_t *data, size_t length) {
+	// a truncated or damaged file must not get as far as the pointer adjustments
+	qb_bytecode_cache_header *header = (qb_bytecode_cache_header *) data;
+	uint64_t checksum = qb_calculate_crc64((const uint8_t *) data + sizeof(qb_bytecode_cache_header), length - sizeof(qb_bytecode_cache_header), 0);
+	return (header->checksum == checksum);
+}
+
+int32_t qb_load_cached_functions(qb_build_context *cxt) {
+	USE_TSRM
+	qb_bytecode_cache_entry *entry;
+	int32_t success = FALSE;
+	char *file_path;
+	php_stream *stream;
+
+	cxt->cache_key = 0;
+	if(!QB_G(allow_bytecode_cache) || !QB_G(allow_bytecode_interpretation) || QB_G(show_opcodes) || QB_G(show_source_opcodes) || cxt->native_recompilation || cxt->dimension_signature) {
+		return FALSE;
+	}
+	cxt->cache_key = qb_calculate_cache_key(cxt);
+	if(!cxt->cache_key) {
+		return FALSE;
+	}
+
+	// look in memory first, in case the functions were built earlier by the same process
+	entry = qb_find_entry_in_memory_cache(cxt->cache_key TSRMLS_CC);
+	if(entry) {
+		return qb_decode_cached_functions(cxt, entry->data, entry->length);
+	}
+
+	file_path = qb_get_cache_file_path(cxt->cache_key TSRMLS_CC);
+	if(!file_path) {
+		return FALSE;
+	}
+	stream = php_stream_open_wrapper(file_path, "rb", 0, NULL);
+	if(stream) {
+		char *data = NULL;
+		size_t length = php_stream_copy_to_mem(stream, &data, PHP_STREAM_COPY_ALL, FALSE);
+		php_stream_close(stream);
+		if(data) {
+			if(length >= sizeof(qb_bytecode_cache_header) && qb_verify_cache_file_checksum((int8_t *) data, length)) {
+				success = qb_decode_cached_functions(cxt, (int8_t *) data, length);
+				if(success) {
+					int8_t *copy = pemalloc(length, TRUE);
+					memcpy(copy, data, length);
+					qb_add_entry_to_memory_cache(cxt->cache_key, copy, length TSRMLS_CC);
+				}
+			}
+			efree(data);
+		}
+	}
+	efree(file_path);
+	return success;
+}
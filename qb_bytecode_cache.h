@@ -0,0 +1,75 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2012 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Chung Leong <cleong@cal.berkeley.edu>                        |
+  +----------------------------------------------------------------------+
+*/
+
+/* $Id$ */
+
+#ifndef QB_BYTECODE_CACHE_H_
+#define QB_BYTECODE_CACHE_H_
+
+typedef struct qb_bytecode_cache_header		qb_bytecode_cache_header;
+typedef struct qb_bytecode_cache_symbol		qb_bytecode_cache_symbol;
+typedef struct qb_bytecode_cache_record		qb_bytecode_cache_record;
+typedef struct qb_bytecode_cache_entry		qb_bytecode_cache_entry;
+typedef struct qb_bytecode_cache_block		qb_bytecode_cache_block;
+
+struct qb_bytecode_cache_header {
+	char signature[4];
+	uint32_t qb_version;
+	uint64_t key;
+	uint32_t function_count;
+	uint32_t symbol_count;
+	uint64_t checksum;							// crc64 of everything following the header
+};
+
+struct qb_bytecode_cache_symbol {
+	uint32_t type;
+	uint32_t class_name_length;
+	uint32_t name_length;
+};
+
+struct qb_bytecode_cache_record {
+	uint32_t tag_index;
+	uint32_t source_file_id;
+	uint32_t function_size;
+	uint32_t storage_size;
+	uint32_t instruction_size;
+	uintptr_t function_address;
+	uintptr_t storage_address;
+	uintptr_t instruction_address;
+};
+
+struct qb_bytecode_cache_entry {
+	uint64_t key;
+	int8_t *data;
+	size_t length;
+};
+
+struct qb_bytecode_cache_block {
+	uintptr_t address;							// address of the block when it was saved
+	uint32_t size;
+	intptr_t shift;								// distance to the restored copy
+};
+
+int32_t qb_load_cached_functions(qb_build_context *cxt);
+void qb_add_function_to_cache(qb_build_context *cxt, qb_compiler_context *compiler_cxt, uint32_t function_size);
+void qb_save_cached_functions(qb_build_context *cxt);
+void qb_free_cached_function_records(qb_build_context *cxt);
+
+void qb_free_bytecode_cache_entry(void *p);
+
+#endif
@@ -598,7 +598,7 @@ void qb_allocate_storage_space(qb_compiler_context *cxt, qb_address *address, in
 		// create a new segment if necessary
 		if(selector >= cxt->storage->segment_count) {
 			cxt->storage->segment_count = selector + 1;
-			cxt->storage->segments = erealloc(cxt->storage->segments, sizeof(qb_memory_segment) * cxt->storage->segment_count);
+			cxt->storage->segments = qb_reallocate_memory(cxt->storage->segments, sizeof(qb_memory_segment) * cxt->storage->segment_count);
 			segment = &cxt->storage->segments[selector];
 			memset(segment, 0, sizeof(qb_memory_segment));
 			segment->flags = new_segment_flags;
@@ -606,7 +606,7 @@ void qb_allocate_storage_space(qb_compiler_context *cxt, qb_address *address, in
 			segment = &cxt->storage->segments[selector];
 		}
 
-		start_offset = ALIGN_TO(segment->byte_count, alignment);
+		start_offset = (uint32_t) ALIGN_TO(segment->byte_count, alignment);
 		end_offset = start_offset + byte_count;
 
 		// allocate memory if we're going to write to the address at compile time
@@ -617,7 +617,7 @@ void qb_allocate_storage_space(qb_compiler_context *cxt, qb_address *address, in
 				if(end_offset > segment->current_allocation) {
 					segment->current_allocation = end_offset;
 				}
-				segment->memory = erealloc(segment->memory, segment->current_allocation);
+				segment->memory = qb_reallocate_memory(segment->memory, segment->current_allocation);
 			}
 			if(start_offset > segment->byte_count) {
 				// clear the padding bytes since we might calculate the checksum of the memory segment
@@ -732,6 +732,18 @@ void qb_assign_storage_space(qb_compiler_context *cxt) {
 		qb_address *address = cxt->address_aliases[i];
 		qb_update_storage_location(cxt, address);
 	}
+
+	// pass the size hints from array_reserve() to the segments
+	for(i = 0; i < cxt->array_reservation_count; i++) {
+		qb_array_reservation *reservation = &cxt->array_reservations[i];
+		qb_address *address = reservation->address;
+		if(address->segment_selector >= QB_SELECTOR_ARRAY_START && address->segment_selector < cxt->storage->segment_count) {
+			qb_memory_segment *segment = &cxt->storage->segments[address->segment_selector];
+			if(segment->reserved_byte_count < reservation->byte_count) {
+				segment->reserved_byte_count = reservation->byte_count;
+			}
+		}
+	}
 }
 
 qb_address * qb_create_address_alias(qb_compiler_context *cxt, qb_address *address) {
@@ -2048,6 +2060,25 @@ static qb_type_declaration * qb_find_variable_declaration(qb_compiler_context *c
 	return decl;
 }
 
+static uint32_t * qb_get_specialized_dimensions(qb_compiler_context *cxt, qb_variable *qvar, qb_type_declaration *decl) {
+	// arguments are added in order, so the index of the argument is the current variable count
+	uint32_t index = cxt->variable_count;
+	if(cxt->dimension_signature && (qvar->flags & QB_VARIABLE_ARGUMENT) && index < MAX_SPECIALIZED_ARGUMENTS) {
+		uint32_t *dimensions = cxt->dimension_signature->dimensions[index];
+		uint32_t i;
+		if(cxt->dimension_signature->dimension_counts[index] != decl->dimension_count) {
+			return decl->dimensions;
+		}
+		for(i = 0; i < decl->dimension_count; i++) {
+			if(decl->dimensions[i] != 0 && decl->dimensions[i] != dimensions[i]) {
+				return decl->dimensions;
+			}
+		}
+		return dimensions;
+	}
+	return decl->dimensions;
+}
+
 int32_t qb_apply_type_declaration(qb_compiler_context *cxt, qb_variable *qvar) {
 	qb_type_declaration *decl = qb_find_variable_declaration(cxt, qvar);
 	if(decl) {
@@ -2059,7 +2090,9 @@ int32_t qb_apply_type_declaration(qb_compiler_context *cxt, qb_variable *qvar) {
 			if(decl->dimension_count == 0) {
 				address = qb_create_writable_scalar(cxt, decl->type);
 			} else {
-				address = qb_create_writable_array(cxt, decl->type, decl->dimensions, decl->dimension_count);
+				// a specialized version of the function uses the dimensions seen at runtime
+				uint32_t *dimensions = qb_get_specialized_dimensions(cxt, qvar, decl);
+				address = qb_create_writable_array(cxt, decl->type, dimensions, decl->dimension_count);
 				if(decl->flags & QB_TYPE_DECL_AUTOVIVIFICIOUS) {
 					address->flags |= QB_ADDRESS_AUTOVIVIFICIOUS;
 				}
@@ -2117,6 +2150,9 @@ int32_t qb_perform_static_initialization(qb_compiler_context *cxt, qb_variable *
 		// function that uses static variables cannot be inlined
 		cxt->function_flags &= ~QB_FUNCTION_INLINEABLE;
 
+		// nor rebuilt, since the values would be lost
+		cxt->function_flags |= QB_FUNCTION_STATIC_VARIABLES;
+
 		if(qvar->address->type == QB_TYPE_S64 || qvar->address->type == QB_TYPE_U64) {
 			// initializing 64-bit integer might require special handling
 			qb_primitive_type desired_type = qvar->address->type;
@@ -4091,6 +4127,70 @@ int32_t qb_check_thread_safety(qb_compiler_context *cxt) {
 	return qb_check_thread_safety_in_range(cxt, 0, cxt->op_count - 1, FALSE);
 }
 
+static void qb_mark_segment_as_written(qb_compiler_context *cxt, qb_address *address, int8_t *written) {
+	if(address->segment_selector >= QB_SELECTOR_ARRAY_START && address->segment_selector < cxt->storage->segment_count) {
+		written[address->segment_selector] = TRUE;
+	}
+}
+
+static void qb_find_segments_written_in_range(qb_compiler_context *cxt, uint32_t start_index, int32_t forked, int8_t *written) {
+	uint32_t i, j;
+	for(i = start_index; i < cxt->op_count; i++) {
+		qb_op *qop = cxt->ops[i];
+		uint32_t scanned_flag = (forked) ? QB_OP_SCANNED_IN_FORK : QB_OP_SCANNED;
+		if(qop->flags & scanned_flag) {
+			break;
+		}
+		qop->flags |= scanned_flag;
+		if(forked) {
+			if(qop->opcode == QB_RET) {
+				break;
+			} else if(qop->opcode == QB_SPOON) {
+				forked = FALSE;
+			} else if(qop->opcode == QB_FCALL_U32_U32_U32) {
+				// arguments can be passed by reference, so assume the callee changes all of them
+				uint32_t *argument_indices = ARRAY(U32, qop->operands[1].address);
+				uint32_t argument_count = ARRAY_SIZE(qop->operands[1].address);
+				uint32_t retvar_index = VALUE(U32, qop->operands[2].address);
+				for(j = 0; j < argument_count; j++) {
+					qb_mark_segment_as_written(cxt, cxt->variables[argument_indices[j]]->address, written);
+				}
+				if(retvar_index != INVALID_INDEX) {
+					qb_mark_segment_as_written(cxt, cxt->variables[retvar_index]->address, written);
+				}
+			} else {
+				for(j = 0; j < qop->operand_count; j++) {
+					if(qop->operands[j].type == QB_OPERAND_ADDRESS && qb_is_operand_write_target(qop->opcode, j)) {
+						qb_mark_segment_as_written(cxt, qop->operands[j].address, written);
+					}
+				}
+			}
+		} else {
+			if(qop->opcode == QB_FORK_U32) {
+				forked = TRUE;
+			}
+		}
+		for(j = 0; j < qop->jump_target_count; j++) {
+			qb_find_segments_written_in_range(cxt, qop->jump_target_indices[j], forked, written);
+		}
+	}
+}
+
+void qb_resolve_fork_separation(qb_compiler_context *cxt) {
+	// a fork gets its own copy of a segment only if the forked code writes to it;
+	// otherwise it imports the segment from the function being forked
+	int8_t *written = alloca(cxt->storage->segment_count);
+	uint32_t i;
+	memset(written, 0, cxt->storage->segment_count);
+	qb_find_segments_written_in_range(cxt, 0, FALSE, written);
+	for(i = QB_SELECTOR_ARRAY_START; i < cxt->storage->segment_count; i++) {
+		qb_memory_segment *segment = &cxt->storage->segments[i];
+		if((segment->flags & QB_SEGMENT_SEPARATE_ON_FORK) && !written[i]) {
+			segment->flags &= ~QB_SEGMENT_SEPARATE_ON_FORK;
+		}
+	}
+}
+
 void qb_initialize_compiler_context(qb_compiler_context *cxt, qb_data_pool *pool, qb_function_declaration *function_decl, uint32_t dependency_index, uint32_t max_dependency_index TSRMLS_DC) {
 	uint32_t zero = 0;
 
@@ -4130,6 +4230,7 @@ void qb_initialize_compiler_context(qb_compiler_context *cxt, qb_data_pool *pool
 	qb_attach_new_array(pool, (void **) &cxt->writable_arrays, &cxt->writable_array_count, sizeof(qb_address *), 16);
 	qb_attach_new_array(pool, (void **) &cxt->address_aliases, &cxt->address_alias_count, sizeof(qb_address *), 64);
 	qb_attach_new_array(pool, (void **) &cxt->on_demand_expressions, &cxt->on_demand_expression_count, sizeof(qb_address *), 64);
+	qb_attach_new_array(pool, (void **) &cxt->array_reservations, &cxt->array_reservation_count, sizeof(qb_array_reservation), 4);
 
 	// only set up segments for scalars and fixed-length arrays initially
 	cxt->storage = emalloc(sizeof(qb_storage));
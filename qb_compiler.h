@@ -25,6 +25,7 @@ typedef struct qb_compiler_context			qb_compiler_context;
 typedef struct qb_diagnostics				qb_diagnostics;
 typedef struct qb_variable_dimensions		qb_variable_dimensions;
 typedef struct qb_jump_target				qb_jump_target;
+typedef struct qb_array_reservation			qb_array_reservation;
 
 typedef enum qb_stage						qb_stage;
 typedef enum qb_diagnostic_type				qb_diagnostic_type;
@@ -43,6 +44,11 @@ struct qb_jump_target {
 	uint32_t jump_target_index;
 };
 
+struct qb_array_reservation {
+	qb_address *address;
+	uint32_t byte_count;
+};
+
 #define JUMP_TARGET_INDEX(source_index, offset)				(((offset) << 24) | (source_index))
 #define OP_INDEX_OFFSET(jump_target_index)					((int8_t) ((jump_target_index) >> 24))
 #define OP_INDEX(jump_target_index)							((jump_target_index) & 0x00FFFFFF)
@@ -83,6 +89,7 @@ struct qb_compiler_context {
 	qb_function function_prototype;
 	qb_function_declaration *function_declaration;
 	uint32_t function_flags;
+	qb_dimension_signature *dimension_signature;
 
 	qb_storage *storage;
 
@@ -115,6 +122,9 @@ struct qb_compiler_context {
 	qb_jump_target *jump_targets;
 	uint32_t jump_target_count;
 
+	qb_array_reservation *array_reservations;
+	uint32_t array_reservation_count;
+
 	qb_address *zero_address;
 	qb_address *one_address;
 	qb_address *false_address;
@@ -196,7 +206,7 @@ enum {
 // NOTE: never attach a stack variable
 static zend_always_inline void qb_attach_new_array(qb_data_pool *pool, void **p_array, uint32_t *p_count, uint32_t item_size, uint32_t initial_capacity) {
 	void ***pp_array = (void ***) qb_enlarge_array((void **) &pool->arrays, 1);
-	qb_create_array(p_array, p_count, item_size, initial_capacity);
+	qb_create_pool_array(pool, p_array, p_count, item_size, initial_capacity);
 	*pp_array = p_array;
 }
 
@@ -435,6 +445,7 @@ void qb_assign_storage_space(qb_compiler_context *cxt);
 void qb_resolve_address_modes(qb_compiler_context *cxt);
 void qb_resolve_reference_counts(qb_compiler_context *cxt);
 int32_t qb_check_thread_safety(qb_compiler_context *cxt);
+void qb_resolve_fork_separation(qb_compiler_context *cxt);
 
 void qb_initialize_compiler_context(qb_compiler_context *cxt, qb_data_pool *pool, qb_function_declaration *function_decl, uint32_t dependency_index, uint32_t max_dependency_index TSRMLS_DC);
 void qb_free_compiler_context(qb_compiler_context *cxt);
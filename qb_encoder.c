@@ -46,8 +46,7 @@ static void qb_add_segment_reference(qb_encoder_context *cxt, qb_address *addres
 	qb_memory_segment *segment = &cxt->storage->segments[address->segment_selector];
 	// don't add relocation pointers for those pointing to preallocated segments 
 	if(!(segment->flags & QB_SEGMENT_PREALLOCATED)) {
-		uintptr_t **p_reference = &segment->references[segment->reference_count++];
-		*p_reference = (uintptr_t *) ((void *) (cxt->instruction_base_address + ((uintptr_t) p_pointer - (uintptr_t) cxt->instructions)));
+		segment->reference_offsets[segment->reference_count++] = (uint32_t) ((uintptr_t) p_pointer - (uintptr_t) cxt->instructions);
 	}
 }
 
@@ -490,7 +489,7 @@ int8_t * qb_copy_variable(qb_variable *qvar, int8_t *memory) {
 	return p;
 }
 
-static uint32_t qb_get_function_structure_size(qb_encoder_context *cxt) {
+uint32_t qb_get_function_structure_size(qb_encoder_context *cxt) {
 	uint32_t size = sizeof(qb_function);
 	uint32_t i;
 
@@ -534,8 +533,13 @@ static int8_t * qb_copy_function_structure(qb_encoder_context *cxt, int8_t *memo
 	qfunc->name = cxt->compiler_context->function_prototype.name;
 	qfunc->line_id = cxt->compiler_context->function_prototype.line_id;
 	qfunc->native_proc = NULL;
+	qfunc->call_count = 0;
+	qfunc->interpretation_time = 0;
 	qfunc->zend_op_array = cxt->compiler_context->zend_op_array;
 	qfunc->flags = cxt->compiler_context->function_flags;
+	qfunc->dimension_signature = NULL;
+	qfunc->next_specialization = NULL;
+	qfunc->dimension_profiles = NULL;
 	qfunc->next_reentrance_copy = NULL;
 	qfunc->next_forked_copy = NULL;
 	qfunc->in_use = 0;
@@ -554,7 +558,7 @@ static uint32_t qb_get_storage_structure_size(qb_encoder_context *cxt) {
 	size = ALIGN_TO(size, sizeof(uintptr_t));
 	for(i = 0; i < cxt->compiler_context->storage->segment_count; i++) {
 		qb_memory_segment *src = &cxt->compiler_context->storage->segments[i];
-		size += src->reference_count * sizeof(uintptr_t *);
+		size += src->reference_count * sizeof(uint32_t);
 	}
 	return size;
 }
@@ -582,15 +586,18 @@ static int8_t * qb_copy_storage_structure(qb_encoder_context *cxt, int8_t * memo
 		dst->memory = NULL;
 		dst->imported_segment = NULL;
 		dst->next_dependent = NULL;
+		dst->reserved_byte_count = src->reserved_byte_count;
+		dst->relocation_count = 0;
+		dst->checksum = 0;
 
 		// increment the reference count as references are added
 		dst->reference_count = 0;
+		dst->reference_base = NULL;
 		if(src->reference_count > 0) {
-			p = (int8_t *) ALIGN_TO((uintptr_t) p, sizeof(uintptr_t));
-			dst->references = (uintptr_t **) p;
-			p += src->reference_count * sizeof(uintptr_t *);
+			dst->reference_offsets = (uint32_t *) p;
+			p += src->reference_count * sizeof(uint32_t);
 		} else {
-			dst->references = NULL;
+			dst->reference_offsets = NULL;
 		}
 	}
 
@@ -608,7 +615,7 @@ static uint32_t qb_get_preallocated_segment_size(qb_encoder_context *cxt) {
 	for(i = 0; i < cxt->compiler_context->storage->segment_count; i++) {
 		qb_memory_segment *src = &cxt->compiler_context->storage->segments[i];
 		if(src->flags & QB_SEGMENT_PREALLOCATED) {
-			uint32_t segment_length = ALIGN_TO(src->byte_count, 16); 
+			uint32_t segment_length = (uint32_t) ALIGN_TO(src->byte_count, 16); 
 			size += segment_length;
 		}
 	}
@@ -627,7 +634,7 @@ static int8_t * qb_preallocate_segments(qb_encoder_context *cxt, int8_t *memory,
 		if(dst->flags & QB_SEGMENT_PREALLOCATED) {
 			qb_memory_segment *src = &cxt->compiler_context->storage->segments[i];
 			qb_memory_segment *dst = &storage->segments[i];
-			uint32_t segment_length = ALIGN_TO(src->byte_count, 16); 
+			uint32_t segment_length = (uint32_t) ALIGN_TO(src->byte_count, 16); 
 
 			dst->memory = p;
 			dst->current_allocation = segment_length;
@@ -681,6 +688,7 @@ qb_function * qb_encode_function(qb_encoder_context *cxt) {
 	qb_function *qfunc;
 	int8_t *p;
 	uint32_t function_struct_size, storage_struct_size, preallocated_segment_size, instruction_length, opcode_length;
+	uint32_t i;
 
 	// set the offset of the op
 	qb_set_instruction_offsets(cxt);
@@ -693,7 +701,7 @@ qb_function * qb_encode_function(qb_encoder_context *cxt) {
 	opcode_length = sizeof(uint16_t) * cxt->instruction_op_count;
 
 	// allocate memory for the function structure
-	p = emalloc(function_struct_size + 16);
+	p = qb_allocate_memory(function_struct_size + 16);
 
 	// copy stuff into the function structure 
 	qfunc = (qb_function *) p;
@@ -701,7 +709,7 @@ qb_function * qb_encode_function(qb_encoder_context *cxt) {
 
 	// allocate memory for the storage structure and preallocatd segments
 	// add a bit of padding in case the pointer returned isn't aligned
-	p = emalloc(storage_struct_size + preallocated_segment_size + 16);
+	p = qb_allocate_memory(storage_struct_size + preallocated_segment_size + 16);
 
 	// copy stuff into the storage structure 
 	qfunc->local_storage = (qb_storage *) p;
@@ -713,7 +721,7 @@ qb_function * qb_encode_function(qb_encoder_context *cxt) {
 	p = qb_preallocate_segments(cxt, p, qfunc->local_storage);
 
 	// allocate memory for the instruction stream and opcode array
-	p = emalloc(instruction_length + opcode_length);
+	p = qb_allocate_memory(instruction_length + opcode_length);
 
 	// encode the instructions
 	qfunc->instructions = cxt->instructions = p;
@@ -744,6 +752,12 @@ qb_function * qb_encode_function(qb_encoder_context *cxt) {
 		qfunc->instruction_base_address = (uintptr_t) cxt->instructions;
 		qfunc->local_storage_base_address = (uintptr_t) cxt->storage;
 	}
+
+	// relocation offsets are relative to the start of the instruction stream
+	for(i = 0; i < qfunc->local_storage->segment_count; i++) {
+		qb_memory_segment *segment = &qfunc->local_storage->segments[i];
+		segment->reference_base = (int8_t *) qfunc->instruction_base_address;
+	}
 	return qfunc;
 }
 
@@ -759,7 +773,7 @@ intptr_t qb_relocate_function(qb_function *qfunc, int32_t reentrance) {
 	intptr_t storage_shift = ((uintptr_t) qfunc->local_storage) - qfunc->local_storage_base_address;
 	if(instruction_shift || storage_shift) {
 		int8_t *ip = qfunc->instructions;
-		uint32_t i, j;
+		uint32_t i;
 		int32_t initializing = !(qfunc->flags & QB_FUNCTION_INITIALIZED);
 		uintptr_t range_start, range_end;
 		qb_memory_segment *segment_start, *segment_end;
@@ -900,12 +914,10 @@ intptr_t qb_relocate_function(qb_function *qfunc, int32_t reentrance) {
 		SHIFT_POINTER(qfunc->instruction_start, instruction_shift);
 
 		if(!(qfunc->flags & QB_FUNCTION_INITIALIZED)) {
-			// update the reallocation pointers
+			// update the base of the relocation offsets
 			for(i = QB_SELECTOR_LAST_PREALLOCATED + 1; i < qfunc->local_storage->segment_count; i++) {
 				qb_memory_segment *segment = &qfunc->local_storage->segments[i];
-				for(j = 0; j < segment->reference_count; j++) {
-					SHIFT_POINTER(segment->references[j], instruction_shift);
-				}
+				SHIFT_POINTER(segment->reference_base, instruction_shift);
 			}
 		}
 	}
@@ -989,6 +1001,10 @@ void qb_free_function(qb_function *qfunc) {
 		if(segment->current_allocation) {
 			if(segment->flags & QB_SEGMENT_MAPPED) {
 				// PHP should have clean it already
+			} else if(segment->flags & QB_SEGMENT_THREAD_ALLOCATED) {
+				free(segment->memory);
+			} else if(segment->flags & QB_SEGMENT_PAGE_ALLOCATED) {
+				qb_free_pages(segment->memory, segment->current_allocation);
 			} else if(!(segment->flags & QB_SEGMENT_BORROWED)) {
 				efree(segment->memory);
 			}
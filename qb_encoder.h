@@ -47,6 +47,7 @@ qb_function * qb_encode_function(qb_encoder_context *cxt);
 int8_t * qb_encode_instruction_stream(qb_encoder_context *cxt, int8_t *memory);
 void qb_set_instruction_offsets(qb_encoder_context *cxt);
 
+uint32_t qb_get_function_structure_size(qb_encoder_context *cxt);
 uint32_t qb_get_variable_length(qb_variable *qvar);
 int8_t * qb_copy_variable(qb_variable *qvar, int8_t *memory);
 
@@ -155,6 +155,18 @@ void qb_dispatch_exceptions(TSRMLS_D) {
 	}
 }
 
+// drop exceptions raised after the first keep_count without showing them
+void qb_discard_exceptions(uint32_t keep_count TSRMLS_DC) {
+	uint32_t i;
+	for(i = keep_count; i < QB_G(exception_count); i++) {
+		qb_exception *exception = &QB_G(exceptions)[i];
+		efree(exception->message);
+	}
+	if(QB_G(exception_count) > keep_count) {
+		QB_G(exception_count) = keep_count;
+	}
+}
+
 typedef struct qb_exception_params {
 	uint32_t line_id;
 	int32_t type;
@@ -654,6 +666,10 @@ void qb_report_memory_map_exception(uint32_t line_id, const char *file_path) {
 	qb_report_exception(line_id, E_ERROR, "Cannot map file into memory: %s", file_path);
 }
 
+void qb_report_too_many_elements_exception(uint32_t line_id, uint64_t byte_count) {
+	qb_report_exception(line_id, E_ERROR, "Too many elements in %.0f bytes of data", (double) byte_count);
+}
+
 void qb_report_argument_size_mismatch_exception(uint32_t line_id, uint32_t dimension, uint32_t dimension_expected) {
 	qb_report_exception(line_id, E_ERROR, "Number of element (%u) exceeds the declared size of the array (%u)", dimension, dimension_expected);
 }
@@ -687,6 +703,14 @@ void qb_report_undefined_dimension_exception(uint32_t line_id) {
 	qb_report_exception(line_id, E_ERROR, "Cannot derived element count due to undefined lower dimension");
 }
 
+void qb_report_invalid_buffer_type_exception(uint32_t line_id, const char *type_name) {
+	qb_report_exception(line_id, E_WARNING, "Invalid element type for buffer: %s", type_name);
+}
+
+void qb_report_buffer_too_large_exception(uint32_t line_id, uint64_t byte_count) {
+	qb_report_exception(line_id, E_WARNING, "Buffer is too large to be returned as a string: %" PRIu64 " bytes", byte_count);
+}
+
 void qb_report_illegal_conversion_to_array_exception(uint32_t line_id, const char *object) {
 	const char *article = qb_get_indefinite_article(object);
 	qb_report_exception(line_id, E_ERROR, "Cannot convert %s %s to an array", article, object);
@@ -37,6 +37,7 @@ void qb_set_exception_line_id(uint32_t line_id TSRMLS_DC);
 void qb_append_exception_variable_name(qb_variable *qvar TSRMLS_DC);
 
 void qb_dispatch_exceptions(TSRMLS_D);
+void qb_discard_exceptions(uint32_t keep_count TSRMLS_DC);
 
 void qb_report_external_code_load_failure_exception(uint32_t line_id, const char *import_path);
 void qb_report_corrupted_pbj_exception(uint32_t line_id);
@@ -118,12 +119,15 @@ void qb_report_too_much_recursion_exception(uint32_t line_id, uint32_t call_dept
 void qb_report_illegal_array_structure_exception(uint32_t line_id);
 void qb_report_binary_string_size_mismatch_exception(uint32_t line_id, uint32_t byte_count, qb_primitive_type type);
 void qb_report_memory_map_exception(uint32_t line_id, const char *file_path);
+void qb_report_too_many_elements_exception(uint32_t line_id, uint64_t byte_count);
 void qb_report_argument_size_mismatch_exception(uint32_t line_id, uint32_t dimension, uint32_t dimension_expected);
 void qb_report_image_width_mismatch_exception(uint32_t line_id, uint32_t width, uint32_t width_expected);
 void qb_report_image_height_mismatch_exception(uint32_t line_id, uint32_t height, uint32_t height_expected);
 void qb_report_pixel_count_mismatch_exception(uint32_t line_id, uint32_t pixel_count, uint32_t pixel_count_expected);
 void qb_report_invalid_variable_for_image_exception(uint32_t line_id, uint32_t dimension_count, int32_t true_color);
 void qb_report_undefined_dimension_exception(uint32_t line_id);
+void qb_report_invalid_buffer_type_exception(uint32_t line_id, const char *type_name);
+void qb_report_buffer_too_large_exception(uint32_t line_id, uint64_t byte_count);
 void qb_report_illegal_conversion_to_array_exception(uint32_t line_id, const char *object);
 void qb_report_illegal_conversion_from_array_exception(uint32_t line_id, const char *object);
 void qb_report_missing_class_exception(uint32_t line_id, const char *class_name);
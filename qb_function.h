@@ -23,6 +23,8 @@
 
 typedef struct qb_variable					qb_variable;
 typedef struct qb_native_code_bundle		qb_native_code_bundle;
+typedef struct qb_dimension_signature		qb_dimension_signature;
+typedef struct qb_dimension_profile			qb_dimension_profile;
 
 typedef enum qb_external_symbol_type		qb_external_symbol_type;
 
@@ -108,6 +110,9 @@ enum {
 	QB_FUNCTION_HAS_BREAKPOINTS		= 0x00002000,
 	QB_FUNCTION_MULTITHREADED		= 0x00004000,
 	QB_FUNCTION_CLOSURE				= 0x00008000,
+	QB_FUNCTION_NATIVE_QUEUED		= 0x00010000,
+	QB_FUNCTION_STATIC_VARIABLES	= 0x00020000,
+	QB_FUNCTION_NOT_SPECIALIZABLE	= 0x00040000,
 };
 
 struct qb_function {
@@ -128,17 +133,42 @@ struct qb_function {
 	const char *name;
 	uint32_t line_id;
 	void *native_proc;
+	uint32_t call_count;
+	double interpretation_time;
 	uintptr_t instruction_base_address;
 	uintptr_t local_storage_base_address;
 	zend_op_array *zend_op_array;
+	qb_dimension_signature *dimension_signature;
+	qb_function *next_specialization;
+	qb_dimension_profile *dimension_profiles;
 	qb_function *next_reentrance_copy;
 	qb_function *next_forked_copy;
 	volatile int32_t in_use;
 };
 
+#define MAX_SPECIALIZED_ARGUMENTS			8
+#define MAX_SPECIALIZATION_COUNT			4
+#define MAX_DIMENSION_PROFILE_COUNT			16
+
+struct qb_dimension_signature {
+	uint32_t dimension_counts[MAX_SPECIALIZED_ARGUMENTS];
+	uint32_t dimensions[MAX_SPECIALIZED_ARGUMENTS][MAX_DIMENSION];
+};
+
+struct qb_dimension_profile {
+	zend_op_array *op_array;
+	qb_dimension_signature signature;
+	uint32_t call_count;
+	int32_t queued;
+	int32_t specialized;
+	int32_t failed;
+	qb_dimension_profile *next;
+};
+
 struct qb_native_code_bundle {
 	void *memory;
 	uint32_t size;
+	void *compiler_state;
 };
 
 #define QB_GET_FUNCTION(op_array)		((op_array)->reserved[qb_resource_handle])
@@ -165,6 +165,67 @@ static int32_t qb_transfer_arguments_from_caller(qb_interpreter_context *cxt) {
 	return TRUE;
 }
 
+// arrays smaller than this are always converted back, as that costs little more than checking 
+// whether they've changed--and it gives PHP values of the declared type, as before
+#define QB_UNCHANGED_ARGUMENT_THRESHOLD		65536
+
+static uint64_t qb_calculate_segment_checksum(qb_storage *storage, qb_address *address) {
+	qb_memory_segment *segment = &storage->segments[address->segment_selector];
+	uint64_t crc64 = qb_calculate_crc64((uint8_t *) segment->memory, (size_t) segment->byte_count, segment->byte_count);
+	uint32_t i;
+
+	// include the dimensions, since the array could be reshaped without its contents changing
+	for(i = 0; i < address->dimension_count; i++) {
+		uint32_t dimension = VALUE_IN(storage, U32, address->dimension_addresses[i]);
+		crc64 = qb_calculate_crc64((uint8_t *) &dimension, sizeof(uint32_t), crc64);
+	}
+	return crc64;
+}
+
+static qb_memory_segment * qb_get_large_argument_segment(qb_interpreter_context *cxt, qb_variable *qvar) {
+	// borrowed, mapped and imported segments aren't converted back in the first place
+	if(qvar->address->segment_selector >= QB_SELECTOR_ARRAY_START) {
+		qb_memory_segment *segment = &cxt->function->local_storage->segments[qvar->address->segment_selector];
+		if(segment->byte_count >= QB_UNCHANGED_ARGUMENT_THRESHOLD && !(segment->flags & (QB_SEGMENT_BORROWED | QB_SEGMENT_MAPPED | QB_SEGMENT_IMPORTED))) {
+			return segment;
+		}
+	}
+	return NULL;
+}
+
+static void qb_record_argument_checksum(qb_interpreter_context *cxt, qb_variable *qvar) {
+	// large arrays are expensive to convert back--remember what they looked like
+	// so the conversion can be skipped if the function didn't actually change them
+	if(qvar->address->segment_selector >= QB_SELECTOR_ARRAY_START) {
+		qb_storage *storage = cxt->function->local_storage;
+		qb_memory_segment *segment = qb_get_large_argument_segment(cxt, qvar);
+		storage->segments[qvar->address->segment_selector].flags &= ~QB_SEGMENT_CHECKSUMMED;
+		if(segment && !IS_READ_ONLY(qvar->address)) {
+			segment->checksum = qb_calculate_segment_checksum(storage, qvar->address);
+			segment->flags |= QB_SEGMENT_CHECKSUMMED;
+		}
+	}
+}
+
+static int32_t qb_is_argument_modified(qb_interpreter_context *cxt, qb_variable *qvar, zval *zarg) {
+	if(qvar->address->segment_selector >= QB_SELECTOR_ARRAY_START) {
+		qb_storage *storage = cxt->function->local_storage;
+		qb_memory_segment *segment = qb_get_large_argument_segment(cxt, qvar);
+		int32_t checksummed = (storage->segments[qvar->address->segment_selector].flags & QB_SEGMENT_CHECKSUMMED);
+		storage->segments[qvar->address->segment_selector].flags &= ~QB_SEGMENT_CHECKSUMMED;
+		if(segment && Z_TYPE_P(zarg) != IS_NULL) {
+			if(IS_READ_ONLY(qvar->address)) {
+				// the compiler didn't find any writes
+				return FALSE;
+			}
+			if(checksummed && segment->checksum == qb_calculate_segment_checksum(storage, qvar->address)) {
+				return FALSE;
+			}
+		}
+	}
+	return TRUE;
+}
+
 static int32_t qb_transfer_arguments_from_php(qb_interpreter_context *cxt) {
 	USE_TSRM
 	int32_t result = TRUE;
@@ -195,6 +256,8 @@ static int32_t qb_transfer_arguments_from_php(qb_interpreter_context *cxt) {
 				qb_append_exception_variable_name(qvar TSRMLS_CC);
 				qb_set_exception_line_id(line_id TSRMLS_CC);
 				result = FALSE;
+			} else if(qvar->flags & QB_VARIABLE_BY_REF) {
+				qb_record_argument_checksum(cxt, qvar);
 			}
 			qvar->value = zarg;
 		} else {
@@ -289,7 +352,7 @@ static int32_t qb_transfer_arguments_to_php(qb_interpreter_context *cxt) {
 			if(i < received_argument_count) {
 				zval **p_zarg = (zval**) p - received_argument_count + i;
 				zval *zarg = *p_zarg;
-				if(!qb_transfer_value_to_zval(cxt->function->local_storage, qvar->address, zarg)) {
+				if(qb_is_argument_modified(cxt, qvar, zarg) && !qb_transfer_value_to_zval(cxt->function->local_storage, qvar->address, zarg)) {
 					uint32_t line_id = qb_get_zend_line_id(TSRMLS_C);
 					qb_append_exception_variable_name(qvar TSRMLS_CC);
 					qb_set_exception_line_id(line_id TSRMLS_CC);
@@ -479,7 +542,7 @@ static int32_t qb_transfer_arguments_to_caller(qb_interpreter_context *cxt) {
 			uint32_t argument_index = cxt->caller_context->argument_indices[i];
 			qb_variable *caller_qvar = cxt->caller_context->function->variables[argument_index];
 			qb_storage *caller_storage = cxt->caller_context->function->local_storage;
-			if(qvar->flags & QB_VARIABLE_BY_REF) {
+			if((qvar->flags & QB_VARIABLE_BY_REF) && !IS_READ_ONLY(qvar->address)) {
 				if(!qb_transfer_value_to_storage_location(cxt->function->local_storage, qvar->address, caller_storage, caller_qvar->address)) {
 					USE_TSRM
 					qb_append_exception_variable_name(qvar TSRMLS_CC);
@@ -515,21 +578,57 @@ static int32_t qb_transfer_variables_to_external_sources(qb_interpreter_context
 }
 
 static int32_t qb_lock_function(qb_function *f) {
+	// claim the copy only if no one else has--a failed attempt leaves the flag untouched
 #if defined(_WIN32)
-	if(InterlockedIncrement(&f->in_use) == 1) {
-		return TRUE;
-	}
+	return (InterlockedCompareExchange(&f->in_use, 1, 0) == 0);
 #elif defined(__GNUC__)
-	if(__sync_add_and_fetch(&f->in_use, 1) == 1) {
+	return __sync_bool_compare_and_swap(&f->in_use, 0, 1);
+#else
+	if(!f->in_use) {
+		f->in_use = 1;
 		return TRUE;
 	}
-#endif
-	f->in_use = 1;
 	return FALSE;
+#endif
 }
 
 static void qb_unlock_function(qb_function *f) {
+#if defined(_WIN32)
+	InterlockedExchange(&f->in_use, 0);
+#elif defined(__GNUC__)
+	__sync_lock_release(&f->in_use);
+#else
 	f->in_use = 0;
+#endif
+}
+
+#define MAX_POOLED_COPY_INCREMENT		8
+
+static qb_function * qb_create_pooled_copy(qb_function *base, int32_t reentrance) {
+	// relocate the copy now, so the thread that ends up using it doesn't have to
+	qb_function *f = qb_create_function_copy(base, reentrance);
+	qb_relocate_function(f, reentrance);
+	return f;
+}
+
+static void qb_reserve_function_copies(qb_function *base, uint32_t count, int32_t reentrance) {
+	qb_function *f, *last = base;
+	uint32_t existing_count = 0;
+	for(f = (reentrance) ? base->next_reentrance_copy : base->next_forked_copy; f; f = (reentrance) ? f->next_reentrance_copy : f->next_forked_copy) {
+		existing_count++;
+		last = f;
+	}
+	for(; existing_count < count; existing_count++) {
+		// the new copies start out free
+		f = qb_create_pooled_copy(base, reentrance);
+		f->in_use = 0;
+		if(reentrance) {
+			last->next_reentrance_copy = f;
+		} else {
+			last->next_forked_copy = f;
+		}
+		last = f;
+	}
 }
 
 static qb_function * qb_acquire_function(qb_function *base, int32_t reentrance);
@@ -542,12 +641,14 @@ static void qb_acquire_function_in_main_thread(void *param1, void *param2, int p
 
 static qb_function * qb_acquire_function(qb_function *base, int32_t reentrance) {
 	qb_function *f, *last;
+	uint32_t copy_count = 0;
 	if(reentrance) {
 		for(f = base; f; f = f->next_reentrance_copy) {
 			if(!f->in_use && qb_lock_function(f)) {
 				break;
 			}
 			last = f;
+			copy_count++;
 		}
 	} else {
 		for(f = base; f; f = f->next_forked_copy) {
@@ -555,6 +656,7 @@ static qb_function * qb_acquire_function(qb_function *base, int32_t reentrance)
 				break;
 			}
 			last = f;
+			copy_count++;
 		}
 	}
 
@@ -564,18 +666,25 @@ static qb_function * qb_acquire_function(qb_function *base, int32_t reentrance)
 			// do it in the main thread
 			qb_run_in_main_thread(qb_acquire_function_in_main_thread, base, &f, reentrance);
 		} else {
-			f = qb_create_function_copy(base, reentrance);
+			f = qb_create_pooled_copy(base, reentrance);
 			if(reentrance) {
 				last->next_reentrance_copy = f;
 			} else {
 				last->next_forked_copy = f;
 			}
+
+			// the number of copies in use has outgrown the pool--double it (within limit)
+			// so that deep recursions don't keep coming back here
+			if(copy_count > 1) {
+				uint32_t increment = (copy_count < MAX_POOLED_COPY_INCREMENT) ? copy_count : MAX_POOLED_COPY_INCREMENT;
+				qb_reserve_function_copies(base, copy_count + increment, reentrance);
+			}
 		}
 	}
 	return f;
 }
 
-void qb_initialize_interpreter_context(qb_interpreter_context *cxt, qb_function *qfunc, qb_interpreter_context *caller_cxt TSRMLS_DC) {
+static void qb_initialize_callee_context(qb_interpreter_context *cxt, qb_function *callee, qb_interpreter_context *caller_cxt TSRMLS_DC) {
 	if(caller_cxt) {
 		cxt->call_depth = caller_cxt->call_depth + 1;
 		cxt->caller_context = caller_cxt;
@@ -583,8 +692,10 @@ void qb_initialize_interpreter_context(qb_interpreter_context *cxt, qb_function
 		cxt->call_depth = 1;
 		cxt->caller_context = NULL;
 	}
-	cxt->function = qb_acquire_function(qfunc, TRUE);
+	cxt->function = callee;
 	cxt->instruction_pointer = cxt->function->instruction_start;
+	memset(cxt->callee_cache, 0, sizeof(cxt->callee_cache));
+	cxt->callee_cache_index = 0;
 
 	cxt->thread_count = QB_G(thread_count);
 	if(cxt->thread_count == 1) {
@@ -606,10 +717,20 @@ void qb_initialize_interpreter_context(qb_interpreter_context *cxt, qb_function
 	SAVE_TSRMLS
 }
 
+void qb_initialize_interpreter_context(qb_interpreter_context *cxt, qb_function *qfunc, qb_interpreter_context *caller_cxt TSRMLS_DC) {
+	qb_initialize_callee_context(cxt, qb_acquire_function(qfunc, TRUE), caller_cxt TSRMLS_CC);
+}
+
 void qb_free_interpreter_context(qb_interpreter_context *cxt) {
+	uint32_t i;
 	if(cxt->function) {
 		qb_unlock_function(cxt->function);
 	}
+	for(i = 0; i < CALLEE_CACHE_SIZE; i++) {
+		if(cxt->callee_cache[i].copy) {
+			qb_unlock_function(cxt->callee_cache[i].copy);
+		}
+	}
 	if(cxt->send_target) {
 		// this should not happen inside a worker thread
 #if PHP_MINOR_RELEASE > 5 && PHP_RELEASE_VERSION > 7
@@ -660,6 +781,11 @@ static void qb_fork_execution(qb_interpreter_context *cxt) {
 	}
 	new_context_count = fork_count - reusing_original_cxt;
 
+	if(function_count > 1 && qb_in_main_thread()) {
+		// create all the copies needed at once, before any worker asks for one
+		qb_reserve_function_copies(function, function_count - reusing_original_cxt, FALSE);
+	}
+
 	// the number of threads that the each fork can use
 	remaining_thread_count = (cxt->thread_count > cxt->fork_count) ? (cxt->thread_count - fork_count) / fork_count : 0;
 	if(remaining_thread_count == 1) {
@@ -687,6 +813,8 @@ static void qb_fork_execution(qb_interpreter_context *cxt) {
 				fork_cxt->instruction_pointer = (int8_t *) (instr_offset);
 			}
 			fork_cxt->caller_context = NULL;
+			memset(fork_cxt->callee_cache, 0, sizeof(fork_cxt->callee_cache));
+			fork_cxt->callee_cache_index = 0;
 			fork_cxt->thread_count = remaining_thread_count;
 			fork_cxt->fork_id = fork_id;
 			fork_cxt->fork_count = fork_count;
@@ -899,12 +1027,156 @@ static void qb_finalize_variables(qb_interpreter_context *cxt) {
 	qb_release_imported_segments(cxt);
 }
 
+#ifdef NATIVE_COMPILE_ENABLED
+static qb_function * qb_get_native_compilation_candidate(qb_interpreter_context *cxt) {
+	USE_TSRM
+	if(QB_G(native_compilation_threshold) > 0 && QB_G(allow_native_compilation) && !cxt->function->native_proc) {
+		// count against the function attached to the op array, since cxt->function could be a copy
+		// or a specialized version (those are rebuilt when the generic version goes native)
+		qb_function *base = QB_GET_FUNCTION(cxt->function->zend_op_array);
+		if(base && !(base->flags & (QB_FUNCTION_NATIVE_IF_POSSIBLE | QB_FUNCTION_NEVER_NATIVE | QB_FUNCTION_NATIVE_QUEUED | QB_FUNCTION_CLOSURE | QB_FUNCTION_STATIC_VARIABLES))) {
+			if(qb_in_main_thread()) {
+				return base;
+			}
+		}
+	}
+	return NULL;
+}
+
+static void qb_update_function_hotness(qb_interpreter_context *cxt, qb_function *base, double start_time) {
+	USE_TSRM
+	uint32_t hotness;
+	base->call_count++;
+	base->interpretation_time += qb_get_high_res_timestamp() - start_time;
+
+	// a call that runs for a long time counts as many (one per millisecond)
+	// so that functions with heavy loops are picked up even if they're called only a few times
+	hotness = base->call_count + (uint32_t) (base->interpretation_time * 1000);
+	if(hotness >= (uint32_t) QB_G(native_compilation_threshold)) {
+		qb_queue_hot_function(base TSRMLS_CC);
+	}
+}
+#endif
+
+static int32_t qb_get_argument_dimension_signature(qb_function *qfunc, qb_dimension_signature *signature TSRMLS_DC) {
+#if !ZEND_ENGINE_2_2 && !ZEND_ENGINE_2_1
+	void **p = EG(current_execute_data)->prev_execute_data->function_state.arguments;
+#else
+	void **p = EG(argument_stack).top_element-1-1;
+#endif
+	uint32_t received_argument_count = (uint32_t) (uintptr_t) *p;
+	int32_t specializable = FALSE;
+	uint32_t i, j;
+
+	memset(signature, 0, sizeof(qb_dimension_signature));
+	for(i = 0; i < qfunc->argument_count && i < received_argument_count && i < MAX_SPECIALIZED_ARGUMENTS; i++) {
+		qb_variable *qvar = qfunc->variables[i];
+		qb_address *address = qvar->address;
+
+		// only arguments that are copied in and never changed can be given a fixed size
+		if(!(qvar->flags & QB_VARIABLE_BY_REF) && IS_READ_ONLY(address) && address->dimension_count > 0) {
+			for(j = 0; j < address->dimension_count; j++) {
+				if(!IS_IMMUTABLE(address->dimension_addresses[j])) {
+					break;
+				}
+			}
+			if(j < address->dimension_count) {
+				zval **p_zarg = (zval**) p - received_argument_count + i;
+				if(qb_get_zval_dimensions(qfunc->local_storage, address, *p_zarg, signature->dimensions[i])) {
+					signature->dimension_counts[i] = address->dimension_count;
+					specializable = TRUE;
+				} else {
+					memset(signature->dimensions[i], 0, sizeof(signature->dimensions[i]));
+				}
+			}
+		}
+	}
+	return specializable;
+}
+
+static void qb_update_dimension_profile(qb_function *qfunc, qb_dimension_signature *signature TSRMLS_DC) {
+	qb_dimension_profile *profile = NULL, *p;
+	uint32_t profile_count = 0, specialization_count = 0;
+
+	for(p = qfunc->dimension_profiles; p; p = p->next) {
+		if(memcmp(&p->signature, signature, sizeof(qb_dimension_signature)) == 0) {
+			profile = p;
+		}
+		if(p->queued || p->specialized) {
+			specialization_count++;
+		}
+		profile_count++;
+	}
+	if(!profile) {
+		qb_dimension_profile **p_profile;
+		if(profile_count >= MAX_DIMENSION_PROFILE_COUNT) {
+			// the function is called with too many different shapes to be worth specializing
+			qfunc->flags |= QB_FUNCTION_NOT_SPECIALIZABLE;
+			return;
+		}
+		if(!QB_G(dimension_profiles)) {
+			qb_create_array((void **) &QB_G(dimension_profiles), &QB_G(dimension_profile_count), sizeof(qb_dimension_profile *), 4);
+		}
+		profile = emalloc(sizeof(qb_dimension_profile));
+		profile->op_array = qfunc->zend_op_array;
+		profile->signature = *signature;
+		profile->call_count = 0;
+		profile->queued = FALSE;
+		profile->specialized = FALSE;
+		profile->failed = FALSE;
+		profile->next = qfunc->dimension_profiles;
+		qfunc->dimension_profiles = profile;
+		p_profile = qb_enlarge_array((void **) &QB_G(dimension_profiles), 1);
+		*p_profile = profile;
+	}
+	if(!profile->queued && !profile->specialized) {
+		profile->call_count++;
+		if(profile->call_count >= (uint32_t) QB_G(specialization_threshold) && specialization_count < MAX_SPECIALIZATION_COUNT) {
+			profile->queued = TRUE;
+			QB_G(pending_specialization_count)++;
+		}
+	}
+}
+
+qb_function * qb_select_specialized_function(qb_function *qfunc TSRMLS_DC) {
+	qb_dimension_signature _signature, *signature = &_signature;
+	qb_function *specialization;
+
+	if(qfunc->flags & (QB_FUNCTION_CLOSURE | QB_FUNCTION_STATIC_VARIABLES | QB_FUNCTION_NOT_SPECIALIZABLE)) {
+		// a specialized copy would have static variables of its own, or specializing has been given up on
+		return qfunc;
+	}
+	if(!qb_get_argument_dimension_signature(qfunc, signature TSRMLS_CC)) {
+		return qfunc;
+	}
+
+	// guard: use a specialized version only when every argument has exactly the dimensions it was built for
+	for(specialization = qfunc->next_specialization; specialization; specialization = specialization->next_specialization) {
+		if(memcmp(specialization->dimension_signature, signature, sizeof(qb_dimension_signature)) == 0) {
+			return specialization;
+		}
+	}
+
+	// keep running the generic version, noting the dimensions seen
+	qb_update_dimension_profile(qfunc, signature TSRMLS_CC);
+	return qfunc;
+}
+
 void qb_execute(qb_interpreter_context *cxt) {
 	// clear local memory segments
 	if(qb_initialize_local_variables(cxt)) {
 		// copy values from arguments, class variables, object variables, and global variables
 		if(qb_transfer_variables_from_external_sources(cxt)) {
 			// enter the vm
+#ifdef NATIVE_COMPILE_ENABLED
+			qb_function *candidate = qb_get_native_compilation_candidate(cxt);
+			if(candidate) {
+				// keep track of how much the function is used when it's running as bytecode
+				double start_time = qb_get_high_res_timestamp();
+				qb_execute_in_current_thread(cxt);
+				qb_update_function_hotness(cxt, candidate, start_time);
+			} else
+#endif
 			qb_execute_in_current_thread(cxt);
 			if(cxt->exit_type == QB_VM_RETURN) {
 				// move values back into caller space
@@ -1118,10 +1390,49 @@ static int32_t qb_execute_zend_function_call(qb_interpreter_context *cxt, zend_f
 	return TRUE;
 }
 
+static qb_function * qb_acquire_callee_function(qb_interpreter_context *cxt, qb_function *qfunc) {
+	uint32_t i;
+	for(i = 0; i < CALLEE_CACHE_SIZE; i++) {
+		qb_callee_cache_entry *entry = &cxt->callee_cache[i];
+		if(entry->base == qfunc && entry->copy) {
+			// the copy is still locked from the last call, so there's no need to look for one
+			// pick up native code that has become available since then, as no one else can be using it
+			qb_function *callee = entry->copy;
+			callee->native_proc = qfunc->native_proc;
+			entry->copy = NULL;
+			return callee;
+		}
+	}
+	return qb_acquire_function(qfunc, TRUE);
+}
+
+static void qb_release_callee_function(qb_interpreter_context *cxt, qb_function *qfunc, qb_function *callee) {
+	qb_callee_cache_entry *entry = NULL;
+	uint32_t i;
+	for(i = 0; i < CALLEE_CACHE_SIZE; i++) {
+		if(cxt->callee_cache[i].base == qfunc && !cxt->callee_cache[i].copy) {
+			// put it back in the slot it came from
+			entry = &cxt->callee_cache[i];
+			break;
+		}
+	}
+	if(!entry) {
+		// take the next slot, unlocking the copy held there
+		entry = &cxt->callee_cache[cxt->callee_cache_index];
+		cxt->callee_cache_index = (cxt->callee_cache_index + 1) % CALLEE_CACHE_SIZE;
+		if(entry->copy) {
+			qb_unlock_function(entry->copy);
+		}
+	}
+	entry->base = qfunc;
+	entry->copy = callee;
+}
+
 static int32_t qb_execute_function_call(qb_interpreter_context *cxt, qb_function *qfunc, uint32_t *variable_indices, uint32_t argument_count, uint32_t result_index, uint32_t line_id) {
 	if(cxt->call_depth < 1024) {
 		USE_TSRM
 		qb_interpreter_context _new_cxt, *new_cxt = &_new_cxt;
+		qb_function *callee;
 
 		cxt->argument_indices = variable_indices;
 		cxt->argument_count = argument_count;
@@ -1129,8 +1440,13 @@ static int32_t qb_execute_function_call(qb_interpreter_context *cxt, qb_function
 		cxt->line_id = line_id;
 		cxt->exception_encountered = FALSE;
 
-		qb_initialize_interpreter_context(new_cxt, qfunc, cxt TSRMLS_CC);
+		callee = qb_acquire_callee_function(cxt, qfunc);
+		qb_initialize_callee_context(new_cxt, callee, cxt TSRMLS_CC);
 		qb_execute(new_cxt);
+
+		// hang onto the copy in case the function is called again (in a loop, most likely)
+		new_cxt->function = NULL;
+		qb_release_callee_function(cxt, qfunc, callee);
 		qb_free_interpreter_context(new_cxt);
 		return (new_cxt->exit_type == QB_VM_RETURN);
 	} else {
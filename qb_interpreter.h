@@ -26,6 +26,7 @@ typedef struct qb_interpreter_context	qb_interpreter_context;
 typedef struct qb_native_symbol			qb_native_symbol;
 typedef struct qb_native_proc_record	qb_native_proc_record;
 typedef struct qb_zend_argument_stack	qb_zend_argument_stack;
+typedef struct qb_callee_cache_entry	qb_callee_cache_entry;
 
 typedef enum qb_import_scope_type		qb_import_scope_type;
 typedef enum qb_vm_exit_type			qb_vm_exit_type;
@@ -43,6 +44,13 @@ enum {
 	QB_DEBUG_SEND_EXACT_TYPE = 0x00000001,
 };
 
+#define CALLEE_CACHE_SIZE		4
+
+struct qb_callee_cache_entry {
+	qb_function *base;
+	qb_function *copy;
+};
+
 struct qb_import_scope {
 	qb_import_scope_type type;
 	qb_import_scope *parent;
@@ -79,6 +87,8 @@ struct qb_interpreter_context {
 	qb_function *function;
 	int8_t *instruction_pointer;
 	qb_interpreter_context *caller_context;
+	qb_callee_cache_entry callee_cache[CALLEE_CACHE_SIZE];
+	uint32_t callee_cache_index;
 
 	uint32_t thread_count;
 
@@ -130,6 +140,7 @@ void qb_sync_imported_variable(qb_interpreter_context *cxt, qb_variable *qvar);
 int32_t qb_dispatch_function_call(qb_interpreter_context *cxt, uint32_t symbol_index, uint32_t *variable_indices, uint32_t argument_count, uint32_t result_index, uint32_t line_number);
 
 void qb_initialize_interpreter_context(qb_interpreter_context *cxt, qb_function *qfunc, qb_interpreter_context *caller_cxt TSRMLS_DC);
+qb_function * qb_select_specialized_function(qb_function *qfunc TSRMLS_DC);
 void qb_free_interpreter_context(qb_interpreter_context *cxt);
 
 void qb_main(qb_interpreter_context *__restrict cxt);
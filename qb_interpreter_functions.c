@@ -2541,7 +2541,7 @@ void qb_do_accommodate_size_copy_dimension_4_U32(qb_interpreter_context *__restr
 	(*op12_ptr) = op10;
 	(*op15_ptr) = op13;
 	(*op16_ptr) = op14;
-	qb_resize_segment(&cxt->function->local_storage->segments[op17], op1 * op18);
+	qb_resize_segment(&cxt->function->local_storage->segments[op17], (uint64_t) op1 * op18);
 }
 
 void qb_do_accommodate_size_copy_dimension_5_U32(qb_interpreter_context *__restrict cxt, uint32_t op1, uint32_t op2, uint32_t *op3_ptr, uint32_t *op4_ptr, uint32_t op5, uint32_t op6, uint32_t *op7_ptr, uint32_t *op8_ptr, uint32_t op9, uint32_t op10, uint32_t *op11_ptr, uint32_t *op12_ptr, uint32_t op13, uint32_t op14, uint32_t *op15_ptr, uint32_t *op16_ptr, uint32_t op17, uint32_t op18, uint32_t *op19_ptr, uint32_t *op20_ptr, uint32_t op21, uint32_t op22) {
@@ -2555,7 +2555,7 @@ void qb_do_accommodate_size_copy_dimension_5_U32(qb_interpreter_context *__restr
 	(*op16_ptr) = op14;
 	(*op19_ptr) = op17;
 	(*op20_ptr) = op18;
-	qb_resize_segment(&cxt->function->local_storage->segments[op21], op1 * op22);
+	qb_resize_segment(&cxt->function->local_storage->segments[op21], (uint64_t) op1 * op22);
 }
 
 void qb_do_accommodate_size_copy_dimension_6_U32(qb_interpreter_context *__restrict cxt, uint32_t op1, uint32_t op2, uint32_t *op3_ptr, uint32_t *op4_ptr, uint32_t op5, uint32_t op6, uint32_t *op7_ptr, uint32_t *op8_ptr, uint32_t op9, uint32_t op10, uint32_t *op11_ptr, uint32_t *op12_ptr, uint32_t op13, uint32_t op14, uint32_t *op15_ptr, uint32_t *op16_ptr, uint32_t op17, uint32_t op18, uint32_t *op19_ptr, uint32_t *op20_ptr, uint32_t op21, uint32_t op22, uint32_t *op23_ptr, uint32_t *op24_ptr, uint32_t op25, uint32_t op26) {
@@ -2571,7 +2571,7 @@ void qb_do_accommodate_size_copy_dimension_6_U32(qb_interpreter_context *__restr
 	(*op20_ptr) = op18;
 	(*op23_ptr) = op21;
 	(*op24_ptr) = op22;
-	qb_resize_segment(&cxt->function->local_storage->segments[op25], op1 * op26);
+	qb_resize_segment(&cxt->function->local_storage->segments[op25], (uint64_t) op1 * op26);
 }
 
 void qb_do_accommodate_size_copy_dimension_7_U32(qb_interpreter_context *__restrict cxt, uint32_t op1, uint32_t op2, uint32_t *op3_ptr, uint32_t *op4_ptr, uint32_t op5, uint32_t op6, uint32_t *op7_ptr, uint32_t *op8_ptr, uint32_t op9, uint32_t op10, uint32_t *op11_ptr, uint32_t *op12_ptr, uint32_t op13, uint32_t op14, uint32_t *op15_ptr, uint32_t *op16_ptr, uint32_t op17, uint32_t op18, uint32_t *op19_ptr, uint32_t *op20_ptr, uint32_t op21, uint32_t op22, uint32_t *op23_ptr, uint32_t *op24_ptr, uint32_t op25, uint32_t op26, uint32_t *op27_ptr, uint32_t *op28_ptr, uint32_t op29, uint32_t op30) {
@@ -2589,7 +2589,7 @@ void qb_do_accommodate_size_copy_dimension_7_U32(qb_interpreter_context *__restr
 	(*op24_ptr) = op22;
 	(*op27_ptr) = op25;
 	(*op28_ptr) = op26;
-	qb_resize_segment(&cxt->function->local_storage->segments[op29], op1 * op30);
+	qb_resize_segment(&cxt->function->local_storage->segments[op29], (uint64_t) op1 * op30);
 }
 
 void qb_do_accommodate_size_copy_dimension_8_U32(qb_interpreter_context *__restrict cxt, uint32_t op1, uint32_t op2, uint32_t *op3_ptr, uint32_t *op4_ptr, uint32_t op5, uint32_t op6, uint32_t *op7_ptr, uint32_t *op8_ptr, uint32_t op9, uint32_t op10, uint32_t *op11_ptr, uint32_t *op12_ptr, uint32_t op13, uint32_t op14, uint32_t *op15_ptr, uint32_t *op16_ptr, uint32_t op17, uint32_t op18, uint32_t *op19_ptr, uint32_t *op20_ptr, uint32_t op21, uint32_t op22, uint32_t *op23_ptr, uint32_t *op24_ptr, uint32_t op25, uint32_t op26, uint32_t *op27_ptr, uint32_t *op28_ptr, uint32_t op29, uint32_t op30, uint32_t *op31_ptr, uint32_t *op32_ptr, uint32_t op33, uint32_t op34) {
@@ -2609,7 +2609,7 @@ void qb_do_accommodate_size_copy_dimension_8_U32(qb_interpreter_context *__restr
 	(*op28_ptr) = op26;
 	(*op31_ptr) = op29;
 	(*op32_ptr) = op30;
-	qb_resize_segment(&cxt->function->local_storage->segments[op33], op1 * op34);
+	qb_resize_segment(&cxt->function->local_storage->segments[op33], (uint64_t) op1 * op34);
 }
 
 void qb_do_accommodate_size_update_dimension_U32(qb_interpreter_context *__restrict cxt, uint32_t op1, uint32_t *op2_ptr, uint32_t *op3_ptr, uint32_t op4, uint32_t op5, uint32_t op6) {
@@ -2622,7 +2622,7 @@ void qb_do_accommodate_size_update_dimension_U32(qb_interpreter_context *__restr
 		}
 		(*op2_ptr) = new_size;
 		(*op3_ptr) = new_dim;
-		qb_resize_segment(&cxt->function->local_storage->segments[op5], new_size * op6);
+		qb_resize_segment(&cxt->function->local_storage->segments[op5], (uint64_t) new_size * op6);
 	}
 }
 
@@ -24251,7 +24251,33 @@ void qb_do_sample_convolution_2x_F32(float32_t *op1_ptr, uint32_t op2, uint32_t
 	float32_t sum[2] = {
 		0.0f, 0.0f
 	};
-	if(fx + fy == 0) {
+	if(ix0 >= 0 && iy0 >= 0 && (uint32_t) ix0 + op8 < op2 && (uint32_t) iy0 + op7 < op3) {
+		// every sample point (and its neighbors to the right and below) is inside the image
+		uint32_t stride = op2 * 2;
+		float32_t *row_ptr = op1_ptr + ((iy0 * op2) + ix0) * 2;
+		float32_t *pixel_ptr;
+		if(fx + fy == 0) {
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 2) {
+					float32_t coefficient = *op6_ptr++;
+					sum[0] += pixel_ptr[0] * coefficient;
+					sum[1] += pixel_ptr[1] * coefficient;
+				}
+			}
+		} else {
+			float32_t fx1 = 1.0f - fx;
+			float32_t fy1 = 1.0f - fy;
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 2) {
+					float32_t coefficient = *op6_ptr++;
+					float32_t wt = fy1 * coefficient;
+					float32_t wb = fy * coefficient;
+					sum[0] += (pixel_ptr[0] * fx1 + pixel_ptr[2] * fx) * wt + (pixel_ptr[stride + 0] * fx1 + pixel_ptr[stride + 2] * fx) * wb;
+					sum[1] += (pixel_ptr[1] * fx1 + pixel_ptr[3] * fx) * wt + (pixel_ptr[stride + 1] * fx1 + pixel_ptr[stride + 3] * fx) * wb;
+				}
+			}
+		}
+	} else if(fx + fy == 0) {
 		for(r = 0, iy = iy0; r < op7; r++, iy++) {
 			for(c = 0, ix = ix0; c < op8; c++, ix++) {
 				float32_t coefficient = *op6_ptr++;
@@ -24334,7 +24360,33 @@ void qb_do_sample_convolution_2x_F64(float64_t *op1_ptr, uint32_t op2, uint32_t
 	float64_t sum[2] = {
 		0.0, 0.0
 	};
-	if(fx + fy == 0) {
+	if(ix0 >= 0 && iy0 >= 0 && (uint32_t) ix0 + op8 < op2 && (uint32_t) iy0 + op7 < op3) {
+		// every sample point (and its neighbors to the right and below) is inside the image
+		uint32_t stride = op2 * 2;
+		float64_t *row_ptr = op1_ptr + ((iy0 * op2) + ix0) * 2;
+		float64_t *pixel_ptr;
+		if(fx + fy == 0) {
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 2) {
+					float64_t coefficient = *op6_ptr++;
+					sum[0] += pixel_ptr[0] * coefficient;
+					sum[1] += pixel_ptr[1] * coefficient;
+				}
+			}
+		} else {
+			float64_t fx1 = 1.0 - fx;
+			float64_t fy1 = 1.0 - fy;
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 2) {
+					float64_t coefficient = *op6_ptr++;
+					float64_t wt = fy1 * coefficient;
+					float64_t wb = fy * coefficient;
+					sum[0] += (pixel_ptr[0] * fx1 + pixel_ptr[2] * fx) * wt + (pixel_ptr[stride + 0] * fx1 + pixel_ptr[stride + 2] * fx) * wb;
+					sum[1] += (pixel_ptr[1] * fx1 + pixel_ptr[3] * fx) * wt + (pixel_ptr[stride + 1] * fx1 + pixel_ptr[stride + 3] * fx) * wb;
+				}
+			}
+		}
+	} else if(fx + fy == 0) {
 		for(r = 0, iy = iy0; r < op7; r++, iy++) {
 			for(c = 0, ix = ix0; c < op8; c++, ix++) {
 				float64_t coefficient = *op6_ptr++;
@@ -24485,7 +24537,35 @@ void qb_do_sample_convolution_3x_F32(float32_t *op1_ptr, uint32_t op2, uint32_t
 	float32_t sum[3] = {
 		0.0f, 0.0f, 0.0f
 	};
-	if(fx + fy == 0) {
+	if(ix0 >= 0 && iy0 >= 0 && (uint32_t) ix0 + op8 < op2 && (uint32_t) iy0 + op7 < op3) {
+		// every sample point (and its neighbors to the right and below) is inside the image
+		uint32_t stride = op2 * 3;
+		float32_t *row_ptr = op1_ptr + ((iy0 * op2) + ix0) * 3;
+		float32_t *pixel_ptr;
+		if(fx + fy == 0) {
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 3) {
+					float32_t coefficient = *op6_ptr++;
+					sum[0] += pixel_ptr[0] * coefficient;
+					sum[1] += pixel_ptr[1] * coefficient;
+					sum[2] += pixel_ptr[2] * coefficient;
+				}
+			}
+		} else {
+			float32_t fx1 = 1.0f - fx;
+			float32_t fy1 = 1.0f - fy;
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 3) {
+					float32_t coefficient = *op6_ptr++;
+					float32_t wt = fy1 * coefficient;
+					float32_t wb = fy * coefficient;
+					sum[0] += (pixel_ptr[0] * fx1 + pixel_ptr[3] * fx) * wt + (pixel_ptr[stride + 0] * fx1 + pixel_ptr[stride + 3] * fx) * wb;
+					sum[1] += (pixel_ptr[1] * fx1 + pixel_ptr[4] * fx) * wt + (pixel_ptr[stride + 1] * fx1 + pixel_ptr[stride + 4] * fx) * wb;
+					sum[2] += (pixel_ptr[2] * fx1 + pixel_ptr[5] * fx) * wt + (pixel_ptr[stride + 2] * fx1 + pixel_ptr[stride + 5] * fx) * wb;
+				}
+			}
+		}
+	} else if(fx + fy == 0) {
 		for(r = 0, iy = iy0; r < op7; r++, iy++) {
 			for(c = 0, ix = ix0; c < op8; c++, ix++) {
 				float32_t coefficient = *op6_ptr++;
@@ -24581,7 +24661,35 @@ void qb_do_sample_convolution_3x_F64(float64_t *op1_ptr, uint32_t op2, uint32_t
 	float64_t sum[3] = {
 		0.0, 0.0, 0.0
 	};
-	if(fx + fy == 0) {
+	if(ix0 >= 0 && iy0 >= 0 && (uint32_t) ix0 + op8 < op2 && (uint32_t) iy0 + op7 < op3) {
+		// every sample point (and its neighbors to the right and below) is inside the image
+		uint32_t stride = op2 * 3;
+		float64_t *row_ptr = op1_ptr + ((iy0 * op2) + ix0) * 3;
+		float64_t *pixel_ptr;
+		if(fx + fy == 0) {
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 3) {
+					float64_t coefficient = *op6_ptr++;
+					sum[0] += pixel_ptr[0] * coefficient;
+					sum[1] += pixel_ptr[1] * coefficient;
+					sum[2] += pixel_ptr[2] * coefficient;
+				}
+			}
+		} else {
+			float64_t fx1 = 1.0 - fx;
+			float64_t fy1 = 1.0 - fy;
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 3) {
+					float64_t coefficient = *op6_ptr++;
+					float64_t wt = fy1 * coefficient;
+					float64_t wb = fy * coefficient;
+					sum[0] += (pixel_ptr[0] * fx1 + pixel_ptr[3] * fx) * wt + (pixel_ptr[stride + 0] * fx1 + pixel_ptr[stride + 3] * fx) * wb;
+					sum[1] += (pixel_ptr[1] * fx1 + pixel_ptr[4] * fx) * wt + (pixel_ptr[stride + 1] * fx1 + pixel_ptr[stride + 4] * fx) * wb;
+					sum[2] += (pixel_ptr[2] * fx1 + pixel_ptr[5] * fx) * wt + (pixel_ptr[stride + 2] * fx1 + pixel_ptr[stride + 5] * fx) * wb;
+				}
+			}
+		}
+	} else if(fx + fy == 0) {
 		for(r = 0, iy = iy0; r < op7; r++, iy++) {
 			for(c = 0, ix = ix0; c < op8; c++, ix++) {
 				float64_t coefficient = *op6_ptr++;
@@ -24745,7 +24853,37 @@ void qb_do_sample_convolution_4x_F32(float32_t *op1_ptr, uint32_t op2, uint32_t
 	float32_t sum[4] = {
 		0.0f, 0.0f, 0.0f, 0.0f
 	};
-	if(fx + fy == 0) {
+	if(ix0 >= 0 && iy0 >= 0 && (uint32_t) ix0 + op8 < op2 && (uint32_t) iy0 + op7 < op3) {
+		// every sample point (and its neighbors to the right and below) is inside the image
+		uint32_t stride = op2 * 4;
+		float32_t *row_ptr = op1_ptr + ((iy0 * op2) + ix0) * 4;
+		float32_t *pixel_ptr;
+		if(fx + fy == 0) {
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 4) {
+					float32_t coefficient = *op6_ptr++;
+					sum[0] += pixel_ptr[0] * coefficient;
+					sum[1] += pixel_ptr[1] * coefficient;
+					sum[2] += pixel_ptr[2] * coefficient;
+					sum[3] += pixel_ptr[3] * coefficient;
+				}
+			}
+		} else {
+			float32_t fx1 = 1.0f - fx;
+			float32_t fy1 = 1.0f - fy;
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 4) {
+					float32_t coefficient = *op6_ptr++;
+					float32_t wt = fy1 * coefficient;
+					float32_t wb = fy * coefficient;
+					sum[0] += (pixel_ptr[0] * fx1 + pixel_ptr[4] * fx) * wt + (pixel_ptr[stride + 0] * fx1 + pixel_ptr[stride + 4] * fx) * wb;
+					sum[1] += (pixel_ptr[1] * fx1 + pixel_ptr[5] * fx) * wt + (pixel_ptr[stride + 1] * fx1 + pixel_ptr[stride + 5] * fx) * wb;
+					sum[2] += (pixel_ptr[2] * fx1 + pixel_ptr[6] * fx) * wt + (pixel_ptr[stride + 2] * fx1 + pixel_ptr[stride + 6] * fx) * wb;
+					sum[3] += (pixel_ptr[3] * fx1 + pixel_ptr[7] * fx) * wt + (pixel_ptr[stride + 3] * fx1 + pixel_ptr[stride + 7] * fx) * wb;
+				}
+			}
+		}
+	} else if(fx + fy == 0) {
 		for(r = 0, iy = iy0; r < op7; r++, iy++) {
 			for(c = 0, ix = ix0; c < op8; c++, ix++) {
 				float32_t coefficient = *op6_ptr++;
@@ -24854,7 +24992,37 @@ void qb_do_sample_convolution_4x_F64(float64_t *op1_ptr, uint32_t op2, uint32_t
 	float64_t sum[4] = {
 		0.0, 0.0, 0.0, 0.0
 	};
-	if(fx + fy == 0) {
+	if(ix0 >= 0 && iy0 >= 0 && (uint32_t) ix0 + op8 < op2 && (uint32_t) iy0 + op7 < op3) {
+		// every sample point (and its neighbors to the right and below) is inside the image
+		uint32_t stride = op2 * 4;
+		float64_t *row_ptr = op1_ptr + ((iy0 * op2) + ix0) * 4;
+		float64_t *pixel_ptr;
+		if(fx + fy == 0) {
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 4) {
+					float64_t coefficient = *op6_ptr++;
+					sum[0] += pixel_ptr[0] * coefficient;
+					sum[1] += pixel_ptr[1] * coefficient;
+					sum[2] += pixel_ptr[2] * coefficient;
+					sum[3] += pixel_ptr[3] * coefficient;
+				}
+			}
+		} else {
+			float64_t fx1 = 1.0 - fx;
+			float64_t fy1 = 1.0 - fy;
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 4) {
+					float64_t coefficient = *op6_ptr++;
+					float64_t wt = fy1 * coefficient;
+					float64_t wb = fy * coefficient;
+					sum[0] += (pixel_ptr[0] * fx1 + pixel_ptr[4] * fx) * wt + (pixel_ptr[stride + 0] * fx1 + pixel_ptr[stride + 4] * fx) * wb;
+					sum[1] += (pixel_ptr[1] * fx1 + pixel_ptr[5] * fx) * wt + (pixel_ptr[stride + 1] * fx1 + pixel_ptr[stride + 5] * fx) * wb;
+					sum[2] += (pixel_ptr[2] * fx1 + pixel_ptr[6] * fx) * wt + (pixel_ptr[stride + 2] * fx1 + pixel_ptr[stride + 6] * fx) * wb;
+					sum[3] += (pixel_ptr[3] * fx1 + pixel_ptr[7] * fx) * wt + (pixel_ptr[stride + 3] * fx1 + pixel_ptr[stride + 7] * fx) * wb;
+				}
+			}
+		}
+	} else if(fx + fy == 0) {
 		for(r = 0, iy = iy0; r < op7; r++, iy++) {
 			for(c = 0, ix = ix0; c < op8; c++, ix++) {
 				float64_t coefficient = *op6_ptr++;
@@ -25031,7 +25199,31 @@ void qb_do_sample_convolution_F32(float32_t *op1_ptr, uint32_t op2, uint32_t op3
 	float32_t sum[1] = {
 		0.0f
 	};
-	if(fx + fy == 0) {
+	if(ix0 >= 0 && iy0 >= 0 && (uint32_t) ix0 + op8 < op2 && (uint32_t) iy0 + op7 < op3) {
+		// every sample point (and its neighbors to the right and below) is inside the image
+		uint32_t stride = op2 * 1;
+		float32_t *row_ptr = op1_ptr + ((iy0 * op2) + ix0) * 1;
+		float32_t *pixel_ptr;
+		if(fx + fy == 0) {
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 1) {
+					float32_t coefficient = *op6_ptr++;
+					sum[0] += pixel_ptr[0] * coefficient;
+				}
+			}
+		} else {
+			float32_t fx1 = 1.0f - fx;
+			float32_t fy1 = 1.0f - fy;
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 1) {
+					float32_t coefficient = *op6_ptr++;
+					float32_t wt = fy1 * coefficient;
+					float32_t wb = fy * coefficient;
+					sum[0] += (pixel_ptr[0] * fx1 + pixel_ptr[1] * fx) * wt + (pixel_ptr[stride + 0] * fx1 + pixel_ptr[stride + 1] * fx) * wb;
+				}
+			}
+		}
+	} else if(fx + fy == 0) {
 		for(r = 0, iy = iy0; r < op7; r++, iy++) {
 			for(c = 0, ix = ix0; c < op8; c++, ix++) {
 				float32_t coefficient = *op6_ptr++;
@@ -25101,7 +25293,31 @@ void qb_do_sample_convolution_F64(float64_t *op1_ptr, uint32_t op2, uint32_t op3
 	float64_t sum[1] = {
 		0.0
 	};
-	if(fx + fy == 0) {
+	if(ix0 >= 0 && iy0 >= 0 && (uint32_t) ix0 + op8 < op2 && (uint32_t) iy0 + op7 < op3) {
+		// every sample point (and its neighbors to the right and below) is inside the image
+		uint32_t stride = op2 * 1;
+		float64_t *row_ptr = op1_ptr + ((iy0 * op2) + ix0) * 1;
+		float64_t *pixel_ptr;
+		if(fx + fy == 0) {
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 1) {
+					float64_t coefficient = *op6_ptr++;
+					sum[0] += pixel_ptr[0] * coefficient;
+				}
+			}
+		} else {
+			float64_t fx1 = 1.0 - fx;
+			float64_t fy1 = 1.0 - fy;
+			for(r = 0; r < op7; r++, row_ptr += stride) {
+				for(c = 0, pixel_ptr = row_ptr; c < op8; c++, pixel_ptr += 1) {
+					float64_t coefficient = *op6_ptr++;
+					float64_t wt = fy1 * coefficient;
+					float64_t wb = fy * coefficient;
+					sum[0] += (pixel_ptr[0] * fx1 + pixel_ptr[1] * fx) * wt + (pixel_ptr[stride + 0] * fx1 + pixel_ptr[stride + 1] * fx) * wb;
+				}
+			}
+		}
+	} else if(fx + fy == 0) {
 		for(r = 0, iy = iy0; r < op7; r++, iy++) {
 			for(c = 0, ix = ix0; c < op8; c++, ix++) {
 				float64_t coefficient = *op6_ptr++;
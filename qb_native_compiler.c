@@ -196,13 +196,17 @@ enum qb_vm_exit_type {\
 struct qb_memory_segment {\
 	int8_t *memory;\
 	uint32_t flags;\
-	uint32_t byte_count;\
-	uint32_t current_allocation;\
+	uint64_t byte_count;\
+	uint64_t current_allocation;\
 	php_stream *stream;\
 	qb_memory_segment *imported_segment;\
 	qb_memory_segment *next_dependent;\
-	uintptr_t **references;\
+	int8_t *reference_base;\
+	uint32_t *reference_offsets;\
 	uint32_t reference_count;\
+	uint32_t reserved_byte_count;\
+	uint32_t relocation_count;\
+	uint64_t checksum;\
 };\
 \n");
 
@@ -1208,16 +1212,31 @@ static void * qb_find_symbol(qb_native_compiler_context *cxt, const char *name)
 	return NULL;
 }
 
+static void qb_set_native_proc(qb_function *qfunc, qb_native_proc proc) {
+	qb_function *f;
+	// copies that are in use keep running as bytecode, since they could be in the middle of a call
+	for(f = qfunc; f; f = f->next_reentrance_copy) {
+		if(!f->in_use) {
+			f->native_proc = proc;
+		}
+	}
+	for(f = qfunc->next_forked_copy; f; f = f->next_forked_copy) {
+		if(!f->in_use) {
+			f->native_proc = proc;
+		}
+	}
+}
+
 static uint32_t qb_attach_symbol(qb_native_compiler_context *cxt, const char *symbol_name, const char *address) {
 	uint32_t count = 0;
 	if(strncmp(symbol_name, "QBN_", 4) == 0) {
 		qb_native_proc proc = (qb_native_proc) address;
 		uint64_t crc64 = strtoull(symbol_name + 4, NULL, 16);
 		uint32_t i;
-		for(i = 0; i < cxt->compiler_context_count; i++) {
-			qb_compiler_context *compiler_cxt = cxt->compiler_contexts[i];
-			if(compiler_cxt->compiled_function->instruction_crc64 == crc64) {
-				compiler_cxt->compiled_function->native_proc = proc;
+		for(i = 0; i < cxt->compiled_function_count; i++) {
+			qb_function *qfunc = cxt->compiled_functions[i];
+			if(qfunc->instruction_crc64 == crc64) {
+				qb_set_native_proc(qfunc, proc);
 				count++;
 			}
 		}
@@ -1227,9 +1246,8 @@ static uint32_t qb_attach_symbol(qb_native_compiler_context *cxt, const char *sy
 
 static void qb_detach_symbols(qb_native_compiler_context *cxt) {
 	uint32_t i;
-	for(i = 0; i < cxt->compiler_context_count; i++) {
-		qb_compiler_context *compiler_cxt = cxt->compiler_contexts[i];
-		compiler_cxt->compiled_function->native_proc = NULL;
+	for(i = 0; i < cxt->compiled_function_count; i++) {
+		qb_set_native_proc(cxt->compiled_functions[i], NULL);
 	}
 	cxt->qb_version = 0;
 }
@@ -1243,12 +1261,12 @@ extern const char compressed_table_native_references[];
 #if ZEND_DEBUG
 static void qb_link_debuggable_functions(qb_native_compiler_context *cxt) {
 	uint32_t i, j;
-	for(i = 0; i < cxt->compiler_context_count; i++) {
-		qb_compiler_context *compiler_cxt = cxt->compiler_contexts[i];
+	for(i = 0; i < cxt->compiled_function_count; i++) {
+		qb_function *qfunc = cxt->compiled_functions[i];
 		for(j = 0; j < native_proc_table_size; j++) {
 			qb_native_proc_record *rec = &native_proc_table[j];
-			if(compiler_cxt->compiled_function->instruction_crc64 == rec->crc64) {
-				compiler_cxt->compiled_function->native_proc = rec->proc;
+			if(qfunc->instruction_crc64 == rec->crc64) {
+				qfunc->native_proc = rec->proc;
 			}
 		}
 	}
@@ -1283,6 +1301,205 @@ int32_t qb_decompress_code(qb_native_compiler_context *cxt) {
 #include "qb_native_compiler_win32.c"
 #endif
 
+static const qb_native_compiler_backend external_compiler_backend = {
+	"external",
+	FALSE,
+	qb_launch_compiler,
+	qb_wait_for_compiler_response,
+	qb_load_object_file,
+	qb_remove_object_file,
+};
+
+#ifdef HAVE_LIBTCC
+#include "qb_native_compiler_tcc.c"
+#endif
+
+static const qb_native_compiler_backend * qb_get_in_process_compiler_backend(qb_native_compiler_context *cxt) {
+#ifdef HAVE_LIBTCC
+	USE_TSRM
+	if(QB_G(allow_in_process_compilation)) {
+		return &tcc_compiler_backend;
+	}
+#endif
+	return NULL;
+}
+
+void qb_free_native_code(qb_native_code_bundle *bundle) {
+#ifdef HAVE_LIBTCC
+	if(bundle->compiler_state) {
+		tcc_delete(bundle->compiler_state);
+		return;
+	}
+#endif
+	qb_unmap_native_code(bundle);
+}
+
+static int32_t qb_generate_native_code(qb_native_compiler_context *cxt) {
+	USE_TSRM
+	if(!qb_decompress_code(cxt)) {
+		php_error_docref0(NULL TSRMLS_CC, E_WARNING, "Unable to decompress C source code");
+		return FALSE;
+	}
+
+	// launch compiler
+	if(!cxt->backend->launch(cxt)) {
+		if(!cxt->backend->in_process) {
+			php_error_docref0(NULL TSRMLS_CC, E_WARNING, "Unable to launch compiler");
+		}
+		return FALSE;
+	}
+
+#if ZEND_DEBUG
+	// exclude macros, type declaration, and prototypes so they don't conflict with
+	// what's defined in the header files if we include generated code to debug it
+	qb_print(cxt, "#ifndef ZEND_DEBUG\n");
+#endif
+	// print macros and type definitions
+	qb_print_macros(cxt);
+	qb_print_typedefs(cxt);
+
+	// print prototypes of function referenced
+	qb_print_prototypes(cxt);
+#if ZEND_DEBUG
+	qb_print(cxt, "#endif\n");
+#endif
+	// print the current QB version
+	qb_print_version(cxt);
+
+	// print code of the qb functions themselves
+	qb_print_functions(cxt);
+
+#if ZEND_DEBUG
+	// print a table of the functions
+	qb_print_function_records(cxt);
+#endif
+	return TRUE;
+}
+
+static int32_t qb_load_native_code(qb_native_compiler_context *cxt) {
+	USE_TSRM
+	if(cxt->backend->load(cxt)) {
+		if(cxt->qb_version == QB_VERSION_SIGNATURE) {
+			qb_native_code_bundle *bundle;
+			if(!QB_G(native_code_bundles)) {
+				qb_create_array((void **) &QB_G(native_code_bundles), &QB_G(native_code_bundle_count), sizeof(qb_native_code_bundle), 8);
+			}
+			bundle = qb_enlarge_array((void **) &QB_G(native_code_bundles), 1);
+			bundle->memory = cxt->binary;
+			bundle->size = cxt->binary_size;
+			bundle->compiler_state = cxt->compiler_state;
+			cxt->binary = NULL;
+			cxt->compiler_state = NULL;
+			return TRUE;
+		} else {
+			qb_detach_symbols(cxt);
+		}
+	}
+	cxt->backend->discard(cxt);
+	return FALSE;
+}
+
+static void qb_run_compiler_in_background(qb_native_compiler_context *cxt) {
+	USE_TSRM
+	qb_native_compiler_context *background_cxt, **p_background_cxt;
+
+	// let the compiler finish on its own while the functions keep running as bytecode
+	if(!qb_start_compiler_in_background(cxt)) {
+		return;
+	}
+
+	// move the context off the stack; the build's data will be gone by the time the compiler finishes
+	background_cxt = emalloc(sizeof(qb_native_compiler_context));
+	memcpy(background_cxt, cxt, sizeof(qb_native_compiler_context));
+	memset(cxt, 0, sizeof(qb_native_compiler_context));
+	cxt->backend = background_cxt->backend;
+	background_cxt->pool = NULL;
+	background_cxt->compiler_contexts = NULL;
+	background_cxt->compiler_context_count = 0;
+	background_cxt->compiled_function = NULL;
+	background_cxt->storage = NULL;
+
+	if(!QB_G(background_compilations)) {
+		qb_create_array((void **) &QB_G(background_compilations), &QB_G(background_compilation_count), sizeof(qb_native_compiler_context *), 4);
+	}
+	p_background_cxt = qb_enlarge_array((void **) &QB_G(background_compilations), 1);
+	*p_background_cxt = background_cxt;
+}
+
+static void qb_save_native_code_in_background(qb_native_compiler_context *cxt) {
+	USE_TSRM
+	qb_native_compiler_context _cache_cxt, *cache_cxt = &_cache_cxt;
+
+	// code compiled in-process is gone when the process exits--have the external compiler
+	// create the object file in the background so later processes can just load it
+	memcpy(cache_cxt, cxt, sizeof(qb_native_compiler_context));
+	cache_cxt->backend = &external_compiler_backend;
+	cache_cxt->write_stream = NULL;
+	cache_cxt->read_stream = NULL;
+	cache_cxt->error_stream = NULL;
+	cache_cxt->compiled_functions = NULL;
+	cache_cxt->compiled_function_count = 0;
+	cache_cxt->binary = NULL;
+	cache_cxt->binary_size = 0;
+	cache_cxt->compiler_state = NULL;
+	cache_cxt->print_source = FALSE;
+	cache_cxt->build_trace_index = -1;
+	cache_cxt->cache_only = TRUE;
+	if(cxt->cache_folder_path != QB_G(native_code_cache_path)) {
+		cache_cxt->cache_folder_path = estrdup(cxt->cache_folder_path);
+	}
+	cache_cxt->obj_file_path = estrdup(cxt->obj_file_path);
+	cache_cxt->c_file_path = NULL;
+	if(qb_generate_native_code(cache_cxt)) {
+		qb_run_compiler_in_background(cache_cxt);
+	}
+	qb_free_native_compiler_context(cache_cxt);
+}
+
+void qb_check_background_compilations(TSRMLS_D) {
+	uint32_t i = 0;
+	while(i < QB_G(background_compilation_count)) {
+		qb_native_compiler_context *cxt = QB_G(background_compilations)[i];
+		int32_t finished = FALSE;
+		int32_t success = qb_poll_compiler_response(cxt, &finished);
+		if(finished) {
+			if(cxt->cache_only) {
+				// the object file is left for later processes; remove it only if the compiler failed
+				if(!success) {
+					cxt->backend->discard(cxt);
+				}
+			} else if(success) {
+				// calls made from here on will use the native code
+				if(qb_load_native_code(cxt)) {
+					if(cxt->build_trace_index >= 0 && (uint32_t) cxt->build_trace_index < QB_G(build_trace_count)) {
+						QB_G(build_traces)[cxt->build_trace_index].native_code_attached = TRUE;
+					}
+				}
+			} else {
+				cxt->backend->discard(cxt);
+			}
+			qb_free_native_compiler_context(cxt);
+			efree(cxt);
+			QB_G(background_compilations)[i] = QB_G(background_compilations)[--QB_G(background_compilation_count)];
+		} else {
+			i++;
+		}
+	}
+	qb_reap_abandoned_compilers(TSRMLS_C);
+}
+
+void qb_abandon_background_compilations(TSRMLS_D) {
+	uint32_t i;
+	for(i = 0; i < QB_G(background_compilation_count); i++) {
+		qb_native_compiler_context *cxt = QB_G(background_compilations)[i];
+		qb_abandon_compiler(cxt);
+		qb_free_native_compiler_context(cxt);
+		efree(cxt);
+	}
+	qb_destroy_array((void **) &QB_G(background_compilations));
+	QB_G(background_compilation_count) = 0;
+}
+
 void qb_compile_to_native_code(qb_native_compiler_context *cxt) {
 	USE_TSRM
 	uint32_t i, attempt;
@@ -1311,80 +1528,54 @@ void qb_compile_to_native_code(qb_native_compiler_context *cxt) {
 	spprintf(&cxt->obj_file_path, 0, "%s%cQB%" PRIX64 ".o", cxt->cache_folder_path, PHP_DIR_SEPARATOR, cxt->file_id);
 
 #if ZEND_DEBUG
-	for(attempt = 2; attempt <= 2 && !success; attempt++) {
+	for(attempt = 2; attempt <= 3 && !success; attempt++) {
 #else
-	for(attempt = 1; attempt <= 2 && !success; attempt++) {
+	for(attempt = 1; attempt <= 3 && !success; attempt++) {
 #endif
+		if(attempt == 1) {
+			// first, try to load a previously created object file
+			cxt->backend = &external_compiler_backend;
+		} else if(attempt == 2) {
+			// then try compiling the code in-process
+			cxt->backend = qb_get_in_process_compiler_backend(cxt);
+			if(!cxt->backend) {
+				continue;
+			}
+			if(!qb_generate_native_code(cxt) || !cxt->backend->wait(cxt)) {
+				// fall back to the external compiler
+				cxt->backend->discard(cxt);
+				continue;
+			}
 
-		// first, try to load a previously created object file
-		if(attempt == 2) {
-			if(!qb_decompress_code(cxt)) {
-				php_error_docref0(NULL TSRMLS_CC, E_WARNING, "Unable to decompress C source code");
+			// the source code has to be generated before the functions are attached to the native code
+			qb_save_native_code_in_background(cxt);
+		} else {
+			// launch the external compiler
+			cxt->backend = &external_compiler_backend;
+			if(!qb_generate_native_code(cxt)) {
 				break;
 			}
 
-			// launch compiler
-			if(!qb_launch_compiler(cxt)) {
-				php_error_docref0(NULL TSRMLS_CC, E_WARNING, "Unable to launch compiler");
+			if(cxt->run_in_background) {
+				qb_run_compiler_in_background(cxt);
 				break;
 			}
 
-#if ZEND_DEBUG
-			// exclude macros, type declaration, and prototypes so they don't conflict with
-			// what's defined in the header files if we include generated code to debug it
-			qb_print(cxt, "#ifndef ZEND_DEBUG\n");
-#endif
-			// print macros and type definitions
-			qb_print_macros(cxt);
-			qb_print_typedefs(cxt);
-
-			// print prototypes of function referenced
-			qb_print_prototypes(cxt);
-#if ZEND_DEBUG
-	qb_print(cxt, "#endif\n");
-#endif
-			// print the current QB version
-			qb_print_version(cxt);
-
-			// print code of the qb functions themselves
-			qb_print_functions(cxt);
-
-#if ZEND_DEBUG
-			// print a table of the functions
-			qb_print_function_records(cxt);
-#endif
 			// wait for compiler to finish and see if it emits any error messages
-			if(!qb_wait_for_compiler_response(cxt)) {
+			if(!cxt->backend->wait(cxt)) {
 				break;
 			}
 		}
 
-		// load the object file produced by the compiler into memory
-		if(qb_load_object_file(cxt)) {
-			if(cxt->qb_version == QB_VERSION_SIGNATURE) {
-				qb_native_code_bundle *bundle;
-				if(!QB_G(native_code_bundles)) {
-					qb_create_array((void **) &QB_G(native_code_bundles), &QB_G(native_code_bundle_count), sizeof(qb_native_code_bundle), 8);
-				}
-				bundle = qb_enlarge_array((void **) &QB_G(native_code_bundles), 1);
-				bundle->memory = cxt->binary;
-				bundle->size = cxt->binary_size;
-				cxt->binary = NULL;
-				success = TRUE;
-			} else {
-				qb_detach_symbols(cxt);
-			}
-		}
-		if(!success) {
-			qb_remove_object_file(cxt);
-		}
+		// load the code produced by the compiler into memory
+		success = qb_load_native_code(cxt);
 	} 
 }
 
 void qb_initialize_native_compiler_context(qb_native_compiler_context *cxt, qb_build_context *build_cxt TSRMLS_DC) {
 	static int hashes_initialized = FALSE;
+	uint32_t i;
 	if(!hashes_initialized) {
-		uint32_t i;
 		// calculate hash for faster lookup
 		for(i = 0; i < global_native_symbol_count; i++) {
 			qb_native_symbol *symbol = &global_native_symbols[i];
@@ -1402,6 +1593,16 @@ void qb_initialize_native_compiler_context(qb_native_compiler_context *cxt, qb_b
 	cxt->print_source = QB_G(show_native_source);
 	cxt->compiler_contexts = build_cxt->compiler_contexts;
 	cxt->compiler_context_count = build_cxt->compiler_context_count;
+	cxt->compiled_functions = emalloc(sizeof(qb_function *) * build_cxt->compiler_context_count);
+	for(i = 0; i < build_cxt->compiler_context_count; i++) {
+		qb_compiler_context *compiler_cxt = build_cxt->compiler_contexts[i];
+		cxt->compiled_functions[cxt->compiled_function_count++] = compiler_cxt->compiled_function;
+	}
+
+	// a build that can't fall back on bytecode has to wait for the compiler
+	cxt->run_in_background = QB_G(background_native_compilation) && QB_G(allow_bytecode_interpretation);
+	// the trace is added to the list when the build finishes
+	cxt->build_trace_index = (build_cxt->trace && QB_G(trace_build)) ? (int32_t) QB_G(build_trace_count) : -1;
 	SAVE_TSRMLS
 
 	cxt->cache_folder_path = QB_G(native_code_cache_path);
@@ -1427,12 +1628,20 @@ void qb_free_native_compiler_context(qb_native_compiler_context *cxt) {
 	if(cxt->c_file_path) {
 		efree(cxt->c_file_path);
 	}
+	if(cxt->compiled_functions) {
+		efree(cxt->compiled_functions);
+	}
 
 #ifdef __GNUC__
 	if(cxt->binary) {
 		munmap(cxt->binary, cxt->binary_size);
 	}
 #endif
+#ifdef HAVE_LIBTCC
+	if(cxt->compiler_state) {
+		tcc_delete(cxt->compiler_state);
+	}
+#endif
 #ifdef _MSC_VER
 	if(cxt->binary) {
 		UnmapViewOfFile(cxt->binary);
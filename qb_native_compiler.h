@@ -24,6 +24,7 @@
 #ifdef NATIVE_COMPILE_ENABLED
 
 typedef struct qb_native_compiler_context	qb_native_compiler_context;
+typedef struct qb_native_compiler_backend	qb_native_compiler_backend;
 
 typedef enum qb_access_method				qb_access_method; 
 
@@ -45,7 +46,18 @@ enum qb_access_method {
 
 typedef QB_NATIVE_FUNCTION_RET (QB_NATIVE_FUNCTION_ATTR *qb_native_proc)(QB_NATIVE_FUNCTION_ARGS);
 
+struct qb_native_compiler_backend {
+	const char *name;
+	int32_t in_process;
+	int32_t (*launch)(qb_native_compiler_context *cxt);
+	int32_t (*wait)(qb_native_compiler_context *cxt);
+	int32_t (*load)(qb_native_compiler_context *cxt);
+	void (*discard)(qb_native_compiler_context *cxt);
+};
+
 struct qb_native_compiler_context {
+	const qb_native_compiler_backend *backend;
+
 	FILE *write_stream;
 	FILE *read_stream;
 	FILE *error_stream;
@@ -54,6 +66,9 @@ struct qb_native_compiler_context {
 	uint32_t compiler_context_count;
 	qb_data_pool *pool;
 
+	qb_function **compiled_functions;
+	uint32_t compiled_function_count;
+
 	qb_op **ops;
 	uint32_t op_count;
 	qb_variable **variables;
@@ -94,13 +109,19 @@ struct qb_native_compiler_context {
 #ifdef _MSC_VER
 	HANDLE msc_thread;
 	HANDLE msc_process;
+#else
+	long compiler_process_id;
 #endif
 
 	char *binary;
 	uint32_t binary_size;
+	void *compiler_state;
 
 	int32_t print_errors;
 	int32_t print_source;
+	int32_t run_in_background;
+	int32_t build_trace_index;					// where the build's trace will be kept, -1 if it isn't
+	int32_t cache_only;							// the code is already attached; the compiler only creates the object file
 
 #ifdef ZTS
 	void ***tsrm_ls;
@@ -118,6 +139,9 @@ void qb_compile_to_native_code(qb_native_compiler_context *cxt);
 void qb_initialize_native_compiler_context(qb_native_compiler_context *cxt, qb_build_context *build_cxt TSRMLS_DC);
 void qb_free_native_compiler_context(qb_native_compiler_context *cxt);
 
+void qb_check_background_compilations(TSRMLS_D);
+void qb_abandon_background_compilations(TSRMLS_D);
+
 #endif
 
 #endif
@@ -107,6 +107,7 @@ static int32_t qb_launch_compiler(qb_native_compiler_context *cxt) {
 	close(gcc_pipe_read[1]);
 	close(gcc_pipe_error[1]);
 
+	cxt->compiler_process_id = pid;
 	cxt->write_stream = fdopen(gcc_pipe_write[1], "w");
 	cxt->read_stream = fdopen(gcc_pipe_read[0], "r");
 	cxt->error_stream = fdopen(gcc_pipe_error[0], "r");
@@ -130,7 +131,7 @@ static int32_t qb_wait_for_compiler_response(qb_native_compiler_context *cxt) {
 
 	// wait for the gcc to finish
 	int status;
-	wait(&status);
+	waitpid((pid_t) cxt->compiler_process_id, &status, 0);
 
 	if(status == -1) {
 		return FALSE;
@@ -138,6 +139,60 @@ static int32_t qb_wait_for_compiler_response(qb_native_compiler_context *cxt) {
 	return TRUE;
 }
 
+static int32_t qb_start_compiler_in_background(qb_native_compiler_context *cxt) {
+	// close the write stream so gcc sees the end of the source code
+	fclose(cxt->write_stream);
+	cxt->write_stream = NULL;
+
+	// make sure reading error messages doesn't block
+	return (fcntl(fileno(cxt->error_stream), F_SETFL, O_NONBLOCK) != -1);
+}
+
+static int32_t qb_poll_compiler_response(qb_native_compiler_context *cxt, int32_t *p_finished) {
+	// see if gcc has exited
+	int status;
+	pid_t pid = waitpid((pid_t) cxt->compiler_process_id, &status, WNOHANG);
+
+	// read output from stderr
+	char buffer[256];
+	ssize_t count;
+	while((count = read(fileno(cxt->error_stream), buffer, sizeof(buffer))) > 0) {
+		if(cxt->print_errors) {
+			php_write(buffer, count);
+		}
+	}
+
+	if(pid == 0) {
+		*p_finished = FALSE;
+		return TRUE;
+	}
+	*p_finished = TRUE;
+	return (pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static void qb_abandon_compiler(qb_native_compiler_context *cxt) {
+	USE_TSRM
+	if(waitpid((pid_t) cxt->compiler_process_id, NULL, WNOHANG) == 0) {
+		// remember the process id so it can be reaped when it's done
+		long *ids = realloc(QB_G(abandoned_compiler_ids), sizeof(long) * (QB_G(abandoned_compiler_count) + 1));
+		if(ids) {
+			ids[QB_G(abandoned_compiler_count)++] = cxt->compiler_process_id;
+			QB_G(abandoned_compiler_ids) = ids;
+		}
+	}
+}
+
+static void qb_reap_abandoned_compilers(TSRMLS_D) {
+	uint32_t i = 0;
+	while(i < QB_G(abandoned_compiler_count)) {
+		if(waitpid((pid_t) QB_G(abandoned_compiler_ids)[i], NULL, WNOHANG) != 0) {
+			QB_G(abandoned_compiler_ids)[i] = QB_G(abandoned_compiler_ids)[--QB_G(abandoned_compiler_count)];
+		} else {
+			i++;
+		}
+	}
+}
+
 #ifdef __x86_64__
 
 #pragma pack(push,1)
@@ -418,7 +473,7 @@ static void qb_remove_object_file(qb_native_compiler_context *cxt) {
 	unlink(cxt->obj_file_path);
 }
 
-void qb_free_native_code(qb_native_code_bundle *bundle) {
+static void qb_unmap_native_code(qb_native_code_bundle *bundle) {
 	munmap(bundle->memory, bundle->size);
 }
 
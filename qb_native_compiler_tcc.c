@@ -0,0 +1,126 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2012 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Chung Leong <cleong@cal.berkeley.edu>                        |
+  +----------------------------------------------------------------------+
+*/
+
+/* $Id$ */
+
+#include <libtcc.h>
+
+static void qb_report_tcc_error(void *opaque, const char *message) {
+	qb_native_compiler_context *cxt = opaque;
+	if(cxt->print_errors) {
+		USE_TSRM
+		php_printf("%s\n", message);
+	}
+}
+
+static int32_t qb_launch_tcc(qb_native_compiler_context *cxt) {
+	// libtcc takes the source code as a string--collect it in a temporary file first
+	cxt->write_stream = tmpfile();
+	return (cxt->write_stream != NULL);
+}
+
+static int32_t qb_run_tcc(qb_native_compiler_context *cxt) {
+	TCCState *s;
+	char *source;
+	long length;
+	int32_t result = FALSE;
+
+	// read the source code back
+	length = ftell(cxt->write_stream);
+	if(length <= 0) {
+		return FALSE;
+	}
+	source = emalloc(length + 1);
+	rewind(cxt->write_stream);
+	length = (long) fread(source, 1, length, cxt->write_stream);
+	source[length] = '\0';
+	fclose(cxt->write_stream);
+	cxt->write_stream = NULL;
+
+	s = tcc_new();
+	if(s) {
+		uint32_t i;
+		tcc_set_error_func(s, cxt, qb_report_tcc_error);
+		tcc_set_output_type(s, TCC_OUTPUT_MEMORY);
+		if(tcc_compile_string(s, source) == 0) {
+			// resolve references to functions in the C runtime and QB itself
+			for(i = 0; i < global_native_symbol_count; i++) {
+				qb_native_symbol *symbol = &global_native_symbols[i];
+				if(symbol->name) {
+					void *address = qb_get_symbol_address(cxt, symbol);
+					if(address) {
+						tcc_add_symbol(s, symbol->name, address);
+					}
+				}
+			}
+#ifdef TCC_RELOCATE_AUTO
+			result = (tcc_relocate(s, TCC_RELOCATE_AUTO) == 0);
+#else
+			result = (tcc_relocate(s) == 0);
+#endif
+		}
+		if(result) {
+			cxt->compiler_state = s;
+		} else {
+			tcc_delete(s);
+		}
+	}
+	efree(source);
+	return result;
+}
+
+static int32_t qb_load_tcc_code(qb_native_compiler_context *cxt) {
+	uint32_t *p_version = tcc_get_symbol(cxt->compiler_state, "QB_VERSION");
+	uint32_t i, count = 0;
+	if(p_version) {
+		cxt->qb_version = *p_version;
+	}
+	for(i = 0; i < cxt->compiled_function_count; i++) {
+		qb_function *qfunc = cxt->compiled_functions[i];
+		if(!qfunc->native_proc) {
+			char name[32];
+			void *address;
+			snprintf(name, sizeof(name), "QBN_%" PRIX64, qfunc->instruction_crc64);
+			address = tcc_get_symbol(cxt->compiler_state, name);
+			if(address) {
+				count += qb_attach_symbol(cxt, name, (const char *) address);
+			}
+		}
+	}
+	return (count > 0);
+}
+
+static void qb_discard_tcc_code(qb_native_compiler_context *cxt) {
+	if(cxt->write_stream) {
+		fclose(cxt->write_stream);
+		cxt->write_stream = NULL;
+	}
+	if(cxt->compiler_state) {
+		tcc_delete(cxt->compiler_state);
+		cxt->compiler_state = NULL;
+	}
+}
+
+static const qb_native_compiler_backend tcc_compiler_backend = {
+	"libtcc",
+	TRUE,
+	qb_launch_tcc,
+	qb_run_tcc,
+	qb_load_tcc_code,
+	qb_discard_tcc_code,
+};
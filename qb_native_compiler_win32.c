@@ -164,6 +164,54 @@ static int32_t qb_wait_for_compiler_response(qb_native_compiler_context *cxt) {
 	return TRUE;
 }
 
+static int32_t qb_start_compiler_in_background(qb_native_compiler_context *cxt) {
+	// close the write stream
+	fclose(cxt->write_stream);
+	cxt->write_stream = NULL;
+
+	// the compiler process was created in suspended state
+	return (ResumeThread(cxt->msc_thread) != (DWORD) -1);
+}
+
+static int32_t qb_poll_compiler_response(qb_native_compiler_context *cxt, int32_t *p_finished) {
+	USE_TSRM
+	HANDLE pipe = (HANDLE) _get_osfhandle(_fileno(cxt->error_stream));
+	DWORD available, exit_code;
+	char buffer[256];
+	size_t count;
+
+	if(WaitForSingleObject(cxt->msc_process, 0) == WAIT_TIMEOUT) {
+		// read only what's in the pipe so we don't block
+		while(PeekNamedPipe(pipe, NULL, 0, NULL, &available, NULL) && available > 0) {
+			count = fread(buffer, 1, (available < sizeof(buffer)) ? available : sizeof(buffer), cxt->error_stream);
+			if(cxt->print_errors) {
+				php_write(buffer, (uint32_t) count TSRMLS_CC);
+			}
+		}
+		*p_finished = FALSE;
+		return TRUE;
+	}
+
+	// the process has exited--read the rest
+	while((count = fread(buffer, 1, sizeof(buffer), cxt->error_stream))) {
+		if(cxt->print_errors) {
+			php_write(buffer, (uint32_t) count TSRMLS_CC);
+		}
+	}
+
+	// delete the temporary c file
+	DeleteFile(cxt->c_file_path);
+	*p_finished = TRUE;
+	return (GetExitCodeProcess(cxt->msc_process, &exit_code) && exit_code == 0);
+}
+
+static void qb_abandon_compiler(qb_native_compiler_context *cxt) {
+	// nothing needs to be done--the process handle is closed when the context is freed
+}
+
+static void qb_reap_abandoned_compilers(TSRMLS_D) {
+}
+
 #ifdef _WIN64	
 #define IMAGE_FILE_MACHINE		IMAGE_FILE_MACHINE_AMD64
 #define SYMBOL_PREFIX_LENGTH	0
@@ -406,7 +454,7 @@ static void qb_remove_object_file(qb_native_compiler_context *cxt) {
 	DeleteFile(cxt->obj_file_path);
 }
 
-void qb_free_native_code(qb_native_code_bundle *bundle) {
+static void qb_unmap_native_code(qb_native_code_bundle *bundle) {
 	VirtualFree(bundle->memory, 0, MEM_RELEASE); 
 }
 
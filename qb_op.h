@@ -227,6 +227,8 @@ enum {
 	QB_OP_COMPILE_TIME_FLAGS		= 0xFFFF0000,
 	QB_OP_REACHABLE					= 0x10000000,
 	QB_OP_CHECKED					= 0x01000000,
+	QB_OP_SCANNED					= 0x02000000,
+	QB_OP_SCANNED_IN_FORK			= 0x04000000,
 };
 
 struct qb_op {
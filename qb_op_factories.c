@@ -6327,6 +6327,23 @@ qb_op_factory factory_define = {
 	QB_RESULT_HAS_SIDE_EFFECT,
 };
 
+qb_op_factory factory_array_reserve = {
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	qb_set_result_none,
+	qb_validate_operands_array_reserve,
+	qb_set_result_array_reserve,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	0,
+	QB_RESULT_HAS_SIDE_EFFECT,
+};
+
 qb_php_function_result_factory factory_phpversion = {
 	NULL,
 	qb_resolve_expression_flags_constant_string,
@@ -692,6 +692,7 @@ extern qb_op_decomposer factory_array_push;
 extern qb_simple_op_factory factory_array_rand;
 extern qb_basic_op_factory factory_array_replace;
 extern qb_array_resize_op_factory factory_array_resize;
+extern qb_op_factory factory_array_reserve;
 extern qb_basic_op_factory factory_array_reverse;
 extern qb_basic_op_factory factory_array_rpos;
 extern qb_basic_op_factory factory_array_search;
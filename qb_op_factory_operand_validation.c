@@ -920,6 +920,20 @@ static int32_t qb_validate_operands_array_resize(qb_compiler_context *cxt, qb_op
 	return TRUE;
 }
 
+static int32_t qb_validate_operands_array_reserve(qb_compiler_context *cxt, qb_op_factory *f, qb_primitive_type expr_type, uint32_t flags, qb_operand *operands, uint32_t operand_count, qb_result_destination *result_destination) {
+	qb_operand *container = &operands[0], *count = &operands[1];
+
+	if(container->type != QB_OPERAND_ADDRESS || !IS_VARIABLE_LENGTH(container->address)) {
+		qb_report_unexpected_intrinsic_argument_exception(cxt->line_id, cxt->intrinsic_function, 0, "variable-length array");
+		return FALSE;
+	}
+	if(!((count->type == QB_OPERAND_ZVAL && Z_TYPE_P(count->constant) == IS_LONG) || (count->type == QB_OPERAND_ADDRESS && IS_IMMUTABLE(count->address) && IS_SCALAR(count->address) && count->address->type < QB_TYPE_F32))) {
+		qb_report_unexpected_intrinsic_argument_exception(cxt->line_id, cxt->intrinsic_function, 1, "constant integer");
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static int32_t qb_validate_operands_array_slice(qb_compiler_context *cxt, qb_op_factory *f, qb_primitive_type expr_type, uint32_t flags, qb_operand *operands, uint32_t operand_count, qb_result_destination *result_destination) {
 	qb_operand *container = &operands[0], *offset = &operands[1], *length = &operands[2];
 
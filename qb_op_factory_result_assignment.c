@@ -695,6 +695,46 @@ static int32_t qb_set_result_define(qb_compiler_context *cxt, qb_op_factory *f,
 	return TRUE;
 }
 
+static int32_t qb_set_result_array_reserve(qb_compiler_context *cxt, qb_op_factory *f, qb_primitive_type expr_type, uint32_t flags, qb_operand *operands, uint32_t operand_count, qb_operand *result, qb_result_prototype *result_prototype) {
+	qb_operand *container = &operands[0], *count = &operands[1];
+	qb_address *address = container->address;
+	qb_array_reservation *reservation;
+	uint64_t element_count, byte_count;
+	int64_t value;
+
+	if(count->type == QB_OPERAND_ZVAL) {
+		value = Z_LVAL_P(count->constant);
+	} else {
+		switch(count->address->type) {
+			case QB_TYPE_S08: value = VALUE(S08, count->address); break;
+			case QB_TYPE_U08: value = VALUE(U08, count->address); break;
+			case QB_TYPE_S16: value = VALUE(S16, count->address); break;
+			case QB_TYPE_U16: value = VALUE(U16, count->address); break;
+			case QB_TYPE_S32: value = VALUE(S32, count->address); break;
+			case QB_TYPE_U32: value = VALUE(U32, count->address); break;
+			case QB_TYPE_S64: value = VALUE(S64, count->address); break;
+			case QB_TYPE_U64: value = (int64_t) VALUE(U64, count->address); break;
+			default: return FALSE;
+		}
+	}
+	element_count = (value > 0 && value < 0x7FFFFFFF) ? (uint64_t) value : 0;
+	if(address->dimension_count > 1) {
+		// the count refers to entries in the first dimension
+		qb_address *sub_array_size_address = address->array_size_addresses[1];
+		if(IS_IMMUTABLE(sub_array_size_address)) {
+			element_count *= VALUE(U32, sub_array_size_address);
+		}
+	}
+	byte_count = (element_count < 0x7FFFFFFF) ? element_count << type_size_shifts[address->type] : 0;
+	if(byte_count > 0 && byte_count < 0x7FFFFC00) {
+		reservation = qb_enlarge_array((void **) &cxt->array_reservations, 1);
+		reservation->address = address;
+		reservation->byte_count = (uint32_t) byte_count;
+	}
+	result->type = QB_OPERAND_NONE;
+	return TRUE;
+}
+
 static int32_t qb_run_php_function(qb_compiler_context *cxt, const char *function_name, int32_t *zval_types, qb_operand *operands, uint32_t operand_count, zval **p_retval) {
 	USE_TSRM
 	uint32_t i;
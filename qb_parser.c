@@ -69,8 +69,19 @@ int32_t qb_set_engine_flags(qb_parser_context *cxt, uint32_t flags, qb_token_pos
 
 int32_t qb_add_import(qb_parser_context *cxt, qb_token_position p) {
 	qb_function_declaration *f_decl = cxt->function_declaration;
-	f_decl->import_path = qb_allocate_string(cxt->pool, cxt->lexer_context->base + p.index, p.length);
-	f_decl->import_path_length = p.length;
+	const char *import_path = qb_allocate_string(cxt->pool, cxt->lexer_context->base + p.index, p.length);
+	if(!f_decl->import_path) {
+		f_decl->import_path = import_path;
+		f_decl->import_path_length = p.length;
+	} else {
+		// additional filters are applied to the output of the first
+		const char **p_import_path;
+		if(!f_decl->chained_import_paths) {
+			qb_attach_new_array(cxt->pool, (void **) &f_decl->chained_import_paths, &f_decl->chained_import_path_count, sizeof(const char *), 4);
+		}
+		p_import_path = qb_enlarge_array((void **) &f_decl->chained_import_paths, 1);
+		*p_import_path = import_path;
+	}
 	return TRUE;
 }
 
@@ -65,6 +65,8 @@ struct qb_function_declaration {
 	uint32_t flags;
 	const char *import_path;
 	uint32_t import_path_length;
+	const char **chained_import_paths;
+	uint32_t chained_import_path_count;
 	zend_op_array *zend_op_array;
 	qb_class_declaration *class_declaration;
 };
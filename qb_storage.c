@@ -20,16 +20,23 @@
 
 #include "qb.h"
 
+#ifndef ZEND_WIN32
+#	include <sys/mman.h>
+#	include <fcntl.h>
+#endif
+
 static intptr_t qb_relocate_segment_memory(qb_memory_segment *segment, int8_t *new_location) {
 	if(segment->memory != new_location) {
 		// adjust references in code
 		uint32_t i;
 		intptr_t diff = new_location - segment->memory;
+		int8_t *base = segment->reference_base;
 		for(i = 0; i < segment->reference_count; i++) {
-			uintptr_t *p_ref = segment->references[i];
+			uintptr_t *p_ref = (uintptr_t *) (base + segment->reference_offsets[i]);
 			*p_ref += diff;
 		}
 		segment->memory = new_location;
+		segment->relocation_count++;
 
 		// relocate other segments that point to the same location
 		if(segment->next_dependent) {
@@ -56,32 +63,197 @@ void qb_import_segment(qb_memory_segment *segment, qb_memory_segment *other_segm
 	}
 }
 
+static int32_t qb_can_allocate_in_worker_thread(qb_memory_segment *segment) {
+	// segments that are separated on fork are private to the thread running the fork
+	// they can be enlarged there as long as the memory didn't come from emalloc()
+	if(segment->flags & QB_SEGMENT_SEPARATE_ON_FORK) {
+		if(!(segment->flags & (QB_SEGMENT_BORROWED | QB_SEGMENT_MAPPED))) {
+			if(segment->current_allocation == 0 || (segment->flags & (QB_SEGMENT_THREAD_ALLOCATED | QB_SEGMENT_PAGE_ALLOCATED))) {
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+
+static uint64_t qb_calculate_segment_allocation(qb_memory_segment *segment, uint64_t byte_count) {
+	uint64_t new_allocation = ALIGN_TO(byte_count, 1024);
+	if(segment->current_allocation > 0) {
+		// grow geometrically so that appending to an array doesn't lead to a relocation every 1K
+		double enlarged_allocation = segment->current_allocation * array_growth_factor;
+		if(enlarged_allocation > new_allocation && enlarged_allocation < (double) SIZE_MAX) {
+			new_allocation = ALIGN_TO((uint64_t) enlarged_allocation, 1024);
+		}
+	} else if(segment->reserved_byte_count > new_allocation) {
+		// allocate the amount requested by array_reserve()
+		new_allocation = ALIGN_TO(segment->reserved_byte_count, 1024);
+	}
+	return new_allocation;
+}
+
+#ifndef ZEND_WIN32
+#	if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#		define MAP_ANONYMOUS	MAP_ANON
+#	endif
+#	define QB_PAGE_ALLOCATION_UNIT		(2 * 1024 * 1024)
+#else
+#	define QB_PAGE_ALLOCATION_UNIT		(64 * 1024)
+#endif
+
+static int8_t * qb_allocate_pages(uint64_t byte_count) {
+#ifdef ZEND_WIN32
+	// large pages require SeLockMemoryPrivilege, which a web server generally doesn't have
+	return VirtualAlloc(NULL, (SIZE_T) byte_count, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	void *memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+	if(use_huge_pages) {
+		// the pool of explicit huge pages might be empty, in which case we use regular pages
+		memory = mmap(NULL, byte_count, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	}
+#endif
+	if(memory == MAP_FAILED) {
+		memory = mmap(NULL, byte_count, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(memory == MAP_FAILED) {
+			return NULL;
+		}
+#ifdef MADV_HUGEPAGE
+		if(use_huge_pages) {
+			// ask for transparent huge pages instead
+			madvise(memory, byte_count, MADV_HUGEPAGE);
+		}
+#endif
+	}
+	return memory;
+#endif
+}
+
+void qb_free_pages(int8_t *memory, uint64_t byte_count) {
+#ifdef ZEND_WIN32
+	VirtualFree(memory, 0, MEM_RELEASE);
+#else
+	munmap(memory, byte_count);
+#endif
+}
+
+static int8_t * qb_reallocate_pages(int8_t *memory, uint64_t byte_count, uint64_t new_byte_count) {
+	int8_t *new_memory;
+#ifdef MREMAP_MAYMOVE
+	// let the kernel move the page table entries around instead of copying
+	new_memory = mremap(memory, byte_count, new_byte_count, MREMAP_MAYMOVE);
+	if(new_memory != MAP_FAILED) {
+		return new_memory;
+	}
+#endif
+	new_memory = qb_allocate_pages(new_byte_count);
+	if(new_memory) {
+		memcpy(new_memory, memory, byte_count);
+		qb_free_pages(memory, byte_count);
+	}
+	return new_memory;
+}
+
+static int32_t qb_use_page_allocation(qb_memory_segment *segment, uint64_t new_allocation) {
+	// memory borrowed from a zval has to remain in the Zend heap
+	if(large_segment_threshold > 0 && new_allocation >= (uint64_t) large_segment_threshold) {
+		if(!(segment->flags & QB_SEGMENT_BORROWED)) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static int8_t * qb_reallocate_segment_block(qb_memory_segment *segment, uint64_t *p_new_allocation) {
+	uint64_t new_allocation = *p_new_allocation;
+	int8_t *memory;
+	if((segment->flags & QB_SEGMENT_PAGE_ALLOCATED) || qb_use_page_allocation(segment, new_allocation)) {
+		// large segments get whole pages, which are 64-byte aligned and can be enlarged from any thread
+		uint64_t page_allocation = ALIGN_TO(new_allocation, QB_PAGE_ALLOCATION_UNIT);
+		if(segment->flags & QB_SEGMENT_PAGE_ALLOCATED) {
+			memory = qb_reallocate_pages(segment->memory, segment->current_allocation, page_allocation);
+		} else {
+			memory = qb_allocate_pages(page_allocation);
+			if(memory && segment->current_allocation > 0) {
+				// move the contents out of the smaller block
+				memcpy(memory, segment->memory, segment->byte_count);
+				if(segment->flags & QB_SEGMENT_THREAD_ALLOCATED) {
+					free(segment->memory);
+				} else {
+					efree(segment->memory);
+				}
+			}
+		}
+		if(memory) {
+			segment->flags = (segment->flags & ~QB_SEGMENT_THREAD_ALLOCATED) | QB_SEGMENT_PAGE_ALLOCATED;
+			*p_new_allocation = page_allocation;
+			return memory;
+		} else if(segment->flags & QB_SEGMENT_PAGE_ALLOCATED) {
+			// move the contents into a regular block
+			int8_t *pages = segment->memory;
+			if(qb_in_main_thread()) {
+				memory = emalloc(new_allocation);
+			} else {
+				memory = malloc(new_allocation);
+				segment->flags |= QB_SEGMENT_THREAD_ALLOCATED;
+			}
+			memcpy(memory, pages, segment->byte_count);
+			qb_free_pages(pages, segment->current_allocation);
+			segment->flags &= ~QB_SEGMENT_PAGE_ALLOCATED;
+			return memory;
+		}
+		// fall back to the regular allocator
+	}
+	if(segment->flags & QB_SEGMENT_THREAD_ALLOCATED) {
+		return realloc(segment->memory, new_allocation);
+	} else if(!qb_in_main_thread()) {
+		// emalloc() isn't thread-safe; the memory is freed with the segment when the fork is done
+		segment->flags |= QB_SEGMENT_THREAD_ALLOCATED;
+		return malloc(new_allocation);
+	} else if(segment->current_allocation > 0) {
+		return erealloc(segment->memory, new_allocation);
+	} else {
+		return emalloc(new_allocation);
+	}
+}
+
+static uint64_t qb_get_segment_clearing_limit(qb_memory_segment *segment, uint64_t previous_allocation, uint64_t new_allocation) {
+	if(segment->flags & QB_SEGMENT_PAGE_ALLOCATED) {
+		// pages fresh from the OS are already zero-filled--only what the segment had before can hold stale data
+		// clearing the rest would also make the OS commit memory the array might never use
+		return (previous_allocation < new_allocation) ? previous_allocation : new_allocation;
+	}
+	return new_allocation;
+}
+
 static void qb_allocate_segment_memory_in_main_thread(void *param1, void *param2, int param3) {
-	qb_allocate_segment_memory(param1, param3);
+	uint64_t *p_byte_count = param2;
+	qb_allocate_segment_memory(param1, *p_byte_count);
 }
 
-void qb_allocate_segment_memory(qb_memory_segment *segment, uint32_t byte_count) {
+void qb_allocate_segment_memory(qb_memory_segment *segment, uint64_t byte_count) {
 	if(segment->flags & QB_SEGMENT_IMPORTED) {
 		qb_allocate_segment_memory(segment->imported_segment, byte_count);
 	} else {
 		if(byte_count > segment->current_allocation) {
-			if(qb_in_main_thread()) {
-				uint32_t new_allocation = ALIGN_TO(byte_count, 1024);
-				uint32_t extra = new_allocation - byte_count;
-				int8_t *memory = (segment->current_allocation > 0) ? erealloc(segment->memory, new_allocation): emalloc(new_allocation);
-				int8_t *data_end = memory + byte_count;
+			if(qb_in_main_thread() || qb_can_allocate_in_worker_thread(segment)) {
+				uint64_t previous_allocation = segment->current_allocation;
+				uint64_t new_allocation = qb_calculate_segment_allocation(segment, byte_count);
+				int8_t *memory = qb_reallocate_segment_block(segment, &new_allocation);
+				uint64_t clearing_limit = qb_get_segment_clearing_limit(segment, previous_allocation, new_allocation);
 				segment->current_allocation = new_allocation;
-				memset(data_end, 0, extra);
+				if(clearing_limit > byte_count) {
+					memset(memory + byte_count, 0, clearing_limit - byte_count);
+				}
 				qb_relocate_segment_memory(segment, memory);
 				segment->byte_count = byte_count;
 			} else {
-				qb_run_in_main_thread(qb_allocate_segment_memory_in_main_thread, segment, NULL, byte_count);
+				qb_run_in_main_thread(qb_allocate_segment_memory_in_main_thread, segment, &byte_count, 0);
 			}
 		}
 	}
 }
 
-static int32_t qb_connect_segment_to_memory(qb_memory_segment *segment, int8_t *memory, uint32_t byte_count, uint32_t bytes_available, int32_t ownership) {	
+static int32_t qb_connect_segment_to_memory(qb_memory_segment *segment, int8_t *memory, uint64_t byte_count, uint64_t bytes_available, int32_t ownership) {	
 	if(segment->flags & QB_SEGMENT_IMPORTED) {
 		return qb_connect_segment_to_memory(segment->imported_segment, memory, byte_count, bytes_available, ownership);
 	} else {
@@ -104,14 +276,14 @@ static int32_t qb_connect_segment_to_memory(qb_memory_segment *segment, int8_t *
 	}
 }
 
-static void * qb_map_file_to_memory(php_stream *stream, uint32_t byte_count, int32_t write_access TSRMLS_DC);
+static void * qb_map_file_to_memory(php_stream *stream, uint64_t byte_count, int32_t write_access TSRMLS_DC);
 static void qb_unmap_file_from_memory(php_stream *stream TSRMLS_DC);
 
-static int32_t qb_connect_segment_to_file(qb_memory_segment *segment, php_stream *stream, uint32_t byte_count, int32_t write_access) {
+static int32_t qb_connect_segment_to_file(qb_memory_segment *segment, php_stream *stream, uint64_t byte_count, int32_t write_access) {
 	if(segment->flags & QB_SEGMENT_IMPORTED) {
 		return qb_connect_segment_to_file(segment->imported_segment, stream, byte_count, write_access);
 	} else {
-		uint32_t bytes_available = byte_count;
+		uint64_t bytes_available = byte_count;
 		int8_t *memory;
 		TSRMLS_FETCH();
 		if(!bytes_available) {
@@ -124,6 +296,9 @@ static int32_t qb_connect_segment_to_file(qb_memory_segment *segment, php_stream
 				return FALSE;
 			}
 			segment->flags |= QB_SEGMENT_MAPPED;
+			if(stream == QB_G(file_window_stream)) {
+				segment->flags |= QB_SEGMENT_WINDOWED;
+			}
 			segment->stream = stream;
 			return TRUE;
 		} else {
@@ -146,6 +321,14 @@ void qb_release_segment(qb_memory_segment *segment) {
 	} else if((segment->flags & QB_SEGMENT_BORROWED) && !(segment->flags & QB_SEGMENT_MAPPED)) {
 		// the memory was borrowed--nothing needs to be done
 		segment->flags &= ~QB_SEGMENT_BORROWED;
+	} else if(segment->flags & QB_SEGMENT_THREAD_ALLOCATED) {
+		// the memory came from malloc(), which is safe to free from any thread
+		free(segment->memory);
+		segment->flags &= ~QB_SEGMENT_THREAD_ALLOCATED;
+	} else if(segment->flags & QB_SEGMENT_PAGE_ALLOCATED) {
+		// the pages came directly from the OS
+		qb_free_pages(segment->memory, segment->current_allocation);
+		segment->flags &= ~QB_SEGMENT_PAGE_ALLOCATED;
 	} else {
 		if(qb_in_main_thread()) {
 			if(segment->flags & QB_SEGMENT_MAPPED) {
@@ -153,10 +336,11 @@ void qb_release_segment(qb_memory_segment *segment) {
 				qb_unmap_file_from_memory(segment->stream TSRMLS_CC);
 
 				// set the file to the actual size if more bytes were allocated than needed
-				if(segment->current_allocation != segment->byte_count) {
+				// (a window doesn't extend to the end of the file)
+				if(segment->current_allocation != segment->byte_count && !(segment->flags & QB_SEGMENT_WINDOWED)) {
 					php_stream_truncate_set_size(segment->stream, segment->byte_count);
 				}
-				segment->flags &= ~(QB_SEGMENT_BORROWED | QB_SEGMENT_MAPPED);
+				segment->flags &= ~(QB_SEGMENT_BORROWED | QB_SEGMENT_MAPPED | QB_SEGMENT_WINDOWED);
 				segment->stream = NULL;
 			} else {
 				if(segment->current_allocation > 0) {
@@ -176,22 +360,28 @@ void qb_release_segment(qb_memory_segment *segment) {
 }
 
 void qb_resize_segment_in_main_thread(void *param1, void *param2, int param3) {
-	intptr_t *p_offset = param2;
-	*p_offset = qb_resize_segment(param1, param3);
+	// the new size comes in through the same variable as the offset goes out
+	// (a 64-bit variable, since the size won't fit in a pointer-sized one on 32-bit builds)
+	uint64_t *p_new_size = param2;
+	*p_new_size = (uint64_t) (int64_t) qb_resize_segment(param1, *p_new_size);
 }
 
-intptr_t qb_resize_segment(qb_memory_segment *segment, uint32_t new_size) {
+intptr_t qb_resize_segment(qb_memory_segment *segment, uint64_t new_size) {
 	if(segment->flags & QB_SEGMENT_IMPORTED) {
 		return qb_resize_segment(segment->imported_segment, new_size);
 	}
 	if(new_size > segment->current_allocation) {
-		if(qb_in_main_thread()) {
-			int8_t *current_data_end;
+		if(qb_in_main_thread() || qb_can_allocate_in_worker_thread(segment)) {
 			int8_t *memory;
-			uint32_t new_allocation = ALIGN_TO(new_size, 1024);
-			uint32_t addition = new_allocation - segment->current_allocation;
-
-			if(segment->flags & QB_SEGMENT_MAPPED) {
+			uint64_t previous_allocation = segment->current_allocation;
+			uint64_t new_allocation = qb_calculate_segment_allocation(segment, new_size);
+			uint64_t clearing_limit;
+
+			if(segment->flags & QB_SEGMENT_WINDOWED) {
+				// a window into a file cannot grow
+				qb_report_memory_map_exception(0, segment->stream->orig_path);
+				return 0;
+			} else if(segment->flags & QB_SEGMENT_MAPPED) {
 				// unmap the file, enlarge it, then map it again
 				TSRMLS_FETCH();
 				qb_unmap_file_from_memory(segment->stream TSRMLS_CC);
@@ -200,29 +390,24 @@ intptr_t qb_resize_segment(qb_memory_segment *segment, uint32_t new_size) {
 				if(!memory) {
 					// shouldn't really happen--we had managed to map it successfully after all
 					qb_report_memory_map_exception(0, segment->stream->orig_path);
-					addition = 0;
 					new_size = 0;
 					new_allocation = 0;
 				}
 			} else {
-				// segment->memory is valid only when current_allocation > 0
-				if(segment->current_allocation > 0) {
-					memory = erealloc(segment->memory, new_allocation);
-				} else {
-					memory = emalloc(new_allocation);
-				}
+				memory = qb_reallocate_segment_block(segment, &new_allocation);
 			}
+			clearing_limit = qb_get_segment_clearing_limit(segment, previous_allocation, new_allocation);
 
 			// clear the newly allcoated bytes
-			current_data_end = memory + segment->byte_count;
-			memset(current_data_end, 0, addition);
+			if(clearing_limit > segment->byte_count) {
+				memset(memory + segment->byte_count, 0, clearing_limit - segment->byte_count);
+			}
 			segment->byte_count = new_size;
 			segment->current_allocation = new_allocation;
 			return qb_relocate_segment_memory(segment, memory);
 		} else {
-			intptr_t offset;
-			qb_run_in_main_thread(qb_resize_segment_in_main_thread, segment, &offset, new_size);
-			return offset;
+			qb_run_in_main_thread(qb_resize_segment_in_main_thread, segment, &new_size, 0);
+			return (intptr_t) (int64_t) new_size;
 		}
 	} else {
 		segment->byte_count = new_size;
@@ -233,7 +418,7 @@ intptr_t qb_resize_segment(qb_memory_segment *segment, uint32_t new_size) {
 qb_storage * qb_create_storage_copy(qb_storage *base, intptr_t instruction_shift, int32_t reentrance) {
 	qb_storage *storage;
 	intptr_t shift;
-	uint32_t i, j;
+	uint32_t i;
 
 	storage = emalloc(base->size);
 	memcpy(storage, base, base->size);
@@ -246,6 +431,10 @@ qb_storage * qb_create_storage_copy(qb_storage *base, intptr_t instruction_shift
 		qb_memory_segment *dst = &storage->segments[i];
 		int separation;
 
+		// the copy never shares memory allocated by a worker or mapped from the OS
+		dst->flags &= ~(QB_SEGMENT_THREAD_ALLOCATED | QB_SEGMENT_PAGE_ALLOCATED | QB_SEGMENT_CHECKSUMMED);
+		dst->relocation_count = 0;
+
 		if(dst->flags & QB_SEGMENT_SEPARATE_ON_FORK && !reentrance) {
 			separation = TRUE;
 		} else if((dst->flags & QB_SEGMENT_SEPARATE_ON_REENTRY) && reentrance) {
@@ -259,14 +448,12 @@ qb_storage * qb_create_storage_copy(qb_storage *base, intptr_t instruction_shift
 				SHIFT_POINTER(dst->memory, shift);
 			}
 		} else {
-			if(dst->references) {
+			if(dst->reference_offsets) {
 				// shift the point of pointers
-				SHIFT_POINTER(dst->references, shift);
+				SHIFT_POINTER(dst->reference_offsets, shift);
 
-				// shift the relocations themselves
-				for(j = 0; j < dst->reference_count; j++) {
-					SHIFT_POINTER(dst->references[j], instruction_shift);
-				}
+				// the offsets are relative to the instruction stream, so only its start needs to change
+				SHIFT_POINTER(dst->reference_base, instruction_shift);
 			}
 
 			if(separation) {
@@ -285,10 +472,15 @@ qb_storage * qb_create_storage_copy(qb_storage *base, intptr_t instruction_shift
 					} else {
 						if(dst->byte_count) {
 							// allocate new memory for the segment
-							int8_t *new_memory = emalloc(dst->byte_count);
+							int8_t *new_memory;
 							if(!reentrance) {
-								// forking--need to copy the contents over
+								// forking--the copy runs in a worker thread, so use memory it can enlarge 
+								// by itself, then copy the contents over
+								new_memory = malloc(dst->byte_count);
+								dst->flags |= QB_SEGMENT_THREAD_ALLOCATED;
 								memcpy(new_memory, dst->memory, dst->byte_count);
+							} else {
+								new_memory = emalloc(dst->byte_count);
 							}
 							qb_relocate_segment_memory(dst, new_memory);
 						}
@@ -326,20 +518,25 @@ void qb_copy_storage_contents(qb_storage *src_storage, qb_storage *dst_storage)
 	}
 }
 
-static int32_t qb_capture_dimensions_from_byte_count(uint32_t byte_count, qb_dimension_mappings *m, uint32_t dimension_index) {
-	uint32_t element_count = ELEMENT_COUNT(byte_count, m->dst_element_type);
-	uint32_t correct_byte_count = BYTE_COUNT(element_count, m->dst_element_type);
+static int32_t qb_capture_dimensions_from_byte_count(uint64_t byte_count, qb_dimension_mappings *m, uint32_t dimension_index) {
+	uint64_t element_count = ELEMENT_COUNT(byte_count, m->dst_element_type);
+	uint64_t correct_byte_count = BYTE_COUNT64(element_count, m->dst_element_type);
 
 	if(dimension_index + 1 > MAX_DIMENSION) {
 		qb_report_too_man_dimension_exception(0);
 		return FALSE;
 	}
+	// element counts are still 32-bit, though the number of bytes can exceed 4G
+	if(element_count > UINT32_MAX || byte_count > SIZE_MAX) {
+		qb_report_too_many_elements_exception(0, byte_count);
+		return FALSE;
+	}
 	// make sure the number of bytes is a multiple of the element size
 	if(byte_count != correct_byte_count) {
-		qb_report_binary_string_size_mismatch_exception(0, byte_count, m->dst_element_type);
+		qb_report_binary_string_size_mismatch_exception(0, (uint32_t) byte_count, m->dst_element_type);
 	}
 	if(m->src_dimensions[dimension_index] < element_count) {
-		m->src_dimensions[dimension_index] = element_count;
+		m->src_dimensions[dimension_index] = (uint32_t) element_count;
 	}
 	m->src_dimension_count = dimension_index + 1;
 	return TRUE;
@@ -383,6 +580,10 @@ static int32_t qb_capture_dimensions_from_string(zval *zvalue, qb_dimension_mapp
 	}
 }
 
+#include "qb_storage_file.c"
+#include "qb_storage_gd_image.c"
+#include "qb_storage_buffer.c"
+
 static int32_t qb_capture_dimensions_from_zval(zval *zvalue, qb_dimension_mappings *m, uint32_t dimension_index);
 
 static int32_t qb_capture_dimensions_from_array(zval *zarray, qb_dimension_mappings *m, uint32_t dimension_index) {
@@ -410,8 +611,12 @@ static int32_t qb_capture_dimensions_from_array(zval *zarray, qb_dimension_mappi
 
 static int32_t qb_capture_dimensions_from_object(zval *zobject, qb_dimension_mappings *m, uint32_t dimension_index) {
 	qb_index_alias_scheme *scheme = m->dst_index_alias_schemes[dimension_index];
+	qb_buffer_object *buffer = qb_get_buffer(zobject);
 	uint32_t i;
 	TSRMLS_FETCH();
+	if(buffer) {
+		return qb_capture_dimensions_from_buffer(buffer, m, dimension_index);
+	}
 	if(dimension_index + 1 > MAX_DIMENSION) {
 		qb_report_too_man_dimension_exception(0);
 		return FALSE;
@@ -445,11 +650,11 @@ static int32_t qb_capture_dimensions_from_object(zval *zobject, qb_dimension_map
 	return TRUE;
 }
 
-void qb_copy_wrap_around(int8_t *memory, uint32_t filled_byte_count, uint32_t required_byte_count) {
+void qb_copy_wrap_around(int8_t *memory, uint64_t filled_byte_count, uint64_t required_byte_count) {
 	if(filled_byte_count) {
 		while(filled_byte_count < required_byte_count) {
-			uint32_t gap = (required_byte_count - filled_byte_count);
-			uint32_t copy_count = (gap > filled_byte_count) ? filled_byte_count : gap;
+			uint64_t gap = (required_byte_count - filled_byte_count);
+			uint64_t copy_count = (gap > filled_byte_count) ? filled_byte_count : gap;
 			memcpy(memory + filled_byte_count, memory, copy_count);
 			filled_byte_count += copy_count;
 		}
@@ -458,9 +663,6 @@ void qb_copy_wrap_around(int8_t *memory, uint32_t filled_byte_count, uint32_t re
 	}
 }
 
-#include "qb_storage_file.c"
-#include "qb_storage_gd_image.c"
-
 static int32_t qb_capture_dimensions_from_zval(zval *zvalue, qb_dimension_mappings *m, uint32_t dimension_index) {
 	switch(Z_TYPE_P(zvalue)) {
 #ifdef IS_CONSTANT_ARRAY
@@ -727,7 +929,11 @@ static int32_t qb_copy_elements_from_object(zval *zobject, int8_t *dst_memory, q
 	uint32_t src_byte_count = src_dimension * src_element_byte_count;
 	uint32_t src_index = 0;
 	qb_index_alias_scheme *scheme = m->dst_index_alias_schemes[dimension_index];
+	qb_buffer_object *buffer = qb_get_buffer(zobject);
 	TSRMLS_FETCH();
+	if(buffer) {
+		return qb_copy_elements_from_buffer(buffer, dst_memory, m, dimension_index);
+	}
 	while(src_index < scheme->dimension) {
 		zval **p_element, *element = NULL;
 		zval *alias = qb_cstring_to_zval(scheme->aliases[src_index] TSRMLS_CC);
@@ -1080,8 +1286,12 @@ static int32_t qb_copy_elements_to_object(int8_t *src_memory, zval *zobject, qb_
 	uint32_t src_element_byte_count = BYTE_COUNT(src_element_count, m->src_element_type);
 	uint32_t dst_index = 0;
 	qb_index_alias_scheme *scheme = m->src_index_alias_schemes[dimension_index];
+	qb_buffer_object *buffer = qb_get_buffer(zobject);
 	TSRMLS_FETCH();
 
+	if(buffer) {
+		return qb_copy_elements_to_buffer(src_memory, buffer, m, dimension_index);
+	}
 	while(dst_index < scheme->dimension) {
 		zval **p_element, *element = NULL;
 		zval *alias = qb_cstring_to_zval(scheme->aliases[dst_index] TSRMLS_CC);
@@ -1526,6 +1736,57 @@ void qb_copy_element(uint32_t source_type, int8_t *restrict source_memory, uint3
 	}
 }
 
+static int32_t qb_probe_dimensions_from_array(zval *zarray, uint32_t *dimensions, uint32_t dimension_count, uint32_t dimension_index) {
+	HashTable *ht = Z_ARRVAL_P(zarray);
+	Bucket *p;
+	uint32_t dimension = ht->nNextFreeElement;
+	if(dimension_index + 1 > dimension_count) {
+		return FALSE;
+	}
+	if(dimensions[dimension_index] < dimension) {
+		dimensions[dimension_index] = dimension;
+	}
+	if(dimension_index + 1 == dimension_count) {
+		// the elements themselves are checked when the array is copied in
+		return TRUE;
+	}
+	for(p = ht->pListHead; p; p = p->pListNext) {
+		if((long) p->h >= 0 && !p->nKeyLength) {
+			zval **p_element = p->pData;
+			if(Z_TYPE_PP(p_element) != IS_ARRAY || !qb_probe_dimensions_from_array(*p_element, dimensions, dimension_count, dimension_index + 1)) {
+				return FALSE;
+			}
+		}
+	}
+	return TRUE;
+}
+
+int32_t qb_get_zval_dimensions(qb_storage *storage, qb_address *address, zval *zvalue, uint32_t *dimensions) {
+	// unlike qb_capture_dimensions_from_zval(), this doesn't report anything;
+	// values that can't be examined cheaply (strings, objects, resources) are simply rejected,
+	// and the innermost arrays are sized by their next free index without being walked
+	uint32_t i;
+	if(Z_TYPE_P(zvalue) != IS_ARRAY || address->dimension_count == 0 || address->index_alias_schemes) {
+		return FALSE;
+	}
+	for(i = 0; i < address->dimension_count; i++) {
+		dimensions[i] = 0;
+	}
+	if(!qb_probe_dimensions_from_array(zvalue, dimensions, address->dimension_count, 0)) {
+		return FALSE;
+	}
+	for(i = 0; i < address->dimension_count; i++) {
+		qb_address *dimension_address = address->dimension_addresses[i];
+		if(dimensions[i] == 0) {
+			return FALSE;
+		}
+		if(IS_IMMUTABLE(dimension_address) && VALUE_IN(storage, U32, dimension_address) != dimensions[i]) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
 int32_t qb_transfer_value_from_zval(qb_storage *storage, qb_address *address, zval *zvalue, int32_t transfer_flags) {
 	// determine the array's dimensions and check for out-of-bound condition
 	qb_dimension_mappings _mappings, *m = &_mappings;
@@ -1540,7 +1801,7 @@ int32_t qb_transfer_value_from_zval(qb_storage *storage, qb_address *address, zv
 	// if it's a variable-length array, adjust the size 
 	if(address->segment_selector >= QB_SELECTOR_ARRAY_START) {
 		uint32_t dst_element_count = m->dst_array_sizes[0];
-		uint32_t dst_byte_count = BYTE_COUNT(dst_element_count, m->dst_element_type);
+		uint64_t dst_byte_count = BYTE_COUNT64(dst_element_count, m->dst_element_type);
 		qb_memory_segment *dst_segment = &storage->segments[address->segment_selector];
 
 		// use memory from the source if possible
@@ -1581,6 +1842,14 @@ int32_t qb_transfer_value_from_zval(qb_storage *storage, qb_address *address, zv
 							return TRUE;
 						}
 					}
+				} else if(Z_TYPE_P(zvalue) == IS_OBJECT) {
+					qb_buffer_object *buffer = qb_get_buffer(zvalue);
+					if(buffer && buffer->current_allocation > 0 && STORAGE_TYPE_MATCH(buffer->type, m->dst_element_type)) {
+						// the buffer's memory came from emalloc() and can be enlarged in place like a string's
+						if(qb_connect_segment_to_memory(dst_segment, buffer->memory, dst_byte_count, buffer->current_allocation, FALSE)) {
+							return TRUE;
+						}
+					}
 				}
 			}
 		}
@@ -1613,7 +1882,7 @@ int32_t qb_transfer_value_from_storage_location(qb_storage *storage, qb_address
 
 	if(address->segment_selector >= QB_SELECTOR_ARRAY_START) {
 		uint32_t dst_element_count = m->dst_array_sizes[0];
-		uint32_t dst_byte_count = BYTE_COUNT(dst_element_count, m->dst_element_type);
+		uint64_t dst_byte_count = BYTE_COUNT64(dst_element_count, m->dst_element_type);
 		qb_memory_segment *dst_segment = &storage->segments[address->segment_selector];
 		if(transfer_flags & QB_TRANSFER_CAN_BORROW_MEMORY) {
 			if(src_address->segment_selector < QB_SELECTOR_ARRAY_START) {
@@ -1676,6 +1945,12 @@ int32_t qb_transfer_value_to_zval(qb_storage *storage, qb_address *address, zval
 			return TRUE;
 		} else if(src_segment->flags & QB_SEGMENT_BORROWED) {
 			int8_t *memory;
+			qb_buffer_object *buffer = qb_get_buffer(zvalue);
+			if(buffer) {
+				// the segment is using the buffer's memory--pick up any change in size
+				qb_attach_buffer_to_segment(buffer, src_segment, mappings);
+				return TRUE;
+			}
 			if(src_segment->byte_count == src_segment->current_allocation || (src_segment->current_allocation - src_segment->byte_count) > 1024) {
 				// allocate there's no room for null terminator or there's a lot of unused space
 				memory = erealloc(src_segment->memory, src_segment->byte_count + 1);
@@ -1711,7 +1986,7 @@ int32_t qb_transfer_value_to_storage_location(qb_storage *storage, qb_address *a
 	if(address->segment_selector >= QB_SELECTOR_ARRAY_START) {
 		qb_memory_segment *src_segment = &storage->segments[address->segment_selector];
 		uint32_t dst_element_count = m->dst_array_sizes[0];
-		uint32_t dst_byte_count = BYTE_COUNT(dst_element_count, m->dst_element_type);
+		uint64_t dst_byte_count = BYTE_COUNT64(dst_element_count, m->dst_element_type);
 		if(src_segment->flags & QB_SEGMENT_BORROWED) {
 			// nothing needs to happen
 			return TRUE;
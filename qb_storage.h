@@ -37,18 +37,26 @@ enum {
 	QB_SEGMENT_BORROWED				= 0x00000100,
 	QB_SEGMENT_MAPPED				= 0x00000200,
 	QB_SEGMENT_IMPORTED				= 0x00000400,
+	QB_SEGMENT_THREAD_ALLOCATED		= 0x00000800,
+	QB_SEGMENT_WINDOWED				= 0x00001000,
+	QB_SEGMENT_PAGE_ALLOCATED		= 0x00002000,
+	QB_SEGMENT_CHECKSUMMED			= 0x00004000,
 };
 
 struct qb_memory_segment {
 	int8_t *memory;
 	uint32_t flags;
-	uint32_t byte_count;						// number of bytes in this segment
-	uint32_t current_allocation;				// number of bytes allocated
+	uint64_t byte_count;						// number of bytes in this segment
+	uint64_t current_allocation;				// number of bytes allocated
 	php_stream *stream;							// memory-mapped file
 	qb_memory_segment *imported_segment;		// imported segment
 	qb_memory_segment *next_dependent;
-	uintptr_t **references;
+	int8_t *reference_base;						// start of the instruction stream
+	uint32_t *reference_offsets;				// offsets of pointers into this segment, relative to reference_base
 	uint32_t reference_count;
+	uint32_t reserved_byte_count;				// number of bytes to allocate when the segment first grows
+	uint32_t relocation_count;					// number of times the memory has moved
+	uint64_t checksum;							// checksum of the contents when received from PHP
 };
 
 enum {
@@ -262,21 +270,28 @@ typedef gdImage * gdImagePtr;
 
 gdImagePtr qb_get_gd_image(zval *resource);
 
-void qb_copy_wrap_around(int8_t *memory, uint32_t filled_byte_count, uint32_t required_byte_count);
+void qb_copy_wrap_around(int8_t *memory, uint64_t filled_byte_count, uint64_t required_byte_count);
 void qb_copy_elements(uint32_t source_type, int8_t *restrict source_memory, uint32_t source_count, uint32_t dest_type, int8_t *restrict dest_memory, uint32_t dest_count);
 void qb_copy_element(uint32_t source_type, int8_t *restrict source_memory, uint32_t dest_type, int8_t *restrict dest_memory);
 
+int32_t qb_get_zval_dimensions(qb_storage *storage, qb_address *address, zval *zvalue, uint32_t *dimensions);
 int32_t qb_transfer_value_from_zval(qb_storage *storage, qb_address *address, zval *zvalue, int32_t transfer_flags);
 int32_t qb_transfer_value_from_storage_location(qb_storage *storage, qb_address *address, qb_storage *src_storage, qb_address *src_address, uint32_t transfer_flags);
 int32_t qb_transfer_value_to_zval(qb_storage *storage, qb_address *address, zval *zvalue);
 int32_t qb_transfer_value_to_storage_location(qb_storage *storage, qb_address *address, qb_storage *dst_storage, qb_address *dst_address);
 
-void qb_allocate_segment_memory(qb_memory_segment *segment, uint32_t byte_count);
+void qb_allocate_segment_memory(qb_memory_segment *segment, uint64_t byte_count);
 void qb_release_segment(qb_memory_segment *segment);
-intptr_t qb_resize_segment(qb_memory_segment *segment, uint32_t new_size);
+intptr_t qb_resize_segment(qb_memory_segment *segment, uint64_t new_size);
+void qb_free_pages(int8_t *memory, uint64_t byte_count);
 
 void qb_import_segment(qb_memory_segment *segment, qb_memory_segment *other_segment);
 
+void qb_register_buffer_class(TSRMLS_D);
+
+void qb_set_file_window(php_stream *stream, uint64_t offset, uint64_t length TSRMLS_DC);
+void qb_prefetch_file_range(php_stream *stream, uint64_t offset, uint64_t length TSRMLS_DC);
+
 qb_storage * qb_create_storage_copy(qb_storage *base, intptr_t instruction_shift, int32_t reentrance);
 void qb_copy_storage_contents(qb_storage *src_storage, qb_storage *dst_storage);
 
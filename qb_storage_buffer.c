@@ -0,0 +1,302 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2012 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: Chung Leong <cleong@cal.berkeley.edu>                        |
+  +----------------------------------------------------------------------+
+*/
+
+/* $Id$ */
+
+typedef struct qb_buffer_object		qb_buffer_object;
+
+struct qb_buffer_object {
+	zend_object std;
+	qb_primitive_type type;
+	uint32_t dimension_count;
+	uint32_t dimensions[MAX_DIMENSION];
+	int8_t *memory;
+	uint64_t byte_count;
+	uint64_t current_allocation;
+};
+
+zend_class_entry *qb_buffer_ce = NULL;
+static zend_object_handlers qb_buffer_handlers;
+
+static qb_buffer_object * qb_get_buffer(zval *zobject) {
+	if(Z_TYPE_P(zobject) == IS_OBJECT && qb_buffer_ce) {
+		TSRMLS_FETCH();
+		if(instanceof_function(Z_OBJCE_P(zobject), qb_buffer_ce TSRMLS_CC)) {
+			return zend_object_store_get_object(zobject TSRMLS_CC);
+		}
+	}
+	return NULL;
+}
+
+static uint64_t qb_get_buffer_element_count(qb_buffer_object *buffer, uint32_t first_dimension) {
+	uint64_t element_count = 1;
+	uint32_t i;
+	for(i = first_dimension; i < buffer->dimension_count; i++) {
+		element_count *= buffer->dimensions[i];
+	}
+	return element_count;
+}
+
+static void qb_resize_buffer(qb_buffer_object *buffer, uint64_t byte_count) {
+	if(byte_count > buffer->current_allocation) {
+		uint64_t new_allocation = ALIGN_TO(byte_count, 1024);
+		buffer->memory = erealloc(buffer->memory, (size_t) new_allocation);
+		memset(buffer->memory + buffer->current_allocation, 0, (size_t) (new_allocation - buffer->current_allocation));
+		buffer->current_allocation = new_allocation;
+	} else if(byte_count < buffer->byte_count) {
+		// unused space is kept zeroed
+		memset(buffer->memory + byte_count, 0, (size_t) (buffer->byte_count - byte_count));
+	}
+	buffer->byte_count = byte_count;
+}
+
+static int32_t qb_capture_dimensions_from_buffer(qb_buffer_object *buffer, qb_dimension_mappings *m, uint32_t dimension_index) {
+	uint32_t i;
+	if(dimension_index + buffer->dimension_count > MAX_DIMENSION) {
+		qb_report_too_man_dimension_exception(0);
+		return FALSE;
+	}
+	for(i = 0; i < buffer->dimension_count; i++) {
+		if(m->src_dimensions[dimension_index + i] < buffer->dimensions[i]) {
+			m->src_dimensions[dimension_index + i] = buffer->dimensions[i];
+		}
+	}
+	if(m->src_dimension_count < dimension_index + buffer->dimension_count) {
+		m->src_dimension_count = dimension_index + buffer->dimension_count;
+	}
+	return TRUE;
+}
+
+static int32_t qb_copy_elements_from_buffer(qb_buffer_object *buffer, int8_t *dst_memory, qb_dimension_mappings *m, uint32_t dimension_index) {
+	uint32_t dst_element_count = (dimension_index < m->dst_dimension_count) ? m->dst_array_sizes[dimension_index] : 1;
+	uint32_t src_element_count = (uint32_t) qb_get_buffer_element_count(buffer, 0);
+	uint64_t dst_byte_count = BYTE_COUNT64(dst_element_count, m->dst_element_type);
+	uint64_t src_byte_count;
+
+	// the elements are converted if the types differ
+	qb_copy_elements(buffer->type, buffer->memory, src_element_count, m->dst_element_type, dst_memory, dst_element_count);
+	src_byte_count = BYTE_COUNT64(min(src_element_count, dst_element_count), m->dst_element_type);
+	if(src_byte_count < dst_byte_count) {
+		if(dimension_index == 0) {
+			qb_copy_wrap_around(dst_memory, src_byte_count, dst_byte_count);
+		} else {
+			memset(dst_memory + src_byte_count, 0, (size_t) (dst_byte_count - src_byte_count));
+		}
+	}
+	return TRUE;
+}
+
+static int32_t qb_copy_elements_to_buffer(int8_t *src_memory, qb_buffer_object *buffer, qb_dimension_mappings *m, uint32_t dimension_index) {
+	uint32_t src_element_count = (dimension_index < m->src_dimension_count) ? m->src_array_sizes[dimension_index] : 1;
+	uint32_t i;
+
+	// the buffer takes on the shape of the array, but keeps its element type
+	qb_resize_buffer(buffer, BYTE_COUNT64(src_element_count, buffer->type));
+	qb_copy_elements(m->src_element_type, src_memory, src_element_count, buffer->type, buffer->memory, src_element_count);
+	if(dimension_index < m->src_dimension_count) {
+		buffer->dimension_count = m->src_dimension_count - dimension_index;
+		for(i = 0; i < buffer->dimension_count; i++) {
+			buffer->dimensions[i] = m->src_dimensions[dimension_index + i];
+		}
+	} else {
+		buffer->dimension_count = 1;
+		buffer->dimensions[0] = 1;
+	}
+	return TRUE;
+}
+
+static void qb_attach_buffer_to_segment(qb_buffer_object *buffer, qb_memory_segment *segment, qb_dimension_mappings *m) {
+	// the memory might have been reallocated while the function held on to it
+	uint32_t i;
+	buffer->memory = segment->memory;
+	buffer->byte_count = segment->byte_count;
+	buffer->current_allocation = segment->current_allocation;
+	if(m->src_dimension_count > 0) {
+		buffer->dimension_count = m->src_dimension_count;
+		for(i = 0; i < m->src_dimension_count; i++) {
+			buffer->dimensions[i] = m->src_dimensions[i];
+		}
+	} else {
+		buffer->dimension_count = 1;
+		buffer->dimensions[0] = 1;
+	}
+}
+
+static void qb_free_buffer_object(void *object TSRMLS_DC) {
+	qb_buffer_object *buffer = object;
+	if(buffer->memory) {
+		efree(buffer->memory);
+	}
+	zend_object_std_dtor(&buffer->std TSRMLS_CC);
+	efree(buffer);
+}
+
+static zend_object_value qb_create_buffer_object(zend_class_entry *ce TSRMLS_DC) {
+	zend_object_value retval;
+	qb_buffer_object *buffer = ecalloc(1, sizeof(qb_buffer_object));
+	zend_object_std_init(&buffer->std, ce TSRMLS_CC);
+#if !ZEND_ENGINE_2_3 && !ZEND_ENGINE_2_2 && !ZEND_ENGINE_2_1
+	object_properties_init(&buffer->std, ce);
+#else
+	zend_hash_copy(buffer->std.properties, &ce->default_properties, (copy_ctor_func_t) zval_add_ref, NULL, sizeof(zval *));
+#endif
+	retval.handle = zend_objects_store_put(buffer, (zend_objects_store_dtor_t) zend_objects_destroy_object, qb_free_buffer_object, NULL TSRMLS_CC);
+	retval.handlers = &qb_buffer_handlers;
+	return retval;
+}
+
+static zend_object_value qb_clone_buffer_object(zval *zobject TSRMLS_DC) {
+	qb_buffer_object *buffer = zend_object_store_get_object(zobject TSRMLS_CC);
+	zend_object_value retval = qb_create_buffer_object(Z_OBJCE_P(zobject) TSRMLS_CC);
+	qb_buffer_object *clone = zend_object_store_get_object_by_handle(retval.handle TSRMLS_CC);
+	clone->type = buffer->type;
+	clone->dimension_count = buffer->dimension_count;
+	memcpy(clone->dimensions, buffer->dimensions, sizeof(buffer->dimensions));
+	if(buffer->current_allocation) {
+		clone->memory = emalloc((size_t) buffer->current_allocation);
+		memcpy(clone->memory, buffer->memory, (size_t) buffer->current_allocation);
+		clone->byte_count = buffer->byte_count;
+		clone->current_allocation = buffer->current_allocation;
+	}
+	zend_objects_clone_members(&clone->std, retval, &buffer->std, Z_OBJ_HANDLE_P(zobject) TSRMLS_CC);
+	return retval;
+}
+
+/* {{{ proto QBBuffer::__construct(string type, int dimension [, int ...])
+   Create a zero-filled buffer holding elements of the given type */
+static PHP_METHOD(QBBuffer, __construct)
+{
+	qb_buffer_object *buffer = zend_object_store_get_object(getThis() TSRMLS_CC);
+	zval ***args;
+	uint32_t arg_count = ZEND_NUM_ARGS(), i;
+	int32_t type = -1;
+
+	if(arg_count < 2) {
+		WRONG_PARAM_COUNT;
+	}
+	if(arg_count - 1 > MAX_DIMENSION) {
+		qb_report_too_man_dimension_exception(0);
+		return;
+	}
+	args = safe_emalloc(arg_count, sizeof(zval **), 0);
+	zend_get_parameters_array_ex(arg_count, args);
+
+	convert_to_string_ex(args[0]);
+	for(i = 0; i < QB_TYPE_COUNT; i++) {
+		if(strcmp(Z_STRVAL_PP(args[0]), type_names[i]) == 0) {
+			type = i;
+			break;
+		}
+	}
+	if(type == -1) {
+		qb_report_invalid_buffer_type_exception(0, Z_STRVAL_PP(args[0]));
+		efree(args);
+		return;
+	}
+	buffer->type = type;
+	buffer->dimension_count = arg_count - 1;
+	for(i = 1; i < arg_count; i++) {
+		convert_to_long_ex(args[i]);
+		buffer->dimensions[i - 1] = (Z_LVAL_PP(args[i]) > 0) ? (uint32_t) Z_LVAL_PP(args[i]) : 0;
+	}
+	efree(args);
+
+	qb_resize_buffer(buffer, BYTE_COUNT64(qb_get_buffer_element_count(buffer, 0), buffer->type));
+}
+/* }}} */
+
+/* {{{ proto string QBBuffer::getType()
+   Return the element type */
+static PHP_METHOD(QBBuffer, getType)
+{
+	qb_buffer_object *buffer = zend_object_store_get_object(getThis() TSRMLS_CC);
+	RETURN_STRING((char *) type_names[buffer->type], 1);
+}
+/* }}} */
+
+/* {{{ proto array QBBuffer::getDimensions()
+   Return the dimensions of the buffer */
+static PHP_METHOD(QBBuffer, getDimensions)
+{
+	qb_buffer_object *buffer = zend_object_store_get_object(getThis() TSRMLS_CC);
+	uint32_t i;
+	array_init(return_value);
+	for(i = 0; i < buffer->dimension_count; i++) {
+		add_next_index_long(return_value, buffer->dimensions[i]);
+	}
+}
+/* }}} */
+
+/* {{{ proto string QBBuffer::getData()
+   Return the contents of the buffer as a binary string */
+static PHP_METHOD(QBBuffer, getData)
+{
+	qb_buffer_object *buffer = zend_object_store_get_object(getThis() TSRMLS_CC);
+	if(buffer->byte_count > INT_MAX) {
+		// the length of a PHP string is an int
+		qb_report_buffer_too_large_exception(0, buffer->byte_count);
+		RETURN_FALSE;
+	} else if(buffer->byte_count) {
+		RETURN_STRINGL((char *) buffer->memory, (int) buffer->byte_count, 1);
+	} else {
+		RETURN_EMPTY_STRING();
+	}
+}
+/* }}} */
+
+/* {{{ proto void QBBuffer::setData(string data)
+   Replace the contents of the buffer, adjusting the first dimension to fit */
+static PHP_METHOD(QBBuffer, setData)
+{
+	qb_buffer_object *buffer = zend_object_store_get_object(getThis() TSRMLS_CC);
+	char *data;
+	int data_len;
+	uint64_t row_byte_count;
+
+	if(zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "s", &data, &data_len) == FAILURE) {
+		return;
+	}
+	row_byte_count = BYTE_COUNT64(qb_get_buffer_element_count(buffer, 1), buffer->type);
+	if(row_byte_count == 0 || data_len % row_byte_count != 0) {
+		qb_report_binary_string_size_mismatch_exception(0, data_len, buffer->type);
+		return;
+	}
+	buffer->dimensions[0] = (uint32_t) (data_len / row_byte_count);
+	qb_resize_buffer(buffer, data_len);
+	memcpy(buffer->memory, data, data_len);
+}
+/* }}} */
+
+static const zend_function_entry qb_buffer_methods[] = {
+	PHP_ME(QBBuffer,	__construct,	NULL,	ZEND_ACC_PUBLIC | ZEND_ACC_CTOR)
+	PHP_ME(QBBuffer,	getType,		NULL,	ZEND_ACC_PUBLIC)
+	PHP_ME(QBBuffer,	getDimensions,	NULL,	ZEND_ACC_PUBLIC)
+	PHP_ME(QBBuffer,	getData,		NULL,	ZEND_ACC_PUBLIC)
+	PHP_ME(QBBuffer,	setData,		NULL,	ZEND_ACC_PUBLIC)
+	{ NULL, NULL, NULL }
+};
+
+void qb_register_buffer_class(TSRMLS_D) {
+	zend_class_entry ce;
+	INIT_CLASS_ENTRY(ce, "QBBuffer", qb_buffer_methods);
+	ce.create_object = qb_create_buffer_object;
+	qb_buffer_ce = zend_register_internal_class(&ce TSRMLS_CC);
+
+	memcpy(&qb_buffer_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+	qb_buffer_handlers.clone_obj = qb_clone_buffer_object;
+}
@@ -32,8 +32,36 @@ static php_stream * qb_get_file_stream(zval *resource) {
 	return NULL;
 }
 
+void qb_set_file_window(php_stream *stream, uint64_t offset, uint64_t length TSRMLS_DC) {
+	QB_G(file_window_stream) = stream;
+	QB_G(file_window_offset) = offset;
+	QB_G(file_window_length) = length;
+}
+
+void qb_prefetch_file_range(php_stream *stream, uint64_t offset, uint64_t length TSRMLS_DC) {
+#if defined(POSIX_FADV_WILLNEED)
+	int fd;
+	if(php_stream_cast(stream, PHP_STREAM_AS_FD, (void **) &fd, FALSE) == SUCCESS) {
+		posix_fadvise(fd, (off_t) offset, (off_t) length, POSIX_FADV_WILLNEED);
+	}
+#endif
+}
+
+static void qb_get_file_range(php_stream *stream, uint64_t *p_offset, uint64_t *p_length TSRMLS_DC) {
+	if(stream == QB_G(file_window_stream)) {
+		// only part of the file is visible
+		*p_offset = QB_G(file_window_offset);
+		*p_length = QB_G(file_window_length);
+	} else {
+		php_stream_statbuf ssb;
+		php_stream_stat(stream, &ssb);
+		*p_offset = 0;
+		*p_length = (uint64_t) ssb.sb.st_size;
+	}
+}
+
 static int32_t qb_capture_dimensions_from_file(php_stream *stream, qb_dimension_mappings *m, uint32_t dimension_index) {
-	uint32_t byte_count;
+	uint64_t byte_count, file_offset, file_length;
 	int32_t need_utf8_decoding = FALSE;
 	TSRMLS_FETCH();
 	if(m->dst_address_flags & QB_ADDRESS_STRING) {
@@ -41,28 +69,28 @@ static int32_t qb_capture_dimensions_from_file(php_stream *stream, qb_dimension_
 			need_utf8_decoding = TRUE;
 		}
 	}
+	qb_get_file_range(stream, &file_offset, &file_length TSRMLS_CC);
 	if(need_utf8_decoding) {
 		// get the Unicode codepoint count
 		off_t position;
 		uint32_t cp_count = 0, read = 0, i, state = 0, codepoint;
 		uint8_t buffer[1024];
 		position = php_stream_tell(stream);
-		php_stream_seek(stream, 0, SEEK_SET);
+		php_stream_seek(stream, (off_t) file_offset, SEEK_SET);
 		do {
-			read = (uint32_t) php_stream_read(stream, (char *) buffer, sizeof(buffer));
+			uint32_t read_length = (file_length < sizeof(buffer)) ? (uint32_t) file_length : sizeof(buffer);
+			read = (uint32_t) php_stream_read(stream, (char *) buffer, read_length);
 			for(i = 0; i < read; i++) {
 				if(!decode(&state, &codepoint, buffer[i])) {
 					cp_count++;
 				}
 			}
+			file_length -= read;
 		} while(read == sizeof(buffer));
 		php_stream_seek(stream, position, SEEK_SET);
-		byte_count = BYTE_COUNT(cp_count, m->dst_element_type);
+		byte_count = BYTE_COUNT64(cp_count, m->dst_element_type);
 	} else {
-		// get the file size
-		php_stream_statbuf ssb;
-		php_stream_stat(stream, &ssb);
-		byte_count = (uint32_t) ssb.sb.st_size;
+		byte_count = file_length;
 	}
 	return qb_capture_dimensions_from_byte_count(byte_count, m, dimension_index);
 }
@@ -82,7 +110,7 @@ static int32_t qb_copy_elements_to_file(int8_t *src_memory, zval *zstream, php_s
 	}
 
 	position = php_stream_tell(stream);
-	php_stream_seek(stream, 0, SEEK_SET);
+	php_stream_seek(stream, (stream == QB_G(file_window_stream)) ? (off_t) QB_G(file_window_offset) : 0, SEEK_SET);
 	if(need_utf8_encoding) {
 		uint32_t i = 0, j;
 		uint8_t buffer[1024];
@@ -110,7 +138,9 @@ static int32_t qb_copy_elements_to_file(int8_t *src_memory, zval *zstream, php_s
 		byte_written = php_stream_write(stream, (char *) src_memory, src_byte_count);
 	}
 	php_stream_seek(stream, position, SEEK_SET);
-	php_stream_truncate_set_size(stream, src_byte_count);
+	if(stream != QB_G(file_window_stream)) {
+		php_stream_truncate_set_size(stream, src_byte_count);
+	}
 	if(byte_written != src_byte_count) {
 		qb_report_file_write_error(0, src_byte_count, stream);
 		return FALSE;
@@ -120,7 +150,7 @@ static int32_t qb_copy_elements_to_file(int8_t *src_memory, zval *zstream, php_s
 
 static int32_t qb_copy_elements_from_file(php_stream *stream, int8_t *dst_memory, qb_dimension_mappings *m, uint32_t dimension_index) {
 	off_t position;
-	uint32_t src_byte_count;
+	uint64_t src_byte_count, file_offset, file_length;
 	uint32_t dst_element_count = (dimension_index < m->dst_dimension_count) ? m->dst_array_sizes[dimension_index] : 1;
 	int32_t need_utf8_decoding = FALSE;
 	TSRMLS_FETCH();
@@ -131,13 +161,16 @@ static int32_t qb_copy_elements_from_file(php_stream *stream, int8_t *dst_memory
 		}
 	}
 
+	qb_get_file_range(stream, &file_offset, &file_length TSRMLS_CC);
 	position = php_stream_tell(stream);
-	php_stream_seek(stream, 0, SEEK_SET);
+	php_stream_seek(stream, (off_t) file_offset, SEEK_SET);
 	if(need_utf8_decoding) {
 		uint32_t read = 0, i, j = 0, state = 0, codepoint;
 		uint8_t buffer[1024];
 		do {
-			read = (uint32_t) php_stream_read(stream, (char *) buffer, sizeof(buffer));
+			uint32_t read_length = (file_length < sizeof(buffer)) ? (uint32_t) file_length : sizeof(buffer);
+			read = (uint32_t) php_stream_read(stream, (char *) buffer, read_length);
+			file_length -= read;
 			if(STORAGE_TYPE_MATCH(m->dst_element_type, QB_TYPE_I16)) {
 				uint16_t *dst_elements = (uint16_t *) dst_memory;
 				for(i = 0; i < read; i++) {
@@ -157,8 +190,9 @@ static int32_t qb_copy_elements_from_file(php_stream *stream, int8_t *dst_memory
 			}
 		} while(read == sizeof(buffer));
 	} else {
-		uint32_t dst_byte_count = BYTE_COUNT(dst_element_count, m->dst_element_type);
-		src_byte_count = (uint32_t) php_stream_read(stream, (char *) dst_memory, dst_byte_count);
+		uint64_t dst_byte_count = BYTE_COUNT64(dst_element_count, m->dst_element_type);
+		uint64_t read_length = (file_length < dst_byte_count) ? file_length : dst_byte_count;
+		src_byte_count = php_stream_read(stream, (char *) dst_memory, (size_t) read_length);
 		php_stream_seek(stream, position, SEEK_SET);
 		if(src_byte_count < dst_byte_count) {
 			if(dimension_index == 0) {
@@ -172,18 +206,36 @@ static int32_t qb_copy_elements_from_file(php_stream *stream, int8_t *dst_memory
 	return TRUE;
 }
 
-static void * qb_map_file_to_memory(php_stream *stream, uint32_t byte_count, int32_t write_access TSRMLS_DC) {
-	if(QB_G(allow_memory_map)) {
+static void * qb_map_file_to_memory(php_stream *stream, uint64_t byte_count, int32_t write_access TSRMLS_DC) {
+	if(QB_G(allow_memory_map) && byte_count <= SIZE_MAX) {
 		php_stream_mmap_range range;
+		if(stream == QB_G(file_window_stream)) {
+			// map only the current window; the file isn't enlarged
+			range.length = (size_t) byte_count;
+			range.offset = (size_t) QB_G(file_window_offset);
+			range.mode = (write_access) ? PHP_STREAM_MAP_MODE_SHARED_READWRITE : PHP_STREAM_MAP_MODE_SHARED_READONLY;
+			range.mapped = NULL;
+			if(byte_count > QB_G(file_window_length)) {
+				return NULL;
+			}
+			if(php_stream_set_option(stream, PHP_STREAM_OPTION_MMAP_API, PHP_STREAM_MMAP_MAP_RANGE, &range) == PHP_STREAM_OPTION_RETURN_OK) {
+#if defined(MADV_SEQUENTIAL)
+				// the window is most likely scanned from start to end
+				madvise(range.mapped, range.length, MADV_SEQUENTIAL);
+#endif
+				return (int8_t *) range.mapped;
+			}
+			return NULL;
+		}
 		if(write_access) {
 			// make sure the file is large enough
 			php_stream_statbuf ssb;
 			php_stream_stat(stream, &ssb);
-			if(byte_count > (uint32_t) ssb.sb.st_size) {
-				php_stream_truncate_set_size(stream, byte_count);
+			if(byte_count > (uint64_t) ssb.sb.st_size) {
+				php_stream_truncate_set_size(stream, (size_t) byte_count);
 			}
 		}
-		range.length = byte_count;
+		range.length = (size_t) byte_count;
 		range.offset = 0;
 		range.mode = (write_access) ? PHP_STREAM_MAP_MODE_SHARED_READWRITE : PHP_STREAM_MAP_MODE_SHARED_READONLY;
 		range.mapped = NULL;
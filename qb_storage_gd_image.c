@@ -18,6 +18,10 @@
 
 /* $Id$ */
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 typedef enum qb_pixel_format qb_pixel_format;
 
 enum qb_pixel_format {
@@ -211,12 +215,84 @@ static int32_t qb_capture_dimensions_from_image(gdImagePtr image, qb_dimension_m
 	return TRUE;
 }
 
+#ifdef __SSE2__
+static zend_always_inline void qb_unpack_gd_pixels_F32(__m128i px, __m128 *r, __m128 *g, __m128 *b, __m128 *a) {
+	__m128i channel_mask = _mm_set1_epi32(0xFF);
+	__m128 color_scale = _mm_set1_ps(1.0f / gdRedMax);
+	*r = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 16), channel_mask)), color_scale);
+	*g = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 8), channel_mask)), color_scale);
+	*b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(px, channel_mask)), color_scale);
+	if(a) {
+		__m128i alpha = _mm_and_si128(_mm_srli_epi32(px, 24), _mm_set1_epi32(gdAlphaMax));
+		*a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_set1_epi32(gdAlphaTransparent), alpha)), _mm_set1_ps(1.0f / gdAlphaMax));
+	}
+}
+
+static zend_always_inline __m128 qb_calculate_gd_luminance_F32(__m128 r, __m128 g, __m128 b) {
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(0.299f)), _mm_mul_ps(g, _mm_set1_ps(0.587f))), _mm_mul_ps(b, _mm_set1_ps(0.114f)));
+}
+
+static zend_always_inline __m128i qb_pack_gd_pixels_F32(__m128 r, __m128 g, __m128 b, __m128 a) {
+	// max_ps() returns the second operand when the first is NaN, so NaN becomes zero like in qb_clamp_float32()
+	__m128 zero = _mm_setzero_ps();
+	__m128 color_max = _mm_set1_ps((float32_t) gdRedMax);
+	__m128 alpha_max = _mm_set1_ps((float32_t) gdAlphaMax);
+	__m128i ir = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(r, color_max), zero), color_max));
+	__m128i ig = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(g, color_max), zero), color_max));
+	__m128i ib = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(b, color_max), zero), color_max));
+	__m128i ia = _mm_sub_epi32(_mm_set1_epi32(gdAlphaTransparent), _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(a, alpha_max), zero), alpha_max)));
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ia, 24), _mm_slli_epi32(ir, 16)), _mm_or_si128(_mm_slli_epi32(ig, 8), ib));
+}
+
+static zend_always_inline void qb_unpack_gd_pixels_F64(__m128i px, __m128d *r, __m128d *g, __m128d *b, __m128d *a) {
+	// only the lower two pixels are unpacked
+	__m128i channel_mask = _mm_set1_epi32(0xFF);
+	__m128d color_scale = _mm_set1_pd(1.0 / gdRedMax);
+	*r = _mm_mul_pd(_mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(px, 16), channel_mask)), color_scale);
+	*g = _mm_mul_pd(_mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(px, 8), channel_mask)), color_scale);
+	*b = _mm_mul_pd(_mm_cvtepi32_pd(_mm_and_si128(px, channel_mask)), color_scale);
+	if(a) {
+		__m128i alpha = _mm_and_si128(_mm_srli_epi32(px, 24), _mm_set1_epi32(gdAlphaMax));
+		*a = _mm_mul_pd(_mm_cvtepi32_pd(_mm_sub_epi32(_mm_set1_epi32(gdAlphaTransparent), alpha)), _mm_set1_pd(1.0 / gdAlphaMax));
+	}
+}
+
+static zend_always_inline __m128d qb_calculate_gd_luminance_F64(__m128d r, __m128d g, __m128d b) {
+	return _mm_add_pd(_mm_add_pd(_mm_mul_pd(r, _mm_set1_pd(0.299)), _mm_mul_pd(g, _mm_set1_pd(0.587))), _mm_mul_pd(b, _mm_set1_pd(0.114)));
+}
+
+static zend_always_inline __m128i qb_pack_gd_pixels_F64(__m128d r, __m128d g, __m128d b, __m128d a) {
+	// the two pixels end up in the lower half
+	__m128d zero = _mm_setzero_pd();
+	__m128d color_max = _mm_set1_pd((float64_t) gdRedMax);
+	__m128d alpha_max = _mm_set1_pd((float64_t) gdAlphaMax);
+	__m128i ir = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(r, color_max), zero), color_max));
+	__m128i ig = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(g, color_max), zero), color_max));
+	__m128i ib = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(b, color_max), zero), color_max));
+	__m128i ia = _mm_sub_epi32(_mm_set1_epi32(gdAlphaTransparent), _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(a, alpha_max), zero), alpha_max)));
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ia, 24), _mm_slli_epi32(ir, 16)), _mm_or_si128(_mm_slli_epi32(ig, 8), ib));
+}
+#endif
+
 static void qb_copy_rgba_pixel_from_gd_image_scanline_F32(void *param1, void *param2, int param3) {
 	float32_t *p = param1;
 	int *tpixels = param2, tpixel;
-	uint32_t width = (uint32_t) param3, i;
-
-	for(i = 0; i < width; i++) {
+	uint32_t width = (uint32_t) param3, i = 0;
+
+#ifdef __SSE2__
+	// unpack four pixels at a time, then transpose the channels into RGBA order
+	for(; i + 4 <= width; i += 4) {
+		__m128 r, g, b, a;
+		qb_unpack_gd_pixels_F32(_mm_loadu_si128((__m128i *) &tpixels[i]), &r, &g, &b, &a);
+		_MM_TRANSPOSE4_PS(r, g, b, a);
+		_mm_storeu_ps(p + 0, r);
+		_mm_storeu_ps(p + 4, g);
+		_mm_storeu_ps(p + 8, b);
+		_mm_storeu_ps(p + 12, a);
+		p += 16;
+	}
+#endif
+	for(; i < width; i++) {
 		tpixel = tpixels[i];
 		p[0] = ((float32_t) gdTrueColorGetRed(tpixel) * (1.0f / gdRedMax));
 		p[1] = ((float32_t) gdTrueColorGetGreen(tpixel) * (1.0f / gdGreenMax));
@@ -229,9 +305,24 @@ static void qb_copy_rgba_pixel_from_gd_image_scanline_F32(void *param1, void *pa
 static void qb_copy_rgb_pixel_from_gd_image_scanline_F32(void *param1, void *param2, int param3) {
 	float32_t *p = param1;
 	int *tpixels = param2, tpixel;
-	uint32_t width = (uint32_t) param3, i;
-
-	for(i = 0; i < width; i++) {
+	uint32_t width = (uint32_t) param3, i = 0;
+
+#ifdef __SSE2__
+	// each store writes one float past the pixel, which the next store overwrites
+	// stop while there's still a pixel left so nothing is written beyond the scanline
+	for(; i + 5 <= width; i += 4) {
+		__m128 r, g, b, a;
+		qb_unpack_gd_pixels_F32(_mm_loadu_si128((__m128i *) &tpixels[i]), &r, &g, &b, NULL);
+		a = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(r, g, b, a);
+		_mm_storeu_ps(p + 0, r);
+		_mm_storeu_ps(p + 3, g);
+		_mm_storeu_ps(p + 6, b);
+		_mm_storeu_ps(p + 9, a);
+		p += 12;
+	}
+#endif
+	for(; i < width; i++) {
 		tpixel = tpixels[i];
 		p[0] = ((float32_t) gdTrueColorGetRed(tpixel) * (1.0f / gdRedMax));
 		p[1] = ((float32_t) gdTrueColorGetGreen(tpixel) * (1.0f / gdGreenMax));
@@ -243,9 +334,19 @@ static void qb_copy_rgb_pixel_from_gd_image_scanline_F32(void *param1, void *par
 static void qb_copy_ya_pixel_from_gd_image_scanline_F32(void *param1, void *param2, int param3) {
 	float32_t *p = param1;
 	int *tpixels = param2, tpixel;
-	uint32_t width = (uint32_t) param3, i;
-
-	for(i = 0; i < width; i++) {
+	uint32_t width = (uint32_t) param3, i = 0;
+
+#ifdef __SSE2__
+	for(; i + 4 <= width; i += 4) {
+		__m128 r, g, b, a, y;
+		qb_unpack_gd_pixels_F32(_mm_loadu_si128((__m128i *) &tpixels[i]), &r, &g, &b, &a);
+		y = qb_calculate_gd_luminance_F32(r, g, b);
+		_mm_storeu_ps(p + 0, _mm_unpacklo_ps(y, a));
+		_mm_storeu_ps(p + 4, _mm_unpackhi_ps(y, a));
+		p += 8;
+	}
+#endif
+	for(; i < width; i++) {
 		tpixel = tpixels[i];
 		p[0] = ((float32_t) gdTrueColorGetRed(tpixel) * (1.0f / gdRedMax)) * 0.299f
 			 + ((float32_t) gdTrueColorGetGreen(tpixel) * (1.0f / gdGreenMax)) * 0.587f
@@ -258,9 +359,17 @@ static void qb_copy_ya_pixel_from_gd_image_scanline_F32(void *param1, void *para
 static void qb_copy_y_pixel_from_gd_image_scanline_F32(void *param1, void *param2, int param3) {
 	float32_t *p = param1;
 	int *tpixels = param2, tpixel;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	for(; i + 4 <= width; i += 4) {
+		__m128 r, g, b;
+		qb_unpack_gd_pixels_F32(_mm_loadu_si128((__m128i *) &tpixels[i]), &r, &g, &b, NULL);
+		_mm_storeu_ps(p, qb_calculate_gd_luminance_F32(r, g, b));
+		p += 4;
+	}
+#endif
+	for(; i < width; i++) {
 		tpixel = tpixels[i];
 		p[0] = ((float32_t) gdTrueColorGetRed(tpixel) * (1.0f / gdRedMax)) * 0.299f
 			 + ((float32_t) gdTrueColorGetGreen(tpixel) * (1.0f / gdGreenMax)) * 0.587f
@@ -272,9 +381,21 @@ static void qb_copy_y_pixel_from_gd_image_scanline_F32(void *param1, void *param
 static void qb_copy_rgba_pixel_from_gd_image_scanline_F64(void *param1, void *param2, int param3) {
 	float64_t *p = param1;
 	int *tpixels = param2, tpixel;
-	uint32_t width = (uint32_t) param3, i;
-
-	for(i = 0; i < width; i++) {
+	uint32_t width = (uint32_t) param3, i = 0;
+
+#ifdef __SSE2__
+	// two pixels at a time
+	for(; i + 2 <= width; i += 2) {
+		__m128d r, g, b, a;
+		qb_unpack_gd_pixels_F64(_mm_loadl_epi64((__m128i *) &tpixels[i]), &r, &g, &b, &a);
+		_mm_storeu_pd(p + 0, _mm_unpacklo_pd(r, g));
+		_mm_storeu_pd(p + 2, _mm_unpacklo_pd(b, a));
+		_mm_storeu_pd(p + 4, _mm_unpackhi_pd(r, g));
+		_mm_storeu_pd(p + 6, _mm_unpackhi_pd(b, a));
+		p += 8;
+	}
+#endif
+	for(; i < width; i++) {
 		tpixel = tpixels[i];
 		p[0] = ((float64_t) gdTrueColorGetRed(tpixel) * (1.0 / gdRedMax));
 		p[1] = ((float64_t) gdTrueColorGetGreen(tpixel) * (1.0 / gdGreenMax));
@@ -287,9 +408,20 @@ static void qb_copy_rgba_pixel_from_gd_image_scanline_F64(void *param1, void *pa
 static void qb_copy_rgb_pixel_from_gd_image_scanline_F64(void *param1, void *param2, int param3) {
 	float64_t *p = param1;
 	int *tpixels = param2, tpixel;
-	uint32_t width = (uint32_t) param3, i;
-
-	for(i = 0; i < width; i++) {
+	uint32_t width = (uint32_t) param3, i = 0;
+
+#ifdef __SSE2__
+	for(; i + 2 <= width; i += 2) {
+		__m128d r, g, b;
+		qb_unpack_gd_pixels_F64(_mm_loadl_epi64((__m128i *) &tpixels[i]), &r, &g, &b, NULL);
+		_mm_storeu_pd(p + 0, _mm_unpacklo_pd(r, g));
+		_mm_store_sd(p + 2, b);
+		_mm_storeu_pd(p + 3, _mm_unpackhi_pd(r, g));
+		_mm_storeh_pd(p + 5, b);
+		p += 6;
+	}
+#endif
+	for(; i < width; i++) {
 		tpixel = tpixels[i];
 		p[0] = ((float64_t) gdTrueColorGetRed(tpixel) * (1.0 / gdRedMax));
 		p[1] = ((float64_t) gdTrueColorGetGreen(tpixel) * (1.0 / gdGreenMax));
@@ -301,9 +433,19 @@ static void qb_copy_rgb_pixel_from_gd_image_scanline_F64(void *param1, void *par
 static void qb_copy_ya_pixel_from_gd_image_scanline_F64(void *param1, void *param2, int param3) {
 	float64_t *p = param1;
 	int *tpixels = param2, tpixel;
-	uint32_t width = (uint32_t) param3, i;
-
-	for(i = 0; i < width; i++) {
+	uint32_t width = (uint32_t) param3, i = 0;
+
+#ifdef __SSE2__
+	for(; i + 2 <= width; i += 2) {
+		__m128d r, g, b, a, y;
+		qb_unpack_gd_pixels_F64(_mm_loadl_epi64((__m128i *) &tpixels[i]), &r, &g, &b, &a);
+		y = qb_calculate_gd_luminance_F64(r, g, b);
+		_mm_storeu_pd(p + 0, _mm_unpacklo_pd(y, a));
+		_mm_storeu_pd(p + 2, _mm_unpackhi_pd(y, a));
+		p += 4;
+	}
+#endif
+	for(; i < width; i++) {
 		tpixel = tpixels[i];
 		p[0] = ((float64_t) gdTrueColorGetRed(tpixel) * (1.0 / gdRedMax)) * 0.299
 			 + ((float64_t) gdTrueColorGetGreen(tpixel) * (1.0 / gdGreenMax)) * 0.587
@@ -316,9 +458,17 @@ static void qb_copy_ya_pixel_from_gd_image_scanline_F64(void *param1, void *para
 static void qb_copy_y_pixel_from_gd_image_scanline_F64(void *param1, void *param2, int param3) {
 	float64_t *p = param1;
 	int *tpixels = param2, tpixel;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	for(; i + 2 <= width; i += 2) {
+		__m128d r, g, b;
+		qb_unpack_gd_pixels_F64(_mm_loadl_epi64((__m128i *) &tpixels[i]), &r, &g, &b, NULL);
+		_mm_storeu_pd(p, qb_calculate_gd_luminance_F64(r, g, b));
+		p += 2;
+	}
+#endif
+	for(; i < width; i++) {
 		tpixel = tpixels[i];
 		p[0] = ((float64_t) gdTrueColorGetRed(tpixel) * (1.0 / gdRedMax)) * 0.299
 			 + ((float64_t) gdTrueColorGetGreen(tpixel) * (1.0 / gdGreenMax)) * 0.587
@@ -327,6 +477,69 @@ static void qb_copy_y_pixel_from_gd_image_scanline_F64(void *param1, void *param
 	}
 }
 
+// scanlines are handed to the worker threads in batches of about this many bytes
+#define QB_GD_IMAGE_CHUNK_SIZE		65536
+
+typedef struct qb_gd_image_chunk qb_gd_image_chunk;
+
+struct qb_gd_image_chunk {
+	qb_thread_proc proc;
+	int8_t *memory;
+	int **tpixels;
+	uint32_t width;
+	uint32_t stride;
+	uint32_t row_count;
+};
+
+static void qb_copy_gd_image_chunk(void *param1, void *param2, int param3) {
+	qb_gd_image_chunk *chunk = param1;
+	int8_t *p = chunk->memory;
+	uint32_t i;
+
+	for(i = 0; i < chunk->row_count; i++) {
+		chunk->proc(p, chunk->tpixels[i], chunk->width);
+		p += chunk->stride;
+	}
+}
+
+static void qb_copy_gd_image_scanlines(qb_thread_proc proc, int8_t *memory, uint32_t stride, gdImagePtr image) {
+	uint32_t height = image->sy;
+	uint32_t rows_per_chunk = (stride > 0 && stride < QB_GD_IMAGE_CHUNK_SIZE) ? QB_GD_IMAGE_CHUNK_SIZE / stride : 1;
+	uint32_t chunk_count = (height + rows_per_chunk - 1) / rows_per_chunk;
+	uint32_t i;
+
+	if(stride == 0) {
+		return;
+	}
+	if(chunk_count > 1) {
+		qb_task_group *group = qb_allocate_task_group(chunk_count, sizeof(qb_gd_image_chunk) * chunk_count);
+		qb_gd_image_chunk *chunks = group->extra_memory;
+		for(i = 0; i < chunk_count; i++) {
+			qb_gd_image_chunk *chunk = &chunks[i];
+			uint32_t row_index = i * rows_per_chunk;
+			chunk->proc = proc;
+			chunk->memory = memory + row_index * stride;
+			chunk->tpixels = image->tpixels + row_index;
+			chunk->width = image->sx;
+			chunk->stride = stride;
+			chunk->row_count = (row_index + rows_per_chunk <= height) ? rows_per_chunk : height - row_index;
+			qb_add_task(group, qb_copy_gd_image_chunk, chunk, NULL, 0);
+		}
+		qb_run_task_group(group, FALSE);
+		qb_free_task_group(group);
+	} else if(chunk_count == 1) {
+		// not worth waking up the workers
+		qb_gd_image_chunk chunk;
+		chunk.proc = proc;
+		chunk.memory = memory;
+		chunk.tpixels = image->tpixels;
+		chunk.width = image->sx;
+		chunk.stride = stride;
+		chunk.row_count = height;
+		qb_copy_gd_image_chunk(&chunk, NULL, 0);
+	}
+}
+
 static int32_t qb_copy_elements_from_gd_image(gdImagePtr image, int8_t *dst_memory, qb_dimension_mappings *m, uint32_t dimension_index) {
 	uint32_t i, j;
 	qb_pixel_format pixel_format = qb_get_compatible_pixel_format(m->dst_dimension_count - dimension_index, m->dst_dimensions[m->dst_dimension_count - 1], m->dst_element_type, image->trueColor);
@@ -347,10 +560,8 @@ static int32_t qb_copy_elements_from_gd_image(gdImagePtr image, int8_t *dst_memo
 				int32_t *p = (int32_t *) dst_memory;
 
 				for(i = 0; i < (uint32_t) image->sy; i++) {
-					for(j = 0; j < (uint32_t) image->sx; j++) {
-						p[0] = gdImageTrueColorPixel(image, j, i);
-						p += 1;
-					}
+					memcpy(p, image->tpixels[i], image->sx * sizeof(int32_t));
+					p += image->sx;
 					if((uint32_t) image->sx < dst_width) {
 						memset(p, 0, (dst_width - image->sx) * sizeof(int32_t));
 						p += (dst_width - image->sx);
@@ -397,21 +608,20 @@ static int32_t qb_copy_elements_from_gd_image(gdImagePtr image, int8_t *dst_memo
 		}
 
 		if(proc) {
+			uint32_t stride = (((uint32_t) image->sx < dst_width) ? dst_width : image->sx) * pixel_size;
 			int8_t *p = dst_memory;
-			qb_task_group *group = qb_allocate_task_group(image->sy, 0);
-			for(i = 0; i < (uint32_t) image->sy; i++) {
-				qb_add_task(group, proc, p, image->tpixels[i], image->sx);
-				p += image->sx * pixel_size;
-				if((uint32_t) image->sx < dst_width) {
-					memset(p, 0, (dst_width - image->sx) * pixel_size);
-					p += (dst_width - image->sx) * pixel_size;
+			if((uint32_t) image->sx < dst_width) {
+				for(i = 0; i < (uint32_t) image->sy; i++) {
+					memset(p + image->sx * pixel_size, 0, (dst_width - image->sx) * pixel_size);
+					p += stride;
 				}
+			} else {
+				p += image->sy * stride;
 			}
 			if(src_pixel_count < dst_pixel_count) {
 				memset(p, 0, (dst_pixel_count - src_pixel_count) * pixel_size);
 			}
-			qb_run_task_group(group, FALSE);
-			qb_free_task_group(group);
+			qb_copy_gd_image_scanlines(proc, dst_memory, stride, image);
 		}
 	} else {
 		switch(pixel_type) {
@@ -442,10 +652,22 @@ static int32_t qb_copy_elements_from_gd_image(gdImagePtr image, int8_t *dst_memo
 static void qb_copy_rgba_pixel_to_gd_image_scanline_F32(void *param1, void *param2, int param3) {
 	float32_t *p = param1;
 	int *tpixels = param2;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 	int r, g, b, a;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	// transpose four pixels into channels, then scale, clamp, and pack them
+	for(; i + 4 <= width; i += 4) {
+		__m128 vr = _mm_loadu_ps(p + 0);
+		__m128 vg = _mm_loadu_ps(p + 4);
+		__m128 vb = _mm_loadu_ps(p + 8);
+		__m128 va = _mm_loadu_ps(p + 12);
+		_MM_TRANSPOSE4_PS(vr, vg, vb, va);
+		_mm_storeu_si128((__m128i *) &tpixels[i], qb_pack_gd_pixels_F32(vr, vg, vb, va));
+		p += 16;
+	}
+#endif
+	for(; i < width; i++) {
 		r = qb_clamp_float32(p[0], gdRedMax);
 		g = qb_clamp_float32(p[1], gdGreenMax);
 		b = qb_clamp_float32(p[2], gdBlueMax);
@@ -458,10 +680,22 @@ static void qb_copy_rgba_pixel_to_gd_image_scanline_F32(void *param1, void *para
 static void qb_copy_rgb_pixel_to_gd_image_scanline_F32(void *param1, void *param2, int param3) {
 	float32_t *p = param1;
 	int *tpixels = param2;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 	int r, g, b;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	// the last load reads one float past the fourth pixel, so stop while there's still a pixel left
+	for(; i + 5 <= width; i += 4) {
+		__m128 vr = _mm_loadu_ps(p + 0);
+		__m128 vg = _mm_loadu_ps(p + 3);
+		__m128 vb = _mm_loadu_ps(p + 6);
+		__m128 va = _mm_loadu_ps(p + 9);
+		_MM_TRANSPOSE4_PS(vr, vg, vb, va);
+		_mm_storeu_si128((__m128i *) &tpixels[i], qb_pack_gd_pixels_F32(vr, vg, vb, _mm_set1_ps(1.0f)));
+		p += 12;
+	}
+#endif
+	for(; i < width; i++) {
 		r = qb_clamp_float32(p[0], gdRedMax);
 		g = qb_clamp_float32(p[1], gdGreenMax);
 		b = qb_clamp_float32(p[2], gdBlueMax);
@@ -473,10 +707,20 @@ static void qb_copy_rgb_pixel_to_gd_image_scanline_F32(void *param1, void *param
 static void qb_copy_ya_pixel_to_gd_image_scanline_F32(void *param1, void *param2, int param3) {
 	float32_t *p = param1;
 	int *tpixels = param2;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 	int r, a;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	for(; i + 4 <= width; i += 4) {
+		__m128 v0 = _mm_loadu_ps(p + 0);
+		__m128 v1 = _mm_loadu_ps(p + 4);
+		__m128 vy = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 va = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+		_mm_storeu_si128((__m128i *) &tpixels[i], qb_pack_gd_pixels_F32(vy, vy, vy, va));
+		p += 8;
+	}
+#endif
+	for(; i < width; i++) {
 		r = qb_clamp_float32(p[0], gdRedMax);
 		a = gdAlphaTransparent - qb_clamp_float32(p[1], gdAlphaMax);
 		tpixels[i] = gdTrueColorAlpha(r, r, r, a);
@@ -487,10 +731,17 @@ static void qb_copy_ya_pixel_to_gd_image_scanline_F32(void *param1, void *param2
 static void qb_copy_y_pixel_to_gd_image_scanline_F32(void *param1, void *param2, int param3) {
 	float32_t *p = param1;
 	int *tpixels = param2;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 	int r;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	for(; i + 4 <= width; i += 4) {
+		__m128 vy = _mm_loadu_ps(p);
+		_mm_storeu_si128((__m128i *) &tpixels[i], qb_pack_gd_pixels_F32(vy, vy, vy, _mm_set1_ps(1.0f)));
+		p += 4;
+	}
+#endif
+	for(; i < width; i++) {
 		r = qb_clamp_float32(p[0], gdRedMax);
 		tpixels[i] = gdTrueColorAlpha(r, r, r, gdAlphaOpaque);
 		p += 1;
@@ -500,10 +751,22 @@ static void qb_copy_y_pixel_to_gd_image_scanline_F32(void *param1, void *param2,
 static void qb_copy_rgba_pixel_to_gd_image_scanline_F64(void *param1, void *param2, int param3) {
 	float64_t *p = param1;
 	int *tpixels = param2;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 	int r, g, b, a;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	// two pixels at a time
+	for(; i + 2 <= width; i += 2) {
+		__m128d rg0 = _mm_loadu_pd(p + 0);
+		__m128d ba0 = _mm_loadu_pd(p + 2);
+		__m128d rg1 = _mm_loadu_pd(p + 4);
+		__m128d ba1 = _mm_loadu_pd(p + 6);
+		__m128i px = qb_pack_gd_pixels_F64(_mm_unpacklo_pd(rg0, rg1), _mm_unpackhi_pd(rg0, rg1), _mm_unpacklo_pd(ba0, ba1), _mm_unpackhi_pd(ba0, ba1));
+		_mm_storel_epi64((__m128i *) &tpixels[i], px);
+		p += 8;
+	}
+#endif
+	for(; i < width; i++) {
 		r = qb_clamp_float64(p[0], gdRedMax);
 		g = qb_clamp_float64(p[1], gdGreenMax);
 		b = qb_clamp_float64(p[2], gdBlueMax);
@@ -516,10 +779,20 @@ static void qb_copy_rgba_pixel_to_gd_image_scanline_F64(void *param1, void *para
 static void qb_copy_rgb_pixel_to_gd_image_scanline_F64(void *param1, void *param2, int param3) {
 	float64_t *p = param1;
 	int *tpixels = param2;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 	int r, g, b;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	for(; i + 2 <= width; i += 2) {
+		__m128d rg0 = _mm_loadu_pd(p + 0);
+		__m128d rg1 = _mm_loadu_pd(p + 3);
+		__m128d vb = _mm_loadh_pd(_mm_load_sd(p + 2), p + 5);
+		__m128i px = qb_pack_gd_pixels_F64(_mm_unpacklo_pd(rg0, rg1), _mm_unpackhi_pd(rg0, rg1), vb, _mm_set1_pd(1.0));
+		_mm_storel_epi64((__m128i *) &tpixels[i], px);
+		p += 6;
+	}
+#endif
+	for(; i < width; i++) {
 		r = qb_clamp_float64(p[0], gdRedMax);
 		g = qb_clamp_float64(p[1], gdGreenMax);
 		b = qb_clamp_float64(p[2], gdBlueMax);
@@ -531,10 +804,20 @@ static void qb_copy_rgb_pixel_to_gd_image_scanline_F64(void *param1, void *param
 static void qb_copy_ya_pixel_to_gd_image_scanline_F64(void *param1, void *param2, int param3) {
 	float64_t *p = param1;
 	int *tpixels = param2;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 	int r, a;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	for(; i + 2 <= width; i += 2) {
+		__m128d ya0 = _mm_loadu_pd(p + 0);
+		__m128d ya1 = _mm_loadu_pd(p + 2);
+		__m128d vy = _mm_unpacklo_pd(ya0, ya1);
+		__m128i px = qb_pack_gd_pixels_F64(vy, vy, vy, _mm_unpackhi_pd(ya0, ya1));
+		_mm_storel_epi64((__m128i *) &tpixels[i], px);
+		p += 4;
+	}
+#endif
+	for(; i < width; i++) {
 		r = qb_clamp_float64(p[0], gdRedMax);
 		a = gdAlphaTransparent - qb_clamp_float64(p[1], gdAlphaMax);
 		tpixels[i] = gdTrueColorAlpha(r, r, r, a);
@@ -545,10 +828,17 @@ static void qb_copy_ya_pixel_to_gd_image_scanline_F64(void *param1, void *param2
 static void qb_copy_y_pixel_to_gd_image_scanline_F64(void *param1, void *param2, int param3) {
 	float64_t *p = param1;
 	int *tpixels = param2;
-	uint32_t width = (uint32_t) param3, i;
+	uint32_t width = (uint32_t) param3, i = 0;
 	int r;
 
-	for(i = 0; i < width; i++) {
+#ifdef __SSE2__
+	for(; i + 2 <= width; i += 2) {
+		__m128d vy = _mm_loadu_pd(p);
+		_mm_storel_epi64((__m128i *) &tpixels[i], qb_pack_gd_pixels_F64(vy, vy, vy, _mm_set1_pd(1.0)));
+		p += 2;
+	}
+#endif
+	for(; i < width; i++) {
 		r = qb_clamp_float64(p[0], gdRedMax);
 		tpixels[i] = gdTrueColorAlpha(r, r, r, gdAlphaOpaque);
 		p += 1;
@@ -593,12 +883,9 @@ static int32_t qb_copy_elements_to_gd_image(int8_t *src_memory, zval *zimage, gd
 			case QB_PIXEL_I08_4:
 			case QB_PIXEL_I32_1: {
 				int32_t *p = (int32_t *) src_memory;
-				int tpixel;
 				for(i = 0; i < (uint32_t) image->sy; i++) {
-					for(j = 0; j < (uint32_t) image->sx; j++) {
-						tpixel = *p++;
-						gdImageTrueColorPixel(image, j, i) = tpixel;
-					}
+					memcpy(image->tpixels[i], p, image->sx * sizeof(int32_t));
+					p += image->sx;
 				}
 			}	break;
 			case QB_PIXEL_F32_4: {
@@ -638,14 +925,7 @@ static int32_t qb_copy_elements_to_gd_image(int8_t *src_memory, zval *zimage, gd
 		}
 
 		if(proc) {
-			int8_t *p = src_memory;
-			qb_task_group *group = qb_allocate_task_group(image->sy, 0);
-			for(i = 0; i < (uint32_t) image->sy; i++) {
-				qb_add_task(group, proc, p, image->tpixels[i], image->sx);
-				p += image->sx * pixel_size;
-			}
-			qb_run_task_group(group, FALSE);
-			qb_free_task_group(group);
+			qb_copy_gd_image_scanlines(proc, src_memory, image->sx * pixel_size, image);
 		}
 	} else {
 		switch(pixel_type) {
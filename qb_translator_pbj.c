@@ -732,7 +732,47 @@ int32_t qb_decode_pbj_binary(qb_pbj_translator_context *cxt) {
 	return TRUE;
 }
 
+int32_t qb_add_pbj_filter_stage(qb_pbj_translator_context *cxt, const char *import_path) {
+	qb_compiler_context *compiler_cxt = cxt->compiler_context;
+	qb_pbj_translator_context *stage_cxt;
+	char *external_code = compiler_cxt->external_code;
+	uint32_t external_code_length = compiler_cxt->external_code_length;
+	USE_TSRM
+
+	while(cxt->next_stage) {
+		cxt = cxt->next_stage;
+	}
+	stage_cxt = emalloc(sizeof(qb_pbj_translator_context));
+	qb_initialize_pbj_translator_context(stage_cxt, compiler_cxt TSRMLS_CC);
+	stage_cxt->previous_stage = cxt;
+	cxt->next_stage = stage_cxt;
+
+	// load the kernel, keeping the binary of the first one in place
+	compiler_cxt->external_code = NULL;
+	compiler_cxt->external_code_length = 0;
+	if(qb_load_external_code(compiler_cxt, import_path)) {
+		stage_cxt->external_code = compiler_cxt->external_code;
+		if(!qb_decode_pbj_binary(stage_cxt)) {
+			stage_cxt = NULL;
+		}
+	} else {
+		stage_cxt = NULL;
+	}
+	compiler_cxt->external_code = external_code;
+	compiler_cxt->external_code_length = external_code_length;
+	return (stage_cxt != NULL);
+}
+
 static qb_pbj_register * qb_get_pbj_register(qb_pbj_translator_context *cxt, qb_pbj_address *reg_address) {
+	if(cxt->lane_index > 0) {
+		// additional lanes have their own copies of the registers
+		qb_pbj_lane *lane = &cxt->lanes[cxt->lane_index];
+		if(reg_address->register_id & PBJ_REGISTER_INT) {
+			return &lane->int_registers[reg_address->register_id & ~PBJ_REGISTER_INT];
+		} else {
+			return &lane->float_registers[reg_address->register_id];
+		}
+	}
 	if(reg_address->register_id & PBJ_REGISTER_INT) {
 		return &cxt->int_registers[reg_address->register_id & ~PBJ_REGISTER_INT];
 	} else {
@@ -791,6 +831,13 @@ static qb_variable * qb_find_output(qb_pbj_translator_context *cxt) {
 	return NULL;
 }
 
+static qb_pbj_translator_context * qb_get_last_fused_pbj_stage(qb_pbj_translator_context *cxt) {
+	while(cxt->next_stage && cxt->next_stage->fused) {
+		cxt = cxt->next_stage;
+	}
+	return cxt;
+}
+
 static qb_pbj_register * qb_create_pbj_register(qb_pbj_translator_context *cxt, qb_pbj_address *reg_address) {
 	qb_pbj_register **p_regs, *reg;
 	uint32_t id, reg_required, end, *p_count;
@@ -975,6 +1022,54 @@ static int32_t qb_match_pbj_parameter_dimensions(qb_pbj_translator_context *cxt,
 	return TRUE;
 }
 
+static void qb_map_pbj_lane_variables(qb_pbj_translator_context *cxt) {
+	qb_pbj_lane *lane = &cxt->lanes[0];
+	uint32_t i, dimension;
+
+	// the first lane uses the same variables as the scalar loop
+	lane->x_address = cxt->x_address;
+	lane->active_pixel_address = cxt->active_pixel_address;
+	lane->out_coord_address = cxt->out_coord_address;
+	lane->out_coord_x_address = cxt->out_coord_x_address;
+	lane->out_coord_y_address = cxt->out_coord_y_address;
+	lane->output_image_pixel_address = cxt->output_image_pixel_address;
+
+	// the other lanes work on the pixels to the right of it
+	for(i = 1; i < cxt->lane_count; i++) {
+		lane = &cxt->lanes[i];
+		if(cxt->fused) {
+			// a fused kernel works on the same pixels as the one before it
+			qb_pbj_lane *previous_lane = &cxt->previous_stage->lanes[i];
+			lane->x_address = previous_lane->x_address;
+			lane->out_coord_address = previous_lane->out_coord_address;
+			lane->out_coord_x_address = previous_lane->out_coord_x_address;
+			lane->out_coord_y_address = previous_lane->out_coord_y_address;
+			lane->output_image_pixel_address = previous_lane->output_image_pixel_address;
+		} else {
+			lane->x_address = qb_create_writable_scalar(cxt->compiler_context, QB_TYPE_U32);
+
+			dimension = 2;
+			lane->out_coord_address = qb_create_writable_array(cxt->compiler_context, QB_TYPE_F32, &dimension, 1);
+			lane->out_coord_x_address = qb_obtain_array_element(cxt->compiler_context, lane->out_coord_address, cxt->compiler_context->zero_address, QB_ARRAY_BOUND_CHECK_NONE);
+			lane->out_coord_y_address = qb_obtain_array_element(cxt->compiler_context, lane->out_coord_address, cxt->compiler_context->one_address, QB_ARRAY_BOUND_CHECK_NONE);
+			lane->output_image_pixel_address = qb_obtain_array_element(cxt->compiler_context, cxt->output_image_scanline_address, lane->x_address, QB_ARRAY_BOUND_CHECK_NONE);
+		}
+
+		dimension = ARRAY_SIZE(cxt->active_pixel_address);
+		lane->active_pixel_address = qb_create_writable_array(cxt->compiler_context, QB_TYPE_F32, &dimension, 1);
+	}
+
+	if(cxt->fused) {
+		// the loop belongs to the first kernel
+		return;
+	}
+
+	// variables for looping through blocks of pixels
+	cxt->block_index_address = qb_create_writable_scalar(cxt->compiler_context, QB_TYPE_U32);
+	cxt->block_count_address = qb_create_writable_scalar(cxt->compiler_context, QB_TYPE_U32);
+	cxt->remainder_address = qb_create_writable_scalar(cxt->compiler_context, QB_TYPE_U32);
+}
+
 static int32_t qb_map_pbj_variables(qb_pbj_translator_context *cxt) {
 	uint32_t i, dimension;
 	qb_variable *qvar;
@@ -983,32 +1078,80 @@ static int32_t qb_map_pbj_variables(qb_pbj_translator_context *cxt) {
 	qvar = qb_find_output(cxt);
 	if(!qvar) {
 	} 
-	cxt->output_image_address = qvar->address;
-	cxt->output_image_width_address = cxt->output_image_address->dimension_addresses[1];
-	cxt->output_image_height_address = cxt->output_image_address->dimension_addresses[0];
-	cxt->output_image_channel_count_address = cxt->output_image_address->dimension_addresses[2];
-
-	// variables for looping 
-	cxt->x_address = qb_create_writable_scalar(cxt->compiler_context, QB_TYPE_U32);
-	cxt->y_address = qb_create_writable_scalar(cxt->compiler_context, QB_TYPE_U32);
-
-	// the current coordinate--basically x and y in float 
-	dimension = 2;
-	cxt->out_coord_address = qb_create_writable_array(cxt->compiler_context, QB_TYPE_F32, &dimension, 1);
-	cxt->out_coord_x_address = qb_obtain_array_element(cxt->compiler_context, cxt->out_coord_address, cxt->compiler_context->zero_address, QB_ARRAY_BOUND_CHECK_NONE);
-	cxt->out_coord_y_address = qb_obtain_array_element(cxt->compiler_context, cxt->out_coord_address, cxt->compiler_context->one_address, QB_ARRAY_BOUND_CHECK_NONE);
-
-	// sub-array representing the pixel
-	cxt->output_image_scanline_address = qb_obtain_array_element(cxt->compiler_context, cxt->output_image_address, cxt->y_address, QB_ARRAY_BOUND_CHECK_NONE);
-	cxt->output_image_pixel_address = qb_obtain_array_element(cxt->compiler_context, cxt->output_image_scanline_address, cxt->x_address, QB_ARRAY_BOUND_CHECK_NONE);
-
-	// a temporary array holding the pixel being worked on
-	dimension = DIMENSION(cxt->output_image_address, -1);
+	if(cxt->fused) {
+		// a fused kernel runs inside the loop of the previous one and shares its variables
+		qb_pbj_translator_context *previous = cxt->previous_stage;
+		cxt->output_image_address = previous->output_image_address;
+		cxt->output_image_width_address = previous->output_image_width_address;
+		cxt->output_image_height_address = previous->output_image_height_address;
+		cxt->output_image_channel_count_address = previous->output_image_channel_count_address;
+		cxt->x_address = previous->x_address;
+		cxt->y_address = previous->y_address;
+		cxt->out_coord_address = previous->out_coord_address;
+		cxt->out_coord_x_address = previous->out_coord_x_address;
+		cxt->out_coord_y_address = previous->out_coord_y_address;
+		cxt->output_image_scanline_address = previous->output_image_scanline_address;
+		cxt->output_image_pixel_address = previous->output_image_pixel_address;
+	} else {
+		qb_pbj_translator_context *last_stage = qb_get_last_fused_pbj_stage(cxt);
+		if(last_stage->next_stage) {
+			// the next kernel works on the result, which stays premultiplied
+			uint32_t dimensions[3] = { 0, 0, 0 };
+			dimensions[2] = (last_stage->out_pixel->type == PBJ_TYPE_FLOAT4) ? 4 : 3;
+			cxt->output_image_address = qb_create_writable_array(cxt->compiler_context, QB_TYPE_F32, dimensions, 3);
+			cxt->final_image_address = qvar->address;
+		} else {
+			cxt->output_image_address = qvar->address;
+		}
+		cxt->output_image_width_address = cxt->output_image_address->dimension_addresses[1];
+		cxt->output_image_height_address = cxt->output_image_address->dimension_addresses[0];
+		cxt->output_image_channel_count_address = cxt->output_image_address->dimension_addresses[2];
+
+		// variables for looping 
+		cxt->x_address = qb_create_writable_scalar(cxt->compiler_context, QB_TYPE_U32);
+		cxt->y_address = qb_create_writable_scalar(cxt->compiler_context, QB_TYPE_U32);
+
+		// the current coordinate--basically x and y in float 
+		dimension = 2;
+		cxt->out_coord_address = qb_create_writable_array(cxt->compiler_context, QB_TYPE_F32, &dimension, 1);
+		cxt->out_coord_x_address = qb_obtain_array_element(cxt->compiler_context, cxt->out_coord_address, cxt->compiler_context->zero_address, QB_ARRAY_BOUND_CHECK_NONE);
+		cxt->out_coord_y_address = qb_obtain_array_element(cxt->compiler_context, cxt->out_coord_address, cxt->compiler_context->one_address, QB_ARRAY_BOUND_CHECK_NONE);
+
+		// sub-array representing the pixel
+		cxt->output_image_scanline_address = qb_obtain_array_element(cxt->compiler_context, cxt->output_image_address, cxt->y_address, QB_ARRAY_BOUND_CHECK_NONE);
+		cxt->output_image_pixel_address = qb_obtain_array_element(cxt->compiler_context, cxt->output_image_scanline_address, cxt->x_address, QB_ARRAY_BOUND_CHECK_NONE);
+	}
+
+	// a temporary array holding the pixel being worked on (only the last of the fused 
+	// kernels writes into the image)
+	if(cxt->next_stage && cxt->next_stage->fused) {
+		dimension = (cxt->out_pixel->type == PBJ_TYPE_FLOAT4) ? 4 : 3;
+	} else {
+		dimension = DIMENSION(cxt->output_image_address, -1);
+	}
 	cxt->active_pixel_address = qb_create_writable_array(cxt->compiler_context, QB_TYPE_F32, &dimension, 1);
 
+	if(cxt->lane_count > 1) {
+		qb_map_pbj_lane_variables(cxt);
+	}
+
 	// hook input images to the texture parameters
 	for(i = 0; i < cxt->texture_count; i++) {
 		qb_pbj_texture *texture = &cxt->textures[i];
+		if(i == 0 && cxt->fused) {
+			// the first input is the pixel the previous kernel has just produced
+			texture->address = NULL;
+			continue;
+		} else if(i == 0 && cxt->previous_stage) {
+			// the first input comes from the previous kernel
+			qb_address *address = cxt->previous_stage->output_image_address;
+			if(DIMENSION(address, -1) != texture->channel_count) {
+				qb_report_unsupported_pbj_exception(cxt->compiler_context->line_id);
+				return FALSE;
+			}
+			texture->address = address;
+			continue;
+		}
 		qvar = qb_find_argument(cxt, texture->name);
 		if(qvar) {
 			if(qb_is_image(cxt, qvar->address, texture->channel_count)) {
@@ -1408,27 +1551,36 @@ static int32_t qb_process_current_pbj_instruction(qb_pbj_translator_context *cxt
 
 			result.type = 999;
 
-			if(t->flags & PBJ_READ_IMAGE) {
-				qb_pbj_texture *texture = qb_find_pbj_texture_by_id(cxt, pop->image_id);
-				qb_operand *image = &operands[operand_count++];
-				image->address = texture->address;
-				image->type = QB_OPERAND_ADDRESS;
-			}
-			if(t->flags & PBJ_READ_DESTINATION_FIRST) {
-				qb_fetch_pbj_register(cxt, (pop->destination_origin) ? pop->destination_origin : &pop->destination, &operands[operand_count++]);
-			}
-			if(t->flags & PBJ_READ_SOURCE) {
-				qb_fetch_pbj_register(cxt, &pop->source, &operands[operand_count++]);
-			} 
-			if(t->flags & PBJ_READ_SOURCE2) {
-				qb_pbj_op *data_pop = pop + 1;
-				qb_fetch_pbj_register(cxt, &data_pop->source2, &operands[operand_count++]);
-				if(t->flags & PBJ_READ_SOURCE3) {
-					qb_fetch_pbj_register(cxt, &data_pop->source3, &operands[operand_count++]);
+			if((t->flags & PBJ_READ_IMAGE) && cxt->fused && pop->image_id == cxt->textures[0].image_id) {
+				// the sample is taken at _OutCoord, so it's just the pixel the previous kernel produced
+				qb_pbj_translator_context *previous = cxt->previous_stage;
+				previous->lane_index = cxt->lane_index;
+				qb_fetch_pbj_register(previous, &previous->out_pixel->destination, &operands[operand_count++]);
+				previous->lane_index = 0;
+				t = &pbj_op_translators[PBJ_COPY];
+			} else {
+				if(t->flags & PBJ_READ_IMAGE) {
+					qb_pbj_texture *texture = qb_find_pbj_texture_by_id(cxt, pop->image_id);
+					qb_operand *image = &operands[operand_count++];
+					image->address = texture->address;
+					image->type = QB_OPERAND_ADDRESS;
+				}
+				if(t->flags & PBJ_READ_DESTINATION_FIRST) {
+					qb_fetch_pbj_register(cxt, (pop->destination_origin) ? pop->destination_origin : &pop->destination, &operands[operand_count++]);
+				}
+				if(t->flags & PBJ_READ_SOURCE) {
+					qb_fetch_pbj_register(cxt, &pop->source, &operands[operand_count++]);
+				} 
+				if(t->flags & PBJ_READ_SOURCE2) {
+					qb_pbj_op *data_pop = pop + 1;
+					qb_fetch_pbj_register(cxt, &data_pop->source2, &operands[operand_count++]);
+					if(t->flags & PBJ_READ_SOURCE3) {
+						qb_fetch_pbj_register(cxt, &data_pop->source3, &operands[operand_count++]);
+					}
+				}
+				if(t->flags & PBJ_READ_DESTINATION) {
+					qb_fetch_pbj_register(cxt, (pop->destination_origin) ? pop->destination_origin : &pop->destination, &operands[operand_count++]);
 				}
-			}
-			if(t->flags & PBJ_READ_DESTINATION) {
-				qb_fetch_pbj_register(cxt, (pop->destination_origin) ? pop->destination_origin : &pop->destination, &operands[operand_count++]);
 			}
 			if(t->flags & (PBJ_WRITE_DESTINATION | PBJ_WRITE_BOOLEAN)) {
 				if(t->flags & PBJ_WRITE_SCALAR) {
@@ -1575,8 +1727,33 @@ static void qb_allocate_pbj_register(qb_pbj_translator_context *cxt, qb_pbj_addr
 	}
 }
 
+static void qb_create_pbj_lane_registers(qb_pbj_translator_context *cxt, uint32_t lane_index) {
+	qb_pbj_lane *lane = &cxt->lanes[lane_index];
+	qb_pbj_register *regs;
+
+	// copy the registers before storage is allocated, so the lane gets its own temporaries
+	qb_attach_new_array(cxt->pool, (void **) &lane->int_registers, &lane->int_register_count, sizeof(qb_pbj_register), 16);
+	qb_attach_new_array(cxt->pool, (void **) &lane->float_registers, &lane->float_register_count, sizeof(qb_pbj_register), 16);
+	regs = qb_enlarge_array((void **) &lane->int_registers, cxt->int_register_count);
+	memcpy(regs, cxt->int_registers, sizeof(qb_pbj_register) * cxt->int_register_count);
+	regs = qb_enlarge_array((void **) &lane->float_registers, cxt->float_register_count);
+	memcpy(regs, cxt->float_registers, sizeof(qb_pbj_register) * cxt->float_register_count);
+
+	// point the per-pixel parameters at the lane's variables
+	cxt->lane_index = lane_index;
+	if(cxt->out_pixel) {
+		qb_pbj_register *reg = qb_get_pbj_register(cxt, &cxt->out_pixel->destination);
+		reg->channel_addresses[cxt->out_pixel->destination.channel_id] = lane->active_pixel_address;
+	}
+	if(cxt->out_coord) {
+		qb_pbj_register *reg = qb_get_pbj_register(cxt, &cxt->out_coord->destination);
+		reg->channel_addresses[cxt->out_coord->destination.channel_id] = lane->out_coord_address;
+	}
+	cxt->lane_index = 0;
+}
+
 static void qb_allocate_pbj_registers(qb_pbj_translator_context *cxt) {
-	uint32_t i;
+	uint32_t i, j;
 	for(i = 0; i < cxt->pbj_op_count; i++) {
 		qb_pbj_op *pop = &cxt->pbj_ops[i];
 		if(pop->flags & PBJ_SOURCE_IN_USE) {
@@ -1587,6 +1764,10 @@ static void qb_allocate_pbj_registers(qb_pbj_translator_context *cxt) {
 		}
 	}
 
+	for(j = 1; j < cxt->lane_count; j++) {
+		qb_create_pbj_lane_registers(cxt, j);
+	}
+
 	for(i = 0; i < cxt->int_register_count; i++) {
 		qb_pbj_register *reg = &cxt->int_registers[i];
 		qb_allocate_pbj_register_storage_space(cxt, QB_TYPE_I32, reg);
@@ -1595,6 +1776,18 @@ static void qb_allocate_pbj_registers(qb_pbj_translator_context *cxt) {
 		qb_pbj_register *reg = &cxt->float_registers[i];
 		qb_allocate_pbj_register_storage_space(cxt, QB_TYPE_F32, reg);
 	}
+
+	for(j = 1; j < cxt->lane_count; j++) {
+		qb_pbj_lane *lane = &cxt->lanes[j];
+		for(i = 0; i < lane->int_register_count; i++) {
+			qb_pbj_register *reg = &lane->int_registers[i];
+			qb_allocate_pbj_register_storage_space(cxt, QB_TYPE_I32, reg);
+		}
+		for(i = 0; i < lane->float_register_count; i++) {
+			qb_pbj_register *reg = &lane->float_registers[i];
+			qb_allocate_pbj_register_storage_space(cxt, QB_TYPE_F32, reg);
+		}
+	}
 }
 
 static void qb_perform_assignment(qb_pbj_translator_context *cxt, qb_address *dst_address, qb_address *src_address) {
@@ -1647,11 +1840,41 @@ static void qb_perform_return(qb_pbj_translator_context *cxt) {
 static void qb_perform_loop(qb_pbj_translator_context *cxt, qb_address *index_address, qb_address *limit_address, uint32_t target_op_index) {
 	qb_operand operands[2] = { { QB_OPERAND_ADDRESS, { index_address } }, { QB_OPERAND_ADDRESS, { limit_address } } };
 	qb_operand result = { QB_OPERAND_EMPTY, { NULL } };
-	uint32_t target_indices[2] = { JUMP_TARGET_INDEX(target_op_index, 0), JUMP_TARGET_INDEX(cxt->loop_op_index + 1, 0) };
+	// fall through to the op immediately following the loop instruction 
+	uint32_t target_indices[2] = { JUMP_TARGET_INDEX(target_op_index, 0), JUMP_TARGET_INDEX(cxt->loop_op_index, 1) };
 	qb_set_source_op_index(cxt->compiler_context, cxt->loop_op_index, 0);
 	qb_produce_op(cxt->compiler_context, &factory_loop, operands, 2, &result, target_indices, 2, &cxt->result_prototypes[cxt->loop_op_index++]);
 }
 
+static void qb_perform_resize(qb_pbj_translator_context *cxt, qb_address *image_address, qb_address *height_address, qb_address *width_address) {
+	qb_operand operands[3] = { { QB_OPERAND_ADDRESS, { image_address } }, { QB_OPERAND_ADDRESS, { height_address } }, { QB_OPERAND_ADDRESS, { width_address } } };
+	qb_operand result = { QB_OPERAND_NONE, { NULL } };
+	qb_set_source_op_index(cxt->compiler_context, cxt->loop_op_index, 0);
+	qb_produce_op(cxt->compiler_context, &factory_array_resize, operands, 3, &result, NULL, 0, &cxt->result_prototypes[cxt->loop_op_index++]);
+}
+
+static void qb_perform_branch(qb_pbj_translator_context *cxt, qb_address *condition_address, uint32_t true_op_index, uint32_t false_op_index) {
+	qb_operand operand = { QB_OPERAND_ADDRESS, { condition_address } };
+	qb_operand result = { QB_OPERAND_NONE, { NULL } };
+	uint32_t target_indices[2] = { JUMP_TARGET_INDEX(true_op_index, 0), JUMP_TARGET_INDEX(false_op_index, 0) };
+	qb_set_source_op_index(cxt->compiler_context, cxt->loop_op_index, 0);
+	qb_produce_op(cxt->compiler_context, &factory_branch_on_true, &operand, 1, &result, target_indices, 2, &cxt->result_prototypes[cxt->loop_op_index++]);
+}
+
+static void qb_perform_shift_right(qb_pbj_translator_context *cxt, qb_address *value_address, qb_address *shift_address, qb_address *dst_address) {
+	qb_operand operands[2] = { { QB_OPERAND_ADDRESS, { value_address } }, { QB_OPERAND_ADDRESS, { shift_address } } };
+	qb_operand result = { QB_OPERAND_ADDRESS, { dst_address } };
+	qb_set_source_op_index(cxt->compiler_context, cxt->loop_op_index, 0);
+	qb_produce_op(cxt->compiler_context, &factory_shift_right, operands, 2, &result, NULL, 0, &cxt->result_prototypes[cxt->loop_op_index++]);
+}
+
+static void qb_perform_bitwise_and(qb_pbj_translator_context *cxt, qb_address *value_address, qb_address *mask_address, qb_address *dst_address) {
+	qb_operand operands[2] = { { QB_OPERAND_ADDRESS, { value_address } }, { QB_OPERAND_ADDRESS, { mask_address } } };
+	qb_operand result = { QB_OPERAND_ADDRESS, { dst_address } };
+	qb_set_source_op_index(cxt->compiler_context, cxt->loop_op_index, 0);
+	qb_produce_op(cxt->compiler_context, &factory_bitwise_and, operands, 2, &result, NULL, 0, &cxt->result_prototypes[cxt->loop_op_index++]);
+}
+
 static void qb_perform_fork(qb_pbj_translator_context *cxt, qb_address *id_address, qb_address *count_address) {
 	qb_operand fork_operands[1] = { { QB_OPERAND_ADDRESS, { count_address } } };
 	qb_operand fork_result = { QB_OPERAND_ADDRESS, { id_address } };
@@ -1693,30 +1916,65 @@ static void qb_perform_pad_3x3_matrix(qb_pbj_translator_context *cxt, qb_address
 	}
 }
 
-static int32_t qb_start_pbj_filter_loop(qb_pbj_translator_context *cxt) {
-	qb_address *start_coord_address;
+static void qb_prepare_pbj_kernel_inputs(qb_pbj_translator_context *cxt, qb_pbj_translator_context *stage) {
 	uint32_t i;
 
-	cxt->loop_op_index = 0;
-
-	// apply premultiplication to input images
-	for(i = 0; i < cxt->texture_count; i++) {
-		qb_pbj_texture *texture = &cxt->textures[i];
-		if(DIMENSION(texture->address, -1) == 4) {
-			qb_perform_alpha_premultication(cxt, texture->address);
+	// apply premultiplication to input images (output from a previous kernel already has it)
+	for(i = 0; i < stage->texture_count; i++) {
+		qb_pbj_texture *texture = &stage->textures[i];
+		if(texture->address && DIMENSION(texture->address, -1) == 4) {
+			if(!stage->previous_stage || texture->address != stage->previous_stage->output_image_address) {
+				qb_perform_alpha_premultication(cxt, texture->address);
+			}
 		}
 	}
 
-	for(i = 0; i < cxt->parameter_count; i++) {
-		qb_pbj_parameter *parameter = &cxt->parameters[i];
+	for(i = 0; i < stage->parameter_count; i++) {
+		qb_pbj_parameter *parameter = &stage->parameters[i];
 		if(parameter->address->dimension_count == 2) {
 			if(ARRAY_SIZE(parameter->address) == 12) {
 				// it's a 3x3 matrix--copy the values from the parameter
-				qb_variable *qvar = qb_find_argument(cxt, parameter->name);
+				qb_variable *qvar = qb_find_argument(stage, parameter->name);
 				qb_perform_pad_3x3_matrix(cxt, qvar->address, parameter->address);
 			}
 		}
 	}
+}
+
+static void qb_clear_pbj_active_pixels(qb_pbj_translator_context *cxt, uint32_t lane_index) {
+	qb_pbj_translator_context *stage = cxt;
+
+	// kernels fused into this one have their own output pixels
+	for(;;) {
+		qb_address *address = (lane_index > 0) ? stage->lanes[lane_index].active_pixel_address : stage->active_pixel_address;
+		qb_perform_subtraction(cxt, address, address);
+		if(!stage->next_stage || !stage->next_stage->fused) {
+			break;
+		}
+		stage = stage->next_stage;
+	}
+}
+
+static int32_t qb_start_pbj_filter_loop(qb_pbj_translator_context *cxt) {
+	qb_pbj_translator_context *stage = cxt;
+	qb_address *start_coord_address;
+	uint32_t i;
+
+	cxt->loop_op_index = cxt->op_index_base;
+
+	// set up the inputs of this kernel and those fused into it
+	for(;;) {
+		qb_prepare_pbj_kernel_inputs(cxt, stage);
+		if(!stage->next_stage || !stage->next_stage->fused) {
+			break;
+		}
+		stage = stage->next_stage;
+	}
+
+	if(cxt->final_image_address) {
+		// make the intermediate image as large as the final one
+		qb_perform_resize(cxt, cxt->output_image_address, cxt->final_image_address->dimension_addresses[0], cxt->final_image_address->dimension_addresses[1]);
+	}
 
 	// _OutCoord.x and .y start 0.5, as that's the center of the pixel
 	start_coord_address = qb_obtain_constant_F32(cxt->compiler_context, 0.5);
@@ -1731,24 +1989,87 @@ static int32_t qb_start_pbj_filter_loop(qb_pbj_translator_context *cxt) {
 		qb_perform_assignment(cxt, cxt->out_coord_y_address, start_coord_address);
 	}
 
+	if(cxt->lane_count > 1) {
+		// divide each scanline into blocks of pixels plus a remainder
+		uint32_t shift = 0;
+		while((1U << shift) < cxt->lane_count) {
+			shift++;
+		}
+		qb_perform_shift_right(cxt, cxt->output_image_width_address, qb_obtain_constant_U32(cxt->compiler_context, shift), cxt->block_count_address);
+		qb_perform_bitwise_and(cxt, cxt->output_image_width_address, qb_obtain_constant_U32(cxt->compiler_context, cxt->lane_count - 1), cxt->remainder_address);
+	}
+
 	// set x to zero; the outer loop starts here
 	cxt->outer_loop_start_index = cxt->loop_op_index;
 	qb_perform_assignment(cxt, cxt->x_address, cxt->compiler_context->zero_address);
 	qb_perform_assignment(cxt, cxt->out_coord_x_address, start_coord_address);
 
+	if(cxt->lane_count > 1) {
+		// skip to the scalar loop if the image is narrower than a block
+		qb_perform_assignment(cxt, cxt->block_index_address, cxt->compiler_context->zero_address);
+		qb_perform_branch(cxt, cxt->block_count_address, cxt->loop_op_index + 1, cxt->tail_loop_check_index);
+
+		// set up the other lanes; the vector loop starts here
+		cxt->vector_loop_start_index = cxt->loop_op_index;
+		for(i = 1; i < cxt->lane_count; i++) {
+			qb_pbj_lane *lane = &cxt->lanes[i];
+			qb_perform_addition(cxt, cxt->x_address, qb_obtain_constant_U32(cxt->compiler_context, i), lane->x_address);
+			qb_perform_addition(cxt, cxt->out_coord_x_address, qb_obtain_constant_F32(cxt->compiler_context, (float32_t) i), lane->out_coord_x_address);
+			qb_perform_assignment(cxt, lane->out_coord_y_address, cxt->out_coord_y_address);
+		}
+		for(i = 0; i < cxt->lane_count; i++) {
+			qb_clear_pbj_active_pixels(cxt, i);
+		}
+		return TRUE;
+	}
+
 	// initialize the active pixel to zero; the inner loop starts here
 	cxt->inner_loop_start_index = cxt->loop_op_index;
-	qb_perform_subtraction(cxt, cxt->active_pixel_address, cxt->active_pixel_address);
+	qb_clear_pbj_active_pixels(cxt, 0);
 	return TRUE;
 }
 
-static int32_t qb_end_pbj_filter_loop(qb_pbj_translator_context *cxt) {
+static int32_t qb_end_pbj_vector_loop(qb_pbj_translator_context *cxt) {
+	qb_pbj_translator_context *last_stage = qb_get_last_fused_pbj_stage(cxt);
 	qb_operand operand;
+	uint32_t i, op_index;
 
-	cxt->loop_op_index += cxt->pbj_op_count;
+	// copy the output pixels (of the last fused kernel) into the image
+	for(i = 0; i < cxt->lane_count; i++) {
+		qb_pbj_lane *lane = &cxt->lanes[i];
+		last_stage->lane_index = i;
+		qb_fetch_pbj_register(last_stage, &last_stage->out_pixel->destination, &operand);
+		qb_perform_assignment(cxt, lane->output_image_pixel_address, operand.address);
+	}
+	last_stage->lane_index = 0;
+
+	// advance x and _OutCoord.x by the block size
+	qb_perform_addition(cxt, cxt->x_address, qb_obtain_constant_U32(cxt->compiler_context, cxt->lane_count), cxt->x_address);
+	qb_perform_addition(cxt, cxt->out_coord_x_address, qb_obtain_constant_F32(cxt->compiler_context, (float32_t) cxt->lane_count), cxt->out_coord_x_address);
+
+	// jump to beginning of vector loop if there're more blocks
+	qb_perform_loop(cxt, cxt->block_index_address, cxt->block_count_address, cxt->vector_loop_start_index);
+
+	// the check for leftover pixels is also reached from the top of the row, 
+	// so it's placed at an index reserved for it
+	op_index = cxt->loop_op_index;
+	cxt->loop_op_index = cxt->tail_loop_check_index;
+	qb_perform_branch(cxt, cxt->remainder_address, op_index, cxt->row_end_index);
+	cxt->loop_op_index = op_index;
+
+	// initialize the active pixel to zero; the scalar loop handling the leftover starts here
+	cxt->inner_loop_start_index = cxt->loop_op_index;
+	qb_clear_pbj_active_pixels(cxt, 0);
+	return TRUE;
+}
+
+static int32_t qb_end_pbj_filter_loop(qb_pbj_translator_context *cxt) {
+	qb_pbj_translator_context *last_stage = qb_get_last_fused_pbj_stage(cxt);
+	qb_operand operand;
+	uint32_t op_index;
 
 	// copy the output pixel into the image
-	qb_fetch_pbj_register(cxt, &cxt->out_pixel->destination, &operand);
+	qb_fetch_pbj_register(last_stage, &last_stage->out_pixel->destination, &operand);
 	qb_perform_assignment(cxt, cxt->output_image_pixel_address, operand.address);
 
 	// increment _OutCoord.x
@@ -1757,17 +2078,31 @@ static int32_t qb_end_pbj_filter_loop(qb_pbj_translator_context *cxt) {
 	// jump to beginning of inner loop if x is less than width
 	qb_perform_loop(cxt, cxt->x_address, cxt->output_image_width_address, cxt->inner_loop_start_index);
 
+	// the scalar loop is skipped when there's no leftover pixel, so the 
+	// op at the end of the row needs to be at a known index
+	op_index = cxt->loop_op_index;
+	if(cxt->lane_count > 1) {
+		cxt->loop_op_index = cxt->row_end_index;
+	}
+
 	if(cxt->thread_count > 1) {
 		// reconverge forked copies
 		qb_perform_spoon(cxt);
+		cxt->loop_op_index = op_index;
 	} else {
 		// increment _OutCoord.y
 		qb_perform_increment(cxt, cxt->out_coord_y_address);
+		cxt->loop_op_index = op_index;
 
 		// jump to beginning of outer loop if y is less than height
 		qb_perform_loop(cxt, cxt->y_address, cxt->output_image_height_address, cxt->outer_loop_start_index);
 	}
 
+	if(cxt->final_image_address) {
+		// the next kernel picks up from here
+		return TRUE;
+	}
+
 	// remove premultiplication from output image if it has an alpha channel
 	if(DIMENSION(cxt->output_image_address, -1) == 4) {
 		qb_perform_alpha_premultiplication_removal(cxt, cxt->output_image_address);
@@ -1777,11 +2112,121 @@ static int32_t qb_end_pbj_filter_loop(qb_pbj_translator_context *cxt) {
 	return TRUE;
 }
 
+static int32_t qb_process_pbj_instructions(qb_pbj_translator_context *cxt) {
+	for(cxt->pbj_op_index = 0; cxt->pbj_op_index < cxt->pbj_op_count; cxt->pbj_op_index++) {
+		cxt->pbj_op = &cxt->pbj_ops[cxt->pbj_op_index];
+		qb_set_source_op_index(cxt->compiler_context, cxt->loop_op_index + cxt->pbj_op_index, cxt->pbj_op_index);
+		if(!qb_process_current_pbj_instruction(cxt)) {
+			return FALSE;
+		}
+	}
+	cxt->loop_op_index += cxt->pbj_op_count;
+	return TRUE;
+}
+
+static int32_t qb_process_pbj_kernel_body(qb_pbj_translator_context *cxt, uint32_t lane_index) {
+	qb_pbj_translator_context *stage = cxt;
+
+	// kernels fused into this one follow it, working on the same pixel
+	for(;;) {
+		stage->lane_index = lane_index;
+		stage->loop_op_index = cxt->loop_op_index;
+		if(!qb_process_pbj_instructions(stage)) {
+			return FALSE;
+		}
+		cxt->loop_op_index = stage->loop_op_index;
+		stage->lane_index = 0;
+		if(!stage->next_stage || !stage->next_stage->fused) {
+			break;
+		}
+		stage = stage->next_stage;
+	}
+	return TRUE;
+}
+
+static int32_t qb_process_pbj_filter_loop(qb_pbj_translator_context *cxt) {
+	if(!qb_start_pbj_filter_loop(cxt)) {
+		return FALSE;
+	}
+	if(cxt->lane_count > 1) {
+		// translate the kernel once for each pixel in a block
+		uint32_t i;
+		for(i = 0; i < cxt->lane_count; i++) {
+			if(!qb_process_pbj_kernel_body(cxt, i)) {
+				return FALSE;
+			}
+		}
+		if(!qb_end_pbj_vector_loop(cxt)) {
+			return FALSE;
+		}
+	}
+	if(!qb_process_pbj_kernel_body(cxt, 0)) {
+		return FALSE;
+	}
+	if(!qb_end_pbj_filter_loop(cxt)) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static void qb_remove_redundant_pbj_ops(qb_pbj_translator_context *cxt);
+static uint32_t qb_get_pbj_op_effect(qb_pbj_translator_context *cxt, qb_pbj_op *pop, qb_pbj_address *address, uint32_t effect_mask);
 
-int32_t qb_survey_pbj_instructions(qb_pbj_translator_context *cxt) {
+static uint32_t qb_get_pbj_lane_count(qb_pbj_translator_context *cxt) {
+	uint32_t i, lane_count;
+	USE_TSRM
+
+	// round down to a power of two
+	for(lane_count = 1; lane_count * 2 <= PBJ_MAX_LANE_COUNT && lane_count * 2 <= (uint32_t) QB_G(pbj_pixels_per_iteration); lane_count *= 2);
+
+	if(lane_count > 1) {
+		for(i = 0; i < cxt->pbj_op_count; i++) {
+			qb_pbj_op *pop = &cxt->pbj_ops[i];
+			if(pop->opcode == PBJ_IF) {
+				// adjacent pixels can take different branches--stay with one pixel at a time
+				return 1;
+			}
+		}
+		if(!cxt->out_pixel) {
+			return 1;
+		}
+	}
+	return lane_count;
+}
+
+static int32_t qb_is_pbj_kernel_fusable(qb_pbj_translator_context *cxt) {
+	qb_pbj_texture *texture;
 	uint32_t i;
 
+	if(cxt->texture_count == 0) {
+		return TRUE;
+	}
+
+	// the kernel can run inside the loop of the previous one only if it reads the 
+	// previous kernel's result at _OutCoord and nowhere else
+	texture = &cxt->textures[0];
+	if(texture->channel_count != ((cxt->previous_stage->out_pixel->type == PBJ_TYPE_FLOAT4) ? 4 : 3)) {
+		return FALSE;
+	}
+	for(i = 0; i < cxt->pbj_op_count; i++) {
+		qb_pbj_op *pop = &cxt->pbj_ops[i];
+		if(pop->opcode == PBJ_NOP || pop->opcode == PBJ_OP_DATA) {
+			continue;
+		}
+		if(pop->opcode == PBJ_SAMPLE_NEAREST || pop->opcode == PBJ_SAMPLE_BILINEAR) {
+			if(pop->image_id == texture->image_id && !qb_match_pbj_addresses(cxt, &pop->source, &cxt->out_coord->destination)) {
+				return FALSE;
+			}
+		}
+		if(qb_get_pbj_op_effect(cxt, pop, &cxt->out_coord->destination, PBJ_OP_WRITE) & PBJ_OP_WRITE) {
+			// _OutCoord is modified
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static int32_t qb_prepare_pbj_kernel(qb_pbj_translator_context *cxt) {
 	// map function arguments to PB kernel parameters
 	if(!qb_map_pbj_variables(cxt)) {
 		return FALSE;
@@ -1792,30 +2237,76 @@ int32_t qb_survey_pbj_instructions(qb_pbj_translator_context *cxt) {
 
 	// eliminate redundant ops
 	qb_remove_redundant_pbj_ops(cxt);
+	return TRUE;
+}
 
-	// initialize result prototypes
-	qb_enlarge_array((void **) &cxt->result_prototypes, cxt->pbj_op_count + 16 + cxt->texture_count);
-	for(i = 0; i < cxt->result_prototype_count; i++) {
-		qb_result_prototype *prototype = &cxt->result_prototypes[i];
-		prototype->preliminary_type = prototype->final_type = QB_TYPE_UNKNOWN;
-	}
+int32_t qb_survey_pbj_instructions(qb_pbj_translator_context *cxt) {
+	qb_pbj_translator_context *stage, *last_stage;
+	uint32_t i, body_count, body_op_count, loop_op_count;
 
-	cxt->compiler_context->no_short_circuting = TRUE;
-	cxt->compiler_context->stage = QB_STAGE_RESULT_TYPE_RESOLUTION;
+	// see how many pixels can be handled per iteration 
+	cxt->lane_count = qb_get_pbj_lane_count(cxt);
 
-	if(!qb_start_pbj_filter_loop(cxt)) {
+	// chained kernels that only look at the pixel they're producing run in the same loop,
+	// so the result of one goes straight into the next without an intermediate image
+	for(stage = cxt->next_stage; stage && qb_is_pbj_kernel_fusable(stage); stage = stage->next_stage) {
+		uint32_t lane_count = qb_get_pbj_lane_count(stage);
+		if(cxt->lane_count > lane_count) {
+			cxt->lane_count = lane_count;
+		}
+		stage->fused = TRUE;
+	}
+	last_stage = qb_get_last_fused_pbj_stage(cxt);
+
+	if(!qb_prepare_pbj_kernel(cxt)) {
 		return FALSE;
 	}
-	for(cxt->pbj_op_index = 0; cxt->pbj_op_index < cxt->pbj_op_count; cxt->pbj_op_index++) {
-		cxt->pbj_op = &cxt->pbj_ops[cxt->pbj_op_index];
-		qb_set_source_op_index(cxt->compiler_context, cxt->loop_op_index + cxt->pbj_op_index, cxt->pbj_op_index);
-		if(!qb_process_current_pbj_instruction(cxt)) {
+	body_op_count = cxt->pbj_op_count;
+	loop_op_count = 16 + cxt->texture_count + cxt->parameter_count * 3 + cxt->lane_count * 8;
+	for(stage = cxt; stage != last_stage; ) {
+		stage = stage->next_stage;
+		stage->lane_count = cxt->lane_count;
+		if(!qb_prepare_pbj_kernel(stage)) {
 			return FALSE;
 		}
+		body_op_count += stage->pbj_op_count;
+		loop_op_count += stage->texture_count + stage->parameter_count * 3 + stage->lane_count * 2;
 	}
-	if(!qb_end_pbj_filter_loop(cxt)) {
+
+	// initialize result prototypes (the vector loop has a copy of the kernel for each lane 
+	// in addition to the one in the scalar loop)
+	// ops of a chained kernel come after those of the previous one
+	if(cxt->previous_stage) {
+		cxt->op_index_base = cxt->previous_stage->result_prototype_count;
+	}
+	body_count = (cxt->lane_count > 1) ? cxt->lane_count + 1 : 1;
+	qb_enlarge_array((void **) &cxt->result_prototypes, cxt->op_index_base + body_op_count * body_count + loop_op_count + 2);
+	cxt->tail_loop_check_index = cxt->op_index_base + body_op_count * body_count + loop_op_count;
+	cxt->row_end_index = cxt->tail_loop_check_index + 1;
+	for(stage = cxt; stage != last_stage; ) {
+		// fused kernels index into their own copies with the same op indices
+		stage = stage->next_stage;
+		qb_enlarge_array((void **) &stage->result_prototypes, cxt->result_prototype_count);
+	}
+	for(stage = cxt; ; stage = stage->next_stage) {
+		for(i = 0; i < stage->result_prototype_count; i++) {
+			qb_result_prototype *prototype = &stage->result_prototypes[i];
+			prototype->preliminary_type = prototype->final_type = QB_TYPE_UNKNOWN;
+		}
+		if(stage == last_stage) {
+			break;
+		}
+	}
+
+	cxt->compiler_context->no_short_circuting = TRUE;
+	cxt->compiler_context->stage = QB_STAGE_RESULT_TYPE_RESOLUTION;
+
+	if(!qb_process_pbj_filter_loop(cxt)) {
 		return FALSE;
 	}
+	if(last_stage->next_stage) {
+		return qb_survey_pbj_instructions(last_stage->next_stage);
+	}
 	return TRUE;
 }
 
@@ -1825,18 +2316,12 @@ int32_t qb_translate_pbj_instructions(qb_pbj_translator_context *cxt) {
 	cxt->compiler_context->stage = QB_STAGE_OPCODE_TRANSLATION;
 
 	// translate the instructions
-	if(!qb_start_pbj_filter_loop(cxt)) {
+	if(!qb_process_pbj_filter_loop(cxt)) {
 		return FALSE;
 	}
-	for(cxt->pbj_op_index = 0; cxt->pbj_op_index < cxt->pbj_op_count; cxt->pbj_op_index++) {
-		cxt->pbj_op = &cxt->pbj_ops[cxt->pbj_op_index];
-		qb_set_source_op_index(cxt->compiler_context, cxt->loop_op_index + cxt->pbj_op_index, cxt->pbj_op_index);
-		if(!qb_process_current_pbj_instruction(cxt)) {
-			return FALSE;
-		}
-	}
-	if(!qb_end_pbj_filter_loop(cxt)) {
-		return FALSE;
+	cxt = qb_get_last_fused_pbj_stage(cxt);
+	if(cxt->next_stage) {
+		return qb_translate_pbj_instructions(cxt->next_stage);
 	}
 	return TRUE;
 }
@@ -1861,6 +2346,13 @@ void qb_initialize_pbj_translator_context(qb_pbj_translator_context *cxt, qb_com
 }
 
 void qb_free_pbj_translator_context(qb_pbj_translator_context *cxt) {
+	if(cxt->next_stage) {
+		qb_free_pbj_translator_context(cxt->next_stage);
+		efree(cxt->next_stage);
+	}
+	if(cxt->external_code) {
+		efree(cxt->external_code);
+	}
 }
 
 static uint32_t qb_pbj_get_channel_mask(qb_pbj_translator_context *cxt, qb_pbj_address *reg_address) {
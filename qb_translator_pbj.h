@@ -32,6 +32,7 @@ typedef struct qb_pbj_texture				qb_pbj_texture;
 typedef struct qb_pbj_op					qb_pbj_op;
 typedef struct qb_pbj_translator			qb_pbj_translator;
 typedef struct qb_pbj_register_slot			qb_pbj_register_slot;
+typedef struct qb_pbj_lane					qb_pbj_lane;
 
 typedef enum qb_pbj_opcode					qb_pbj_opcode;
 typedef enum qb_pbj_channel_id				qb_pbj_channel_id;
@@ -258,6 +259,23 @@ enum {
 	PBJ_ADDRESS_OVERLAP						= 5,
 };
 
+struct qb_pbj_lane {
+	qb_pbj_register *float_registers;
+	uint32_t float_register_count;
+
+	qb_pbj_register *int_registers;
+	uint32_t int_register_count;
+
+	qb_address *x_address;
+	qb_address *active_pixel_address;
+	qb_address *out_coord_address;
+	qb_address *out_coord_x_address;
+	qb_address *out_coord_y_address;
+	qb_address *output_image_pixel_address;
+};
+
+#define PBJ_MAX_LANE_COUNT			8
+
 struct qb_pbj_translator {
 	qb_pbj_translator_proc translate;
 	uint32_t flags;
@@ -298,6 +316,17 @@ struct qb_pbj_translator_context {
 	uint32_t loop_op_index;
 	uint32_t outer_loop_start_index;
 	uint32_t inner_loop_start_index;
+	uint32_t vector_loop_start_index;
+	uint32_t tail_loop_check_index;
+	uint32_t row_end_index;
+
+	qb_pbj_lane lanes[PBJ_MAX_LANE_COUNT];
+	uint32_t lane_count;
+	uint32_t lane_index;
+
+	qb_address *block_index_address;
+	qb_address *block_count_address;
+	qb_address *remainder_address;
 
 	qb_address *x_address;
 	qb_address *y_address;
@@ -309,6 +338,7 @@ struct qb_pbj_translator_context {
 	qb_address *output_image_channel_count_address;
 	qb_address *output_image_scanline_address;
 	qb_address *output_image_pixel_address;
+	qb_address *final_image_address;
 
 	qb_address *out_coord_address;
 	qb_address *out_coord_x_address;
@@ -326,6 +356,12 @@ struct qb_pbj_translator_context {
 
 	uint32_t thread_count;
 
+	qb_pbj_translator_context *previous_stage;
+	qb_pbj_translator_context *next_stage;
+	uint32_t op_index_base;
+	int32_t fused;
+	char *external_code;
+
 	void ***tsrm_ls;
 };
 
@@ -361,6 +397,7 @@ void qb_initialize_pbj_translator_context(qb_pbj_translator_context *cxt, qb_com
 void qb_free_pbj_translator_context(qb_pbj_translator_context *cxt);
 
 int32_t qb_decode_pbj_binary(qb_pbj_translator_context *cxt);
+int32_t qb_add_pbj_filter_stage(qb_pbj_translator_context *cxt, const char *import_path);
 int32_t qb_survey_pbj_instructions(qb_pbj_translator_context *cxt);
 int32_t qb_translate_pbj_instructions(qb_pbj_translator_context *cxt);
 
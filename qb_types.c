@@ -213,30 +213,72 @@ int32_t qb_uncompress_table(const char *data, void ***p_table, uint32_t *p_item_
 	}
 }
 
-void qb_create_block_allocator(qb_block_allocator **p_allocator, uint32_t item_size, uint32_t capacity) {
+static void qb_reallocate_memory_in_main_thread(void *param1, void *param2, int param3) {
+	void **p_memory = param1;
+	size_t *p_size = param2;
+	if(*p_memory) {
+		*p_memory = erealloc(*p_memory, *p_size);
+	} else {
+		*p_memory = emalloc(*p_size);
+	}
+}
+
+// emalloc() isn't thread-safe--these functions let worker threads in the compiler obtain memory through the main thread
+void * qb_allocate_memory(size_t size) {
+	return qb_reallocate_memory(NULL, size);
+}
+
+void * qb_reallocate_memory(void *memory, size_t size) {
+	qb_run_in_main_thread(qb_reallocate_memory_in_main_thread, &memory, &size, 0);
+	return memory;
+}
+
+static void * qb_allocate_pool_memory(size_t size, uint32_t flags) {
+	if(flags & QB_MEMORY_THREAD_ALLOCATED) {
+		// malloc() is thread-safe--no need to bother the main thread
+		return malloc(size);
+	} else {
+		return qb_allocate_memory(size);
+	}
+}
+
+static void qb_free_pool_memory(void *memory, uint32_t flags) {
+	if(flags & QB_MEMORY_THREAD_ALLOCATED) {
+		free(memory);
+	} else {
+		efree(memory);
+	}
+}
+
+static void qb_create_block(qb_block_allocator **p_allocator, uint32_t item_size, uint32_t capacity, uint32_t flags) {
 	uint32_t total_size = offsetof(qb_block_allocator, data) + (item_size * capacity);
-	qb_block_allocator *al = emalloc(total_size);
+	qb_block_allocator *al = qb_allocate_pool_memory(total_size, flags);
 	al->count = 0;
 	al->previous_block = NULL;
 	al->capacity = capacity;
 	al->item_size = item_size;
+	al->flags = flags;
 	al->top = al->data;
 	memset(al->data, 0, capacity * item_size);
 	*p_allocator = al;
 }
 
+void qb_create_block_allocator(qb_block_allocator **p_allocator, uint32_t item_size, uint32_t capacity) {
+	qb_create_block(p_allocator, item_size, capacity, 0);
+}
+
 void * qb_allocate_items(qb_block_allocator **p_allocator, uint32_t count) {
 	qb_block_allocator *al = *p_allocator;
 	void *pointer;
 	if(al->count + count > al->capacity) {
 		qb_block_allocator *new_block;
 		if(count > al->capacity) {
-			qb_create_block_allocator(&new_block, al->item_size, count);
+			qb_create_block(&new_block, al->item_size, count, al->flags);
 			new_block->previous_block = al->previous_block;
 			al->previous_block = new_block;
 			al = new_block;
 		} else {
-			qb_create_block_allocator(&new_block, al->item_size, al->capacity);
+			qb_create_block(&new_block, al->item_size, al->capacity, al->flags);
 			new_block->previous_block = al;
 			*p_allocator = al = new_block;
 		}
@@ -283,7 +325,7 @@ void qb_reset_block_allocator(qb_block_allocator **p_allocator) {
 	while(al->previous_block) {
 		bl = al;
 		al = al->previous_block;
-		efree(bl);
+		qb_free_pool_memory(bl, bl->flags);
 	}
 	al->count = 0;
 	memset(al->data, 0, al->capacity * al->item_size);
@@ -296,7 +338,7 @@ void qb_destroy_block_allocator(qb_block_allocator **p_allocator) {
 	while(al) {
 		bl = al;
 		al = al->previous_block;
-		efree(bl);
+		qb_free_pool_memory(bl, bl->flags);
 	}
 }
 
@@ -305,14 +347,16 @@ typedef struct qb_array_attributes {
 	uint32_t capacity;
 	uint32_t item_size;
 	uint32_t increment;
+	uint32_t flags;
 	char data[4];
 } qb_array_attributes;
 
 #define GET_ARRAY_ATTRIBUTES(p)		((qb_array_attributes *) ((char *) (p) - offsetof(qb_array_attributes, data)))
 
-void qb_create_array(void **p_array, uint32_t *p_count, uint32_t item_size, uint32_t initial_capacity) {
+static void qb_create_array_with_flags(void **p_array, uint32_t *p_count, uint32_t item_size, uint32_t initial_capacity, uint32_t flags) {
 	uint32_t total_size = offsetof(qb_array_attributes, data) + (item_size * initial_capacity);
-	qb_array_attributes *a = emalloc(total_size);
+	qb_array_attributes *a = qb_allocate_pool_memory(total_size, flags);
+	a->flags = flags;
 	a->item_size = item_size;
 	a->capacity = initial_capacity;
 	a->increment = (initial_capacity > 16) ? initial_capacity / 4 : 4;
@@ -322,6 +366,14 @@ void qb_create_array(void **p_array, uint32_t *p_count, uint32_t item_size, uint
 	*p_array = a->data;
 }
 
+void qb_create_array(void **p_array, uint32_t *p_count, uint32_t item_size, uint32_t initial_capacity) {
+	qb_create_array_with_flags(p_array, p_count, item_size, initial_capacity, 0);
+}
+
+void qb_create_pool_array(qb_data_pool *pool, void **p_array, uint32_t *p_count, uint32_t item_size, uint32_t initial_capacity) {
+	qb_create_array_with_flags(p_array, p_count, item_size, initial_capacity, pool->flags);
+}
+
 void * qb_enlarge_array(void **p_array, uint32_t addition) {
 	qb_array_attributes *a = GET_ARRAY_ATTRIBUTES(*p_array);
 	void *pointer;
@@ -334,7 +386,12 @@ void * qb_enlarge_array(void **p_array, uint32_t addition) {
 			a->capacity = new_count;
 		}
 		total_size = offsetof(qb_array_attributes, data) + (a->item_size * a->capacity);
-		a = erealloc(a, total_size);
+		if(a->flags & QB_MEMORY_THREAD_ALLOCATED) {
+			a = realloc(a, total_size);
+		} else {
+			// arrays from the shared pool still need to go through the main thread
+			a = qb_reallocate_memory(a, total_size);
+		}
 		a->increment = a->capacity / 4;
 		memset(a->data + (a->item_size * current_count), 0, a->item_size * (a->capacity - current_count));
 		*p_array = a->data;
@@ -347,31 +404,77 @@ void * qb_enlarge_array(void **p_array, uint32_t addition) {
 void qb_destroy_array(void **p_array) {
 	if(*p_array) {
 		qb_array_attributes *a = GET_ARRAY_ATTRIBUTES(*p_array);
-		efree(a);
+		qb_free_pool_memory(a, a->flags);
 	}
 }
 
-void qb_initialize_data_pool(qb_data_pool *pool) {
+static void qb_initialize_data_pool_with_flags(qb_data_pool *pool, uint32_t flags) {
 	memset(pool, 0, sizeof(qb_data_pool));
+	pool->flags = flags;
 
 	// have an array that keeps track of all other arrays
-	qb_create_array((void **) &pool->arrays, &pool->array_count, sizeof(void *), 64);
+	qb_create_pool_array(pool, (void **) &pool->arrays, &pool->array_count, sizeof(void *), 64);
 	
-	qb_create_block_allocator(&pool->op_allocator, sizeof(qb_op), 256);
-	qb_create_block_allocator(&pool->address_allocator, sizeof(qb_address), 1024);
-	qb_create_block_allocator(&pool->expression_allocator, sizeof(qb_expression), 256);
-	qb_create_block_allocator(&pool->pointer_allocator, sizeof(void *), 256);
-	qb_create_block_allocator(&pool->operand_allocator, sizeof(qb_operand), 1024);
-	qb_create_block_allocator(&pool->index_alias_scheme_allocator, sizeof(qb_index_alias_scheme), 16);
-	qb_create_block_allocator(&pool->string_allocator, sizeof(char), 1024);
-	qb_create_block_allocator(&pool->uint32_allocator, sizeof(uint32_t), 64);
-	qb_create_block_allocator(&pool->type_declaration_allocator, sizeof(qb_type_declaration), 256);
-	qb_create_block_allocator(&pool->variable_allocator, sizeof(qb_variable), 256);
-	qb_create_block_allocator(&pool->function_declaration_allocator, sizeof(qb_function_declaration), 16);
-	qb_create_block_allocator(&pool->class_declaration_allocator, sizeof(qb_class_declaration), 16);
-
-	qb_create_block_allocator(&pool->result_destination_allocator, sizeof(qb_result_destination), 64);
-	qb_create_block_allocator(&pool->array_initializer_allocator, sizeof(qb_array_initializer), 64);
+	qb_create_block(&pool->op_allocator, sizeof(qb_op), 256, flags);
+	qb_create_block(&pool->address_allocator, sizeof(qb_address), 1024, flags);
+	qb_create_block(&pool->expression_allocator, sizeof(qb_expression), 256, flags);
+	qb_create_block(&pool->pointer_allocator, sizeof(void *), 256, flags);
+	qb_create_block(&pool->operand_allocator, sizeof(qb_operand), 1024, flags);
+	qb_create_block(&pool->index_alias_scheme_allocator, sizeof(qb_index_alias_scheme), 16, flags);
+	qb_create_block(&pool->string_allocator, sizeof(char), 1024, flags);
+	qb_create_block(&pool->uint32_allocator, sizeof(uint32_t), 64, flags);
+	qb_create_block(&pool->type_declaration_allocator, sizeof(qb_type_declaration), 256, flags);
+	qb_create_block(&pool->variable_allocator, sizeof(qb_variable), 256, flags);
+	qb_create_block(&pool->function_declaration_allocator, sizeof(qb_function_declaration), 16, flags);
+	qb_create_block(&pool->class_declaration_allocator, sizeof(qb_class_declaration), 16, flags);
+
+	qb_create_block(&pool->result_destination_allocator, sizeof(qb_result_destination), 64, flags);
+	qb_create_block(&pool->array_initializer_allocator, sizeof(qb_array_initializer), 64, flags);
+}
+
+void qb_initialize_data_pool(qb_data_pool *pool) {
+	qb_initialize_data_pool_with_flags(pool, 0);
+}
+
+// pools used by only one worker thread can get their memory from malloc() directly
+void qb_initialize_thread_data_pool(qb_data_pool *pool) {
+	qb_initialize_data_pool_with_flags(pool, QB_MEMORY_THREAD_ALLOCATED);
+}
+
+static uint64_t qb_get_block_allocator_size(qb_block_allocator *al) {
+	uint64_t size = 0;
+	while(al) {
+		size += offsetof(qb_block_allocator, data) + (al->item_size * al->capacity);
+		al = al->previous_block;
+	}
+	return size;
+}
+
+uint64_t qb_get_data_pool_size(qb_data_pool *pool) {
+	uint64_t size = 0;
+	uint32_t i;
+	for(i = 0; i < pool->array_count; i++) {
+		void **array = pool->arrays[i];
+		if(*array) {
+			qb_array_attributes *a = GET_ARRAY_ATTRIBUTES(*array);
+			size += offsetof(qb_array_attributes, data) + (a->item_size * a->capacity);
+		}
+	}
+	size += qb_get_block_allocator_size(pool->op_allocator);
+	size += qb_get_block_allocator_size(pool->address_allocator);
+	size += qb_get_block_allocator_size(pool->expression_allocator);
+	size += qb_get_block_allocator_size(pool->pointer_allocator);
+	size += qb_get_block_allocator_size(pool->operand_allocator);
+	size += qb_get_block_allocator_size(pool->array_initializer_allocator);
+	size += qb_get_block_allocator_size(pool->index_alias_scheme_allocator);
+	size += qb_get_block_allocator_size(pool->string_allocator);
+	size += qb_get_block_allocator_size(pool->uint32_allocator);
+	size += qb_get_block_allocator_size(pool->type_declaration_allocator);
+	size += qb_get_block_allocator_size(pool->variable_allocator);
+	size += qb_get_block_allocator_size(pool->function_declaration_allocator);
+	size += qb_get_block_allocator_size(pool->class_declaration_allocator);
+	size += qb_get_block_allocator_size(pool->result_destination_allocator);
+	return size;
 }
 
 void qb_free_data_pool(qb_data_pool *pool) {
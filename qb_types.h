@@ -60,6 +60,7 @@ typedef enum qb_primitive_type				qb_primitive_type;
 #define STORAGE_TYPE_MATCH(type1, type2)	((type1 == type2) || ((type1 & ~QB_TYPE_UNSIGNED) == (type2 & ~QB_TYPE_UNSIGNED) && (type1 < QB_TYPE_F32)))
 
 #define BYTE_COUNT(element_count, type)		((uint32_t) ((element_count) << type_size_shifts[type]))
+#define BYTE_COUNT64(element_count, type)	(((uint64_t) (element_count)) << type_size_shifts[type])
 #define ELEMENT_COUNT(byte_count, type)		((byte_count) >> type_size_shifts[type])
 
 #define SHIFT_POINTER(p, shift)				p = (void *) (((char *) (p)) + shift)
@@ -177,11 +178,8 @@ static zend_always_inline int32_t qb_clamp_float32_0_255(float32_t f) {
 #ifdef FAST_FLOAT_TO_INT
 	int32_t n = (int32_t) (f * 255);
 	if(UNEXPECTED((uint32_t) n > 255)) {
-		if(n < 0) {
-			n = 0;
-		} else {
-			n = 255;
-		}
+		// out-of-range values and NaN convert to INT32_MIN, so look at the float instead
+		n = (f > 0) ? 255 : 0;
 	}
 	return n;
 #else
@@ -199,11 +197,7 @@ static zend_always_inline int32_t qb_clamp_float64_0_255(float64_t f) {
 #ifdef FAST_FLOAT_TO_INT
 	int32_t n = (int32_t) (f * 255);
 	if(UNEXPECTED((uint32_t) n > 255)) {
-		if(n < 0) {
-			n = 0;
-		} else {
-			n = 255;
-		}
+		n = (f > 0) ? 255 : 0;
 	}
 	return n;
 #else
@@ -221,11 +215,7 @@ static zend_always_inline int32_t qb_clamp_float32_0_127(float32_t f) {
 #ifdef FAST_FLOAT_TO_INT
 	int32_t n = (int32_t) (f * 127);
 	if(UNEXPECTED((uint32_t) n > 127)) {
-		if(n < 0) {
-			n = 0;
-		} else {
-			n = 127;
-		}
+		n = (f > 0) ? 127 : 0;
 	}
 	return n;
 #else
@@ -243,11 +233,7 @@ static zend_always_inline int32_t qb_clamp_float64_0_127(float64_t f) {
 #ifdef FAST_FLOAT_TO_INT
 	int32_t n = (int32_t) (f * 127);
 	if(UNEXPECTED((uint32_t) n > 127)) {
-		if(n < 0) {
-			n = 0;
-		} else {
-			n = 127;
-		}
+		n = (f > 0) ? 127 : 0;
 	}
 	return n;
 #else
@@ -263,16 +249,24 @@ static zend_always_inline int32_t qb_clamp_float64_0_127(float64_t f) {
 
 int32_t qb_uncompress_table(const char *data, void ***p_table, uint32_t *p_item_count, int32_t persistent);
 
+enum {
+	// memory came from malloc() and not emalloc(), so worker threads can allocate it without going through the main thread
+	QB_MEMORY_THREAD_ALLOCATED		= 0x00000001,
+};
+
 struct qb_block_allocator {
 	uint32_t count;
 	uint32_t capacity;
 	uint32_t item_size;
+	uint32_t flags;
 	qb_block_allocator *previous_block;
 	char *top;
 	char data[4];
 };
 
 struct qb_data_pool {
+	uint32_t flags;
+
 	void ***arrays;
 	uint32_t array_count;
 
@@ -305,12 +299,16 @@ struct qb_data_pool {
 	uint32_t pbj_op_name_count;
 };
 
+void * qb_allocate_memory(size_t size);
+void * qb_reallocate_memory(void *memory, size_t size);
+
 void qb_create_block_allocator(qb_block_allocator **p_allocator, uint32_t item_size, uint32_t capacity);
 void * qb_allocate_items(qb_block_allocator **p_allocator, uint32_t count);
 void * qb_reallocate_items(qb_block_allocator **p_allocator, void *current, uint32_t current_count, uint32_t new_count);
 void qb_destroy_block_allocator(qb_block_allocator **p_allocator);
 
 void qb_create_array(void **p_array, uint32_t *p_count, uint32_t item_size, uint32_t increment);
+void qb_create_pool_array(qb_data_pool *pool, void **p_array, uint32_t *p_count, uint32_t item_size, uint32_t increment);
 void * qb_enlarge_array(void **p_array, uint32_t count);
 void qb_destroy_array(void **p_array);
 
@@ -323,7 +321,9 @@ uint64_t qb_calculate_crc64(const uint8_t *buf, size_t size, uint64_t crc);
 double qb_get_high_res_timestamp(void);
 
 void qb_initialize_data_pool(qb_data_pool *pool);
+void qb_initialize_thread_data_pool(qb_data_pool *pool);
 void qb_free_data_pool(qb_data_pool *pool);
+uint64_t qb_get_data_pool_size(qb_data_pool *pool);
 
 // Copyright (c) 2008-2010 Bjoern Hoehrmann <bjoern@hoehrmann.de>
 // See http://bjoern.hoehrmann.de/utf-8/decoder/dfa/ for details.
@@ -0,0 +1,65 @@
+--TEST--
+Argument by ref test (array not modified)
+--FILE--
+<?php 
+
+/**
+ * A test function
+ *
+ * @engine	qb 
+ * @param	int32[*]	$a
+ * @param	int32[*]	$b
+ * @param	bool		$change
+ *
+ * @return	int32
+ *
+ */
+function test_function(&$a, &$b, $change) {
+	if($change) {
+		$b[0] = 100;
+	}
+	return array_sum($a) + array_sum($b);
+}
+
+// small arrays are always converted back to the declared type
+$a = array("1", "2", "3");
+$b = array("4", "5", "6");
+
+echo test_function($a, $b, false), "\n";
+var_dump($a, $b);
+
+// large arrays are left alone unless they were changed
+$a = array_fill(0, 20000, "1");
+$b = array_fill(0, 20000, "2");
+
+echo test_function($a, $b, false), "\n";
+var_dump($a[0], $b[0]);
+echo test_function($a, $b, true), "\n";
+var_dump($a[0], $b[0], $b[1]);
+
+?>
+--EXPECT--
+21
+array(3) {
+  [0]=>
+  int(1)
+  [1]=>
+  int(2)
+  [2]=>
+  int(3)
+}
+array(3) {
+  [0]=>
+  int(4)
+  [1]=>
+  int(5)
+  [2]=>
+  int(6)
+}
+60000
+string(1) "1"
+string(1) "2"
+60098
+string(1) "1"
+int(100)
+int(2)
@@ -0,0 +1,56 @@
+--TEST--
+Background native compilation test
+--SKIPIF--
+<?php
+	if(strtoupper(substr(PHP_OS, 0, 3)) != 'WIN' && !trim(shell_exec('which cc gcc clang tcc 2>/dev/null'))) print 'skip C compiler not available';
+?>
+--INI--
+qb.allow_native_compilation=1
+qb.compile_to_native=1
+qb.background_native_compilation=1
+qb.trace_build=1
+--FILE--
+<?php
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	float64[]	$a
+ *
+ * @return	float64
+ *
+ */
+function sum_of_squares($a) {
+	$sum = 0;
+	foreach($a as $value) {
+		$sum += $value * $value;
+	}
+	return $sum;
+}
+
+$a = array(1, 2, 3, 4);
+$total = 0;
+for($i = 0; $i < 200; $i++) {
+	$total += sum_of_squares($a);
+	usleep(1000);
+}
+echo $total, "\n";
+
+// the function keeps running as bytecode until the compiler is done
+$start = time();
+do {
+	sum_of_squares($a);
+	$builds = qb_get_build_trace();
+	if(!$builds[0]['native_code']) {
+		usleep(10000);
+	}
+} while(!$builds[0]['native_code'] && time() - $start < 60);
+echo $builds[0]['native_code'] ? "native" : "bytecode", "\n";
+echo sum_of_squares($a), "\n";
+
+?>
+--EXPECT--
+6000
+native
+30
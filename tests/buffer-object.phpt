@@ -0,0 +1,93 @@
+--TEST--
+QBBuffer test
+--FILE--
+<?php
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	float32[*][2]	$points
+ * @param	float32			$x
+ * @param	float32			$y
+ *
+ * @return	void
+ *
+ */
+function add_point(&$points, $x, $y) {
+	$points[] = array($x, $y);
+}
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	float32[*][2]	$points
+ *
+ * @return	float32
+ *
+ */
+function sum_points($points) {
+	return array_sum($points);
+}
+
+$points = new QBBuffer("float32", 1, 2);
+echo $points->getType(), "\n";
+print_r($points->getDimensions());
+
+add_point($points, 1.5, 2.5);
+add_point($points, 3, 4);
+echo get_class($points), "\n";
+print_r($points->getDimensions());
+echo sum_points($points), "\n";
+print_r(unpack("f*", $points->getData()));
+
+$copy = clone $points;
+add_point($copy, 5, 6);
+print_r($points->getDimensions());
+print_r($copy->getDimensions());
+
+$points->setData(pack("f*", 1, 2, 3, 4, 5, 6, 7, 8));
+print_r($points->getDimensions());
+echo sum_points($points), "\n";
+
+?>
+--EXPECT--
+float32
+Array
+(
+    [0] => 1
+    [1] => 2
+)
+QBBuffer
+Array
+(
+    [0] => 3
+    [1] => 2
+)
+11
+Array
+(
+    [1] => 0
+    [2] => 0
+    [3] => 1.5
+    [4] => 2.5
+    [5] => 3
+    [6] => 4
+)
+Array
+(
+    [0] => 3
+    [1] => 2
+)
+Array
+(
+    [0] => 4
+    [1] => 2
+)
+Array
+(
+    [0] => 4
+    [1] => 2
+)
+36
@@ -0,0 +1,76 @@
+--TEST--
+Build trace test
+--INI--
+qb.trace_build=1
+--FILE--
+<?php
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	float32[]	$a
+ * @param	float32		$b
+ *
+ * @return	float32[]
+ *
+ */
+function test_function($a, $b) {
+	return $a * $b + 1;
+}
+
+class TestClass {
+
+	/**
+	 * A test function
+	 *
+	 * @engine	qb
+	 * @param	int32	$a
+	 *
+	 * @return	int32
+	 *
+	 */
+	static function test_method($a) {
+		return $a * 2;
+	}
+}
+
+print_r(test_function(array(1, 2, 3), 2));
+echo TestClass::test_method(4), "\n";
+
+$builds = qb_get_build_trace();
+echo count($builds), "\n";
+$build = $builds[0];
+echo implode(", ", array_keys($build['phases'])), "\n";
+echo ($build['total_time'] >= array_sum($build['phases'])) ? "OK" : "Wrong total", "\n";
+echo ($build['pool_memory'] > 0) ? "OK" : "No memory", "\n";
+var_dump($build['cached']);
+$names = array();
+foreach($build['functions'] as $function) {
+	$names[] = $function['name'];
+	if($function['op_count'] <= 0 || $function['optimized_op_count'] > $function['op_count']) {
+		echo "Wrong op count: {$function['name']}\n";
+	}
+}
+sort($names);
+print_r($names);
+
+?>
+--EXPECT--
+Array
+(
+    [0] => 3
+    [1] => 5
+    [2] => 7
+)
+8
+1
+cache_lookup, parsing, initialization, translation, optimization, encoding, native_compilation, cache_saving
+OK
+OK
+bool(false)
+Array
+(
+    [0] => TestClass::test_method
+    [1] => test_function
+)
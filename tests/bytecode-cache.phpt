@@ -0,0 +1,89 @@
+--TEST--
+Bytecode cache test
+--SKIPIF--
+<?php
+	if(!getenv('TEST_PHP_EXECUTABLE') && !defined('PHP_BINARY')) print 'skip PHP executable not known';
+?>
+--FILE--
+<?php
+
+$folder = dirname(__FILE__) . "/bytecode-cache";
+$script_path = dirname(__FILE__) . "/bytecode-cache.inc.php";
+@mkdir($folder);
+foreach(glob("$folder/QB*.qbc") as $path) {
+	unlink($path);
+}
+
+file_put_contents($script_path, <<<'SCRIPT'
+<?php
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	float32[4]		$a
+ * @param	float32			$factor
+ * @local	float32[4]		$b
+ *
+ * @return	float32[4]
+ *
+ */
+function test_function($a, $factor = 2) {
+	$b = array(1, 2, 3, 4);
+	return $a * $b * $factor;
+}
+
+echo implode(" ", test_function(array(1, 1, 1, 1))), "\n";
+echo implode(" ", test_function(array(1, 2, 3, 4), 0.5)), "\n";
+$trace = qb_get_build_trace();
+echo "cached: ", ($trace[0]['cached'] ? "yes" : "no"), "\n";
+
+?>
+SCRIPT
+);
+
+// the in-memory cache only lives as long as the process, so each run gets its own
+$php = getenv('TEST_PHP_EXECUTABLE');
+if(!$php) {
+	$php = PHP_BINARY;
+}
+$php = escapeshellarg($php);
+$args = "-d qb.allow_bytecode_cache=1 -d qb.trace_build=1 -d " . escapeshellarg("qb.native_code_cache_path=$folder");
+if(trim(shell_exec("$php -r \"echo extension_loaded('qb') ? 1 : 0;\"")) != "1") {
+	$args .= " -d " . escapeshellarg("extension_dir=" . ini_get('extension_dir')) . " -d extension=qb." . PHP_SHLIB_SUFFIX;
+}
+
+// the first run builds the function and saves it; the second one restores it from the file
+echo shell_exec("$php $args " . escapeshellarg($script_path));
+echo "files: ", count(glob("$folder/QB*.qbc")), "\n";
+echo shell_exec("$php $args " . escapeshellarg($script_path));
+
+// a damaged file is rejected and built again
+foreach(glob("$folder/QB*.qbc") as $path) {
+	$data = file_get_contents($path);
+	$data[strlen($data) - 1] = chr(ord($data[strlen($data) - 1]) ^ 0xFF);
+	file_put_contents($path, $data);
+}
+echo shell_exec("$php $args " . escapeshellarg($script_path));
+
+?>
+--CLEAN--
+<?php
+$folder = dirname(__FILE__) . "/bytecode-cache";
+foreach(glob("$folder/QB*.qbc") as $path) {
+	unlink($path);
+}
+@rmdir($folder);
+@unlink(dirname(__FILE__) . "/bytecode-cache.inc.php");
+?>
+--EXPECT--
+2 4 6 8
+0.5 2 4.5 8
+cached: no
+files: 1
+2 4 6 8
+0.5 2 4.5 8
+cached: yes
+2 4 6 8
+0.5 2 4.5 8
+cached: no
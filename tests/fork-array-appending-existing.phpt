@@ -0,0 +1,43 @@
+--TEST--
+Array appending test (in forked path, array not empty at fork)
+--INI--
+qb.thread_count=4
+--FILE--
+<?php
+
+/**
+ * A test function
+ * 
+ * @engine	qb
+ * @local	int32[*]	$a
+ * @local	uint32		$(i|j)
+ * @local	int32		$total
+ * @return	void
+ * 
+ */
+function test_function() {
+	// each fork gets its own copy of the contents, which it then enlarges
+	for($j = 0; $j < 16; $j++) {
+		$a[] = $j;
+	}
+	$i = fork(4);
+	for($j = 0; $j < 5000; $j++) {
+		$a[] = $i;
+	}
+	$total = array_sum($a) - 120 - 5000 * $i;
+	echo count($a), " $total\n";
+}
+
+test_function();
+test_function();
+
+?>
+--EXPECT--
+5016 0
+5016 0
+5016 0
+5016 0
+5016 0
+5016 0
+5016 0
+5016 0
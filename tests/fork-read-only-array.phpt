@@ -0,0 +1,36 @@
+--TEST--
+Fork test (array read but not written in forked path)
+--FILE--
+<?php
+
+/**
+ * A test function
+ * 
+ * @engine	qb
+ * @param	float64[*]	$a
+ * @local	float64[*]	$b
+ * @local	float64		$sum
+ * @local	uint32		$(i|j|start|end)
+ * @return	void
+ * 
+ */
+function test_function($a) {
+	$b = $a * 2;
+	$i = fork(4);
+	$start = $i * 25000;
+	$end = $start + 25000;
+	$sum = 0;
+	for($j = $start; $j < $end; $j++) {
+		$sum += $b[$j] - $a[$j];
+	}
+	echo "$i: $sum\n";
+}
+
+test_function(range(1, 100000));
+
+?>
+--EXPECTREGEX--
+[0-3]: (312512500|937512500|1562512500|2187512500)
+[0-3]: (312512500|937512500|1562512500|2187512500)
+[0-3]: (312512500|937512500|1562512500|2187512500)
+[0-3]: (312512500|937512500|1562512500|2187512500)
@@ -0,0 +1,94 @@
+--TEST--
+Alternating calls to non-inlined functions test
+--FILE--
+<?php
+
+/**
+ * @engine qb
+ * @inline never
+ * @param int32	$x
+ * @return int32
+ */
+function add_one($x) {
+	return $x + 1;
+}
+
+/**
+ * @engine qb
+ * @inline never
+ * @param int32	$x
+ * @return int32
+ */
+function double_it($x) {
+	return $x * 2;
+}
+
+/**
+ * @engine qb
+ * @inline never
+ * @param int32	$x
+ * @return int32
+ */
+function subtract_three($x) {
+	return $x - 3;
+}
+
+/**
+ * @engine qb
+ * @inline never
+ * @param int32	$x
+ * @return int32
+ */
+function square($x) {
+	return $x * $x;
+}
+
+/**
+ * @engine qb
+ * @inline never
+ * @param int32	$x
+ * @return int32
+ */
+function mod_seven($x) {
+	return $x % 7;
+}
+
+/**
+ * @engine qb
+ * @inline never
+ * @param int32	$n
+ * @return int32
+ */
+function fibonacci($n) {
+	if($n < 2) {
+		return $n;
+	}
+	return fibonacci($n - 1) + fibonacci($n - 2);
+}
+
+/**
+ * @engine qb
+ * @return void
+ */
+function test_function() {
+	$a = 0;
+	$b = 0;
+	// two callees taking turns
+	for($i = 0; $i < 100; $i++) {
+		$a += add_one($i);
+		$a += double_it($i);
+	}
+	// more callees than the caller keeps copies of
+	for($i = 0; $i < 20; $i++) {
+		$b += add_one($i) + double_it($i) + subtract_three($i) + square($i) + mod_seven($i);
+	}
+	echo "$a $b ", fibonacci(15), "\n";
+}
+
+test_function();
+test_function();
+
+?>
+--EXPECT--
+14950 3247 610
+14950 3247 610
@@ -0,0 +1,53 @@
+--TEST--
+Function call in loop test
+--FILE--
+<?php
+
+/**
+ * @engine qb
+ * @param float32	$x
+ * @return float32
+ */
+function square($x) {
+	return $x * $x;
+}
+
+/**
+ * @engine qb
+ * @param int32	$n
+ * @return int32
+ */
+function collatz_steps($n) {
+	$steps = 0;
+	while($n != 1) {
+		if($n % 2) {
+			$n = $n * 3 + 1;
+		} else {
+			$n = $n >> 1;
+		}
+		$steps++;
+	}
+	return $steps;
+}
+
+/**
+ * @engine qb
+ * @return void
+ */
+function test_function() {
+	$sum = 0;
+	$total = 0;
+	for($i = 1; $i <= 10; $i++) {
+		$sum += square($i);
+		$total += collatz_steps($i);
+	}
+	echo "$sum $total\n";
+	echo square(12), " ", collatz_steps(27), "\n";
+}
+
+test_function();
+
+?>
+--EXPECT--
+385 67
+144 111
@@ -0,0 +1,36 @@
+--TEST--
+Image passed by reference (uint32)
+--EXTENSIONS--
+gd
+--SKIPIF--
+<?php 
+	if(!function_exists('imagecreatetruecolor')) print 'skip GD not available';
+?>
+--FILE--
+<?php
+
+$image = imagecreatetruecolor(5, 3);
+imagesetpixel($image, 1, 1, 0x00FF8040);
+
+/**
+ * @engine qb
+ * @param uint32[][]		$image
+ */
+function invert(&$image) {
+	$image = ~$image & 0x00FFFFFF;
+}
+
+invert($image);
+
+for($y = 0; $y < 3; $y++) {
+	for($x = 0; $x < 5; $x++) {
+		printf("%06X ", imagecolorat($image, $x, $y));
+	}
+	echo "\n";
+}
+
+?>
+--EXPECT--
+FFFFFF FFFFFF FFFFFF FFFFFF FFFFFF 
+FFFFFF 007FBF FFFFFF FFFFFF FFFFFF 
+FFFFFF FFFFFF FFFFFF FFFFFF FFFFFF 
@@ -0,0 +1,53 @@
+--TEST--
+Saturation of out-of-range floats written to an image
+--EXTENSIONS--
+gd
+--SKIPIF--
+<?php
+	if(!function_exists('imagecreatetruecolor')) print 'skip GD not available';
+?>
+--FILE--
+<?php
+
+// the first four pixels of a scanline go through the SSE2 code path, the last two don't
+$pixels = array(
+	array(INF, 1e10, -INF, 1),
+	array(NAN, 2.0, -1.0, INF),
+	array(1e30, -1e30, 0, -INF),
+	array(0, 0, 0, 1),
+	array(INF, 1e10, -INF, 1),
+	array(NAN, 2.0, -1.0, INF),
+);
+
+/**
+ * @engine qb
+ * @param image				$image
+ * @param float32[6][4]		$pixels
+ */
+function fill_f32(&$image, $pixels) {
+	$image[0] = $pixels;
+}
+
+/**
+ * @engine qb
+ * @param float64[][][4]	$image
+ * @param float64[6][4]		$pixels
+ */
+function fill_f64(&$image, $pixels) {
+	$image[0] = $pixels;
+}
+
+foreach(array('fill_f32', 'fill_f64') as $function) {
+	$image = imagecreatetruecolor(6, 1);
+	$function($image, $pixels);
+	$colors = array();
+	for($x = 0; $x < 6; $x++) {
+		$colors[] = sprintf("%08X", imagecolorat($image, $x, 0));
+	}
+	echo implode(" ", $colors), "\n";
+}
+
+?>
+--EXPECT--
+00FFFF00 0000FF00 7FFF0000 00000000 00FFFF00 0000FF00
+00FFFF00 0000FF00 7FFF0000 00000000 00FFFF00 0000FF00
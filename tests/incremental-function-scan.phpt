@@ -0,0 +1,60 @@
+--TEST--
+Incremental function scan test
+--FILE--
+<?php
+
+/**
+ * A test function
+ * 
+ * @engine	qb
+ * @param	int32	$a
+ *
+ * @return	int32
+ * 
+ */
+function test_function1($a) {
+	return $a + 1;
+}
+
+echo test_function1(1), "\n";
+
+if(true) {
+	/**
+	 * A test function
+	 * 
+	 * @engine	qb
+	 * @param	int32	$a
+	 *
+	 * @return	int32
+	 * 
+	 */
+	function test_function2($a) {
+		return $a + 2;
+	}
+
+	class TestClass {
+		/**
+		 * A test function
+		 * 
+		 * @engine	qb
+		 * @param	int32	$a
+		 *
+		 * @return	int32
+		 * 
+		 */
+		static function test($a) {
+			return $a + 3;
+		}
+	}
+}
+
+echo test_function2(1), "\n";
+echo TestClass::test(1), "\n";
+echo test_function1(2), "\n";
+
+?>
+--EXPECT--
+2
+3
+4
+3
@@ -0,0 +1,35 @@
+--TEST--
+Array reserve test
+--FILE--
+<?php
+
+/**
+ * A test function
+ * 
+ * @engine	qb
+ * @local	int32[*]		$a
+ * @local	float32[*][2]	$b
+ * @local	int32			$i
+ *
+ * @return	void
+ * 
+ */
+function test_function() {
+	array_reserve($a, 5000);
+	array_reserve($b, 100);
+	for($i = 0; $i < 5000; $i++) {
+		$a[] = $i;
+	}
+	for($i = 0; $i < 3; $i++) {
+		$b[] = array($i, $i * 2);
+	}
+	echo count($a), " ", $a[4999], "\n";
+	echo "$b\n";
+}
+
+test_function();
+
+?>
+--EXPECT--
+5000 4999
+[[0, 0], [1, 2], [2, 4]]
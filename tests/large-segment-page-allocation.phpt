@@ -0,0 +1,32 @@
+--TEST--
+Large segment page allocation test
+--INI--
+qb.large_segment_threshold=65536
+--FILE--
+<?php
+
+/**
+ * A test function
+ * 
+ * @engine	qb
+ * @param	int32[*]		$a
+ * @local	int32			$i
+ *
+ * @return	void
+ * 
+ */
+function test_function(&$a) {
+	for($i = 0; $i < 100000; $i++) {
+		$a[] = $i;
+	}
+	echo count($a), " ", $a[70002], " ", $a[99999], "\n";
+}
+
+$a = array(1, 2, 3);
+test_function($a);
+echo count($a), " ", $a[16384], " ", $a[100002], "\n";
+
+?>
+--EXPECT--
+100003 69999 99996
+100003 16381 99999
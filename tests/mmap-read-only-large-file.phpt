@@ -0,0 +1,51 @@
+--TEST--
+Memory-map file test (read-only, larger than 4G)
+--SKIPIF--
+<?php 
+if(PHP_INT_SIZE < 8) print "skip 64-bit only";
+?>
+--FILE--
+<?php
+
+/**
+ * A test function
+ * 
+ * @engine	qb
+ * @param	uint64[]	$a
+ * @local	uint32		$i
+ * @local	uint64		$sum
+ * 
+ * @return	void
+ * 
+ */
+function test_function($a) {
+	echo "Length: ", sizeof($a), "\n";
+	$sum = 0;
+	for($i = 536870000; $i < 536871000; $i++) {
+		$sum += $a[$i];
+	}
+	echo "Sum: $sum\n";
+	echo "Last: {$a[sizeof($a) - 1]}\n";
+}
+
+// create a sparse file of 5G
+$path = __FILE__ . ".dat";
+$handle = fopen($path, "w+b");
+fseek($handle, 4294967296 + 8, SEEK_SET);
+fwrite($handle, pack("V2", 1234, 0));
+fseek($handle, 4294967296 * 5 / 4 - 8, SEEK_SET);
+fwrite($handle, pack("V2", 5678, 0));
+fclose($handle);
+
+$handle = fopen($path, "rb");
+test_function($handle);
+fclose($handle);
+unlink($path);
+
+// assume little endian
+
+?>
+--EXPECT--
+Length: 671088640
+Sum: 1234
+Last: 5678
@@ -0,0 +1,70 @@
+--TEST--
+Native compilation threshold test
+--SKIPIF--
+<?php
+	if(strtoupper(substr(PHP_OS, 0, 3)) != 'WIN' && !trim(shell_exec('which cc gcc clang tcc 2>/dev/null'))) print 'skip C compiler not available';
+?>
+--INI--
+qb.allow_native_compilation=1
+qb.native_compilation_threshold=10
+qb.trace_build=1
+--FILE--
+<?php
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	int32	$n
+ *
+ * @return	int32
+ *
+ */
+function triangle($n) {
+	$sum = 0;
+	for($i = 1; $i <= $n; $i++) {
+		$sum += $i;
+	}
+	return $sum;
+}
+
+/**
+ * A function with a static variable, which must not be rebuilt
+ *
+ * @engine	qb
+ * @static	int32	$count
+ *
+ * @return	int32
+ *
+ */
+function counter() {
+	static $count = 0;
+	return ++$count;
+}
+
+$total = 0;
+for($i = 0; $i < 50; $i++) {
+	$total += triangle($i);
+	counter();
+}
+echo $total, "\n";
+echo triangle(100), "\n";
+echo counter(), "\n";
+
+// the first build happens when the functions are first called; the hot ones are rebuilt as native code afterward
+$builds = qb_get_build_trace();
+$native_build = end($builds);
+$names = array();
+foreach($native_build['functions'] as $function) {
+	$names[] = $function['name'];
+}
+echo implode(", ", $names), "\n";
+echo ($native_build['native_compiler'] !== null && $native_build['phases']['native_compilation'] > 0) ? "native" : "bytecode", "\n";
+
+?>
+--EXPECT--
+20825
+5050
+51
+triangle
+native
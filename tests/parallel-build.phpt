@@ -0,0 +1,74 @@
+--TEST--
+Parallel build test
+--INI--
+qb.thread_count=4
+--FILE--
+<?php
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	int32	$n
+ *
+ * @return	int32
+ *
+ */
+function factorial($n) {
+	return ($n > 1) ? $n * factorial($n - 1) : 1;
+}
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	int32	$n
+ *
+ * @return	int32
+ *
+ */
+function fibonacci($n) {
+	return ($n > 1) ? fibonacci($n - 1) + fibonacci($n - 2) : $n;
+}
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	float32[]	$a
+ *
+ * @return	float32
+ *
+ */
+function average($a) {
+	return array_sum($a) / count($a);
+}
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	int32	$n
+ *
+ * @return	int32
+ *
+ */
+function sum_factorials($n) {
+	$sum = 0;
+	for($i = 1; $i <= $n; $i++) {
+		$sum += factorial($i);
+	}
+	return $sum;
+}
+
+echo factorial(6), "\n";
+echo fibonacci(10), "\n";
+echo average(array(1, 2, 3, 4)), "\n";
+echo sum_factorials(5), "\n";
+
+?>
+--EXPECT--
+720
+55
+2.5
+153
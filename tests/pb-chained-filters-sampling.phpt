@@ -0,0 +1,67 @@
+--TEST--
+Pixel Bender test: Chained filters with neighborhood sampling
+--EXTENSIONS--
+gd
+--SKIPIF--
+<?php 
+	if(!function_exists('imagepng')) print 'skip PNG function not available';
+?>
+--FILE--
+<?php
+
+$folder = dirname(__FILE__);
+$image = imagecreatefrompng("$folder/input/malgorzata_socha.png");
+$output1 = imagecreatetruecolor(imagesx($image), imagesy($image));
+$output2 = imagecreatetruecolor(imagesx($image), imagesy($image));
+
+/**
+ * @engine qb
+ * @import pbj/invert-rgb.pbj
+ * @import pbj/simple-box-blur.pbj
+ * @import pbj/invert-rgb.pbj
+ *
+ * @param image			$dst
+ * @param image			$src
+ */
+function filter_chain(&$dst, $src) {
+}
+
+/**
+ * @engine qb
+ * @import pbj/simple-box-blur.pbj
+ *
+ * @param image			$dst
+ * @param image			$src
+ */
+function filter_blur(&$dst, $src) {
+}
+
+// the blur samples the neighboring pixels, so it gets the full result of the 
+// first inversion; the second inversion runs in the same loop as the blur
+filter_chain($output1, $image);
+filter_blur($output2, $image);
+
+/**
+ * @engine qb
+ *
+ * @param image	$img2;
+ * @param image	$img1;
+ * @return float32
+ */
+function _image_diff($img1, $img2) {
+	$img2 -= $img1;
+	$img2 *= $img2;
+	return sqrt(array_sum($img2));
+}
+
+// blurring is linear, so inverting before and after it should make no difference
+$diff = _image_diff($output1, $output2);
+if($diff < 3) {
+	echo "CORRECT\n";
+} else {
+	echo "INCORRECT (diff = $diff)\n";
+}
+
+?>
+--EXPECT--
+CORRECT
@@ -0,0 +1,52 @@
+--TEST--
+Pixel Bender test: Chained filters
+--EXTENSIONS--
+gd
+--SKIPIF--
+<?php 
+	if(!function_exists('imagepng')) print 'skip PNG function not available';
+?>
+--FILE--
+<?php
+
+$folder = dirname(__FILE__);
+$image = imagecreatefrompng("$folder/input/malgorzata_socha.png");
+$output = imagecreatetruecolor(imagesx($image), imagesy($image));
+
+/**
+ * @engine qb
+ * @import pbj/invert-rgb.pbj
+ * @import pbj/invert-rgb.pbj
+ *
+ * @param image			$dst
+ * @param image			$src
+ */
+function filter(&$dst, $src) {
+}
+
+filter($output, $image);
+
+/**
+ * @engine qb
+ *
+ * @param image	$img2;
+ * @param image	$img1;
+ * @return float32
+ */
+function _image_diff($img1, $img2) {
+	$img2 -= $img1;
+	$img2 *= $img2;
+	return sqrt(array_sum($img2));
+}
+
+// inverting twice should yield the original image
+$diff = _image_diff($output, $image);
+if($diff < 3) {
+	echo "CORRECT\n";
+} else {
+	echo "INCORRECT (diff = $diff)\n";
+}
+
+?>
+--EXPECT--
+CORRECT
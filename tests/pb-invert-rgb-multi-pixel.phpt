@@ -0,0 +1,85 @@
+--TEST--
+Pixel Bender test: Invert RGB (multiple pixels per iteration)
+--INI--
+qb.pbj_pixels_per_iteration=4
+--EXTENSIONS--
+gd
+--SKIPIF--
+<?php 
+	if(!function_exists('imagepng')) print 'skip PNG function not available';
+?>
+--FILE--
+<?php
+
+$filter_name = "invert-rgb";
+$folder = dirname(__FILE__);
+$image = imagecreatefrompng("$folder/input/malgorzata_socha.png");
+$output = imagecreatetruecolor(imagesx($image), imagesy($image));
+$correct_path = "$folder/output/$filter_name.correct.png";
+$incorrect_path = "$folder/output/$filter_name.incorrect.png";
+
+/**
+ * @engine qb
+ * @import pbj/invert-rgb.pbj
+ *
+ * @param image			$dst
+ * @param image			$src
+ */
+function filter(&$dst, $src) {
+}
+
+filter($output, $image);
+
+ob_start();
+imagesavealpha($output, true);
+imagepng($output);
+$output_png = ob_get_clean();
+
+/**
+ * @engine qb
+ *
+ * @param image	$img2;
+ * @param image	$img1;
+ * @return float32
+ */
+function _image_diff($img1, $img2) {
+	$img2 -= $img1;
+	$img2 *= $img2;
+	return sqrt(array_sum($img2));
+}
+
+if(file_exists($correct_path)) {
+	$correct_md5 = md5_file($correct_path);
+	$output_md5 = md5($output_png);
+	if($correct_md5 == $output_md5) {
+		// exact match
+		$match = true;
+	} else {
+		$correct_output = imagecreatefrompng($correct_path);
+		$diff = _image_diff($output, $correct_output);
+		if($diff < 3) {
+			// the output is different ever so slightly
+			$match = true;
+		} else {
+			$match = false;
+		}
+	}
+	if($match) {
+		echo "CORRECT\n";
+		if(file_exists($incorrect_path)) {
+			unlink($incorrect_path);
+		}
+	} else {
+		echo "INCORRECT (diff = $diff)\n";
+		file_put_contents($incorrect_path, $output_png);
+	}
+} else {
+	// reference image not yet available--save image and inspect it for correctness by eye
+	file_put_contents($correct_path, $output_png);
+	echo "CORRECT\n";
+}
+
+
+?>
+--EXPECT--
+CORRECT
\ No newline at end of file
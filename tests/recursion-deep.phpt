@@ -0,0 +1,35 @@
+--TEST--
+Recursion test (deep)
+--FILE--
+<?php
+
+/**
+ * A test function
+ * 
+ * @engine	qb
+ * @param	int32		$a
+ * @local	int32[4]	$b
+ * @local	int32		$r
+ * 
+ * @return	int32
+ * 
+ */
+function test_function($a) {
+	$b = array($a, $a * 2, $a * 3, $a * 4);
+	$r = 0;
+	if($a < 40) {
+		$r = test_function($a + 1);
+	}
+	// $b must be intact after the recursive call
+	return $r + $b[3] - $b[2];
+}
+
+echo test_function(0), "\n";
+echo test_function(20), "\n";
+echo test_function(0), "\n";
+
+?>
+--EXPECT--
+820
+630
+820
@@ -0,0 +1,58 @@
+--TEST--
+Specialization with native compilation threshold test
+--SKIPIF--
+<?php
+	if(strtoupper(substr(PHP_OS, 0, 3)) != 'WIN' && !trim(shell_exec('which cc gcc clang tcc 2>/dev/null'))) print 'skip C compiler not available';
+?>
+--INI--
+qb.allow_native_compilation=1
+qb.native_compilation_threshold=20
+qb.specialization_threshold=3
+qb.trace_build=1
+--FILE--
+<?php
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	float32[][]	$a
+ *
+ * @return	float32
+ *
+ */
+function matrix_sum($a) {
+	$sum = 0;
+	foreach($a as $row) {
+		$sum += array_sum($row);
+	}
+	return $sum;
+}
+
+$wide = array(array(1, 2, 3), array(4, 5, 6));
+
+// calls made through the specialized version still count toward the generic one getting hot
+$total = 0;
+for($i = 0; $i < 50; $i++) {
+	$total += matrix_sum($wide);
+}
+echo $total, "\n";
+
+// the generic build, the specialized one, the generic one as native code, then the specialized one again
+$builds = qb_get_build_trace();
+echo count($builds), "\n";
+foreach($builds as $build) {
+	foreach($build['functions'] as $function) {
+		echo $function['name'], " ";
+	}
+	echo ($build['native_compiler'] !== null && $build['phases']['native_compilation'] > 0) ? "native" : "bytecode", "\n";
+}
+
+?>
+--EXPECT--
+1050
+4
+matrix_sum bytecode
+matrix_sum bytecode
+matrix_sum native
+matrix_sum native
@@ -0,0 +1,81 @@
+--TEST--
+Specialization on argument dimensions test
+--INI--
+qb.specialization_threshold=3
+qb.trace_build=1
+--FILE--
+<?php
+
+/**
+ * A test function
+ *
+ * @engine	qb
+ * @param	float32[][]	$a
+ *
+ * @return	float32
+ *
+ */
+function matrix_sum($a) {
+	$sum = 0;
+	foreach($a as $row) {
+		$sum += array_sum($row);
+	}
+	return $sum;
+}
+
+/**
+ * A function with a static variable, which must not be specialized
+ *
+ * @engine	qb
+ * @param	float32[]	$a
+ * @static	int32		$calls
+ *
+ * @return	int32
+ *
+ */
+function count_calls($a) {
+	static $calls = 0;
+	return ++$calls;
+}
+
+$wide = array(array(1, 2, 3), array(4, 5, 6));
+$tall = array(array(1, 2), array(3, 4), array(5, 6));
+$long = array(array(1), array(2), array(3), array(4), array(5), array(6), array(7));
+
+for($i = 0; $i < 5; $i++) {
+	echo matrix_sum($wide), " ";
+}
+echo "\n";
+echo matrix_sum($tall), "\n";
+echo matrix_sum($long), "\n";
+for($i = 0; $i < 5; $i++) {
+	echo matrix_sum($tall), " ";
+}
+echo "\n";
+echo matrix_sum($wide), "\n";
+
+for($i = 0; $i < 5; $i++) {
+	echo count_calls(array(1, 2, 3)), " ";
+}
+echo "\n";
+
+// one generic build, then one for each of the two shapes that crossed the threshold
+$builds = qb_get_build_trace();
+echo count($builds), "\n";
+for($i = 1; $i < count($builds); $i++) {
+	foreach($builds[$i]['functions'] as $function) {
+		echo $function['name'], "\n";
+	}
+}
+
+?>
+--EXPECT--
+21 21 21 21 21 
+21
+28
+21 21 21 21 21 
+21
+1 2 3 4 5 
+3
+matrix_sum
+matrix_sum
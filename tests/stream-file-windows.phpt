@@ -0,0 +1,39 @@
+--TEST--
+Streaming file in windows test
+--FILE--
+<?php
+
+/**
+ * A test function
+ * 
+ * @engine	qb
+ * @param	uint32[]	$a
+ * @param	string		$label
+ * 
+ * @return	void
+ * 
+ */
+function test_function($a, $label) {
+	echo "$label: ", sizeof($a), " ", array_sum($a), " ", $a[0], "\n";
+}
+
+$path = __FILE__ . ".dat";
+$data = "";
+for($i = 0; $i < 40000; $i++) {
+	$data .= pack("V", $i);
+}
+file_put_contents($path, $data);
+
+$handle = fopen($path, "rb");
+echo qb_stream('test_function', $handle, 65536, "Window"), "\n";
+fclose($handle);
+unlink($path);
+
+// assume little endian
+
+?>
+--EXPECT--
+Window: 16384 134209536 0
+Window: 16384 402644992 16384
+Window: 7232 263125472 32768
+3